@@ -5,7 +5,9 @@
 #include "Components/BoxComponent.h"
 #include "Components/WidgetComponent.h"
 #include "Components/SphereComponent.h"
+#include "Net/UnrealNetwork.h"
 #include "ShooterCharacter.h"
+#include "ShooterCollision.h"
 
 // Sets default values
 AItem::AItem():
@@ -17,21 +19,24 @@ AItem::AItem():
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 
+	// thousands of items sit in a level unchanged; they only replicate when picked up or changed
+	bReplicates = true;
+	SetReplicatingMovement( true );
+	NetDormancy = DORM_DormantAll;
+
 	ItemMesh = CreateDefaultSubobject<USkeletalMeshComponent>( TEXT( "ItemMesh" ) );
 	SetRootComponent( ItemMesh );
 
 	CollisionBox = CreateDefaultSubobject<UBoxComponent>( TEXT( "CollisionBox" ) );
 	CollisionBox->SetupAttachment( ItemMesh );
-	CollisionBox->SetCollisionResponseToAllChannels( ECollisionResponse::ECR_Ignore );
-	CollisionBox->SetCollisionResponseToChannel(
-		ECollisionChannel::ECC_Visibility,
-		ECollisionResponse::ECR_Block );
+	CollisionBox->SetCollisionProfileName( ShooterCollision::ItemTraceProfile );
 
 	PickupWidget = CreateDefaultSubobject<UWidgetComponent>( TEXT( "PickupWidget" ) );
 	PickupWidget->SetupAttachment( GetRootComponent( ) );
 
 	AreaSphere = CreateDefaultSubobject<USphereComponent>( TEXT( "AreaSphere" ) );
 	AreaSphere->SetupAttachment( GetRootComponent( ) );
+	AreaSphere->SetCollisionProfileName( ShooterCollision::ItemAreaProfile );
 
 }
 
@@ -80,11 +85,8 @@ void AItem::ONSphereEndOverlap( UPrimitiveComponent* OverlappedComponenet, AActo
 
 void AItem::SetActiveStars( )
 {
-	// the 0 element isn't used
-	for ( int32 i = 0; i <= 5; i++ )
-	{
-		ActiveStars.Add( false );
-	}
+	// the 0 element isn't used; reset rather than append so this can run again when rarity changes
+	ActiveStars.Init( false, 6 );
 	switch ( ItemRarity )
 	{
 	case EItemRarity::EIR_Damaged:
@@ -115,6 +117,45 @@ void AItem::SetActiveStars( )
 	}
 }
 
+void AItem::SetItemCount( int32 Count )
+{
+	if ( ItemCount != Count )
+	{
+		ItemCount = Count;
+		FlushNetDormancy( );
+	}
+}
+
+void AItem::SetItemRarity( EItemRarity Rarity )
+{
+	if ( ItemRarity != Rarity )
+	{
+		ItemRarity = Rarity;
+		SetActiveStars( );
+		FlushNetDormancy( );
+	}
+}
+
+void AItem::SetSpawnProperties( EItemRarity Rarity, int32 Count )
+{
+	ensure( !HasActorBegunPlay( ) );
+	ItemRarity = Rarity;
+	ItemCount = Count;
+}
+
+void AItem::OnRep_ItemRarity( )
+{
+	SetActiveStars( );
+}
+
+void AItem::GetLifetimeReplicatedProps( TArray<FLifetimeProperty>& OutLifetimeProps ) const
+{
+	Super::GetLifetimeReplicatedProps( OutLifetimeProps );
+
+	DOREPLIFETIME( AItem, ItemCount );
+	DOREPLIFETIME( AItem, ItemRarity );
+}
+
 // Called every frame
 void AItem::Tick(float DeltaTime)
 {
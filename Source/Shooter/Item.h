@@ -50,10 +50,15 @@ protected:
 
 	/* Sets the ActiveStars array of bools based on rarity */
 	void SetActiveStars( );
+
+	UFUNCTION( )
+	void OnRep_ItemRarity( );
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
+	virtual void GetLifetimeReplicatedProps( TArray<FLifetimeProperty>& OutLifetimeProps ) const override;
+
 private:
 	/* skeletal mesh for the item */
 	UPROPERTY( VisibleAnywhere, BlueprintReadOnly, Category = ItemProperties, meta = ( AllowPrivateAccess = "true" ) )
@@ -76,11 +81,11 @@ private:
 	FString ItemName;
 
 	/* ItemCount (ammo et.) */
-	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = ItemProperties, meta = ( AllowPrivateAccess = "true" ) )
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Replicated, Category = ItemProperties, meta = ( AllowPrivateAccess = "true" ) )
 	int32 ItemCount;
 
 	/* Item rarity - determines number of stars in Pickup Widget */
-	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = ItemProperties, meta = ( AllowPrivateAccess = "true" ) )
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, ReplicatedUsing = OnRep_ItemRarity, Category = ItemProperties, meta = ( AllowPrivateAccess = "true" ) )
 	EItemRarity ItemRarity;
  
 	UPROPERTY( VisibleAnywhere, BlueprintReadOnly, Category = ItemProperties, meta = ( AllowPrivateAccess = "true" ) )
@@ -90,4 +95,15 @@ public:
 	FORCEINLINE UWidgetComponent* GetPickupWidget( ) const { return PickupWidget; }
 	FORCEINLINE USphereComponent* GetAreaSphere( ) const { return AreaSphere; }
 	FORCEINLINE UBoxComponent* GetCollisionBox( ) const { return CollisionBox; }
+	FORCEINLINE int32 GetItemCount( ) const { return ItemCount; }
+	FORCEINLINE EItemRarity GetItemRarity( ) const { return ItemRarity; }
+
+	/* sets ItemCount and sends it to clients; items are net dormant between changes */
+	void SetItemCount( int32 Count );
+
+	/* sets ItemRarity and updates ActiveStars to match */
+	void SetItemRarity( EItemRarity Rarity );
+
+	/* sets rarity and count on a deferred spawn, before FinishSpawning; BeginPlay sets up the stars */
+	void SetSpawnProperties( EItemRarity Rarity, int32 Count );
 };
@@ -0,0 +1,165 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterActionComponent.h"
+#include "Curves/CurveFloat.h"
+#include "ShooterStats.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT( TEXT( "Action Components Ticking" ), STAT_ActionComponentsTicking, STATGROUP_Shooter );
+
+bool FShooterTimelineEvaluator::Advance( float DeltaTime )
+{
+	if ( !IsPlaying( ) )
+	{
+		return false;
+	}
+	const float EndTime { PlayRate > 0.f ? Duration : 0.f };
+	Time = FMath::Clamp( Time + PlayRate * DeltaTime, 0.f, Duration );
+	if ( Time == EndTime )
+	{
+		bAtEnd = PlayRate > 0.f;
+		Stop( );
+		return true;
+	}
+	return false;
+}
+
+float FShooterTimelineEvaluator::GetAlpha( ) const
+{
+	const float LinearAlpha { GetLinearAlpha( ) };
+	return Curve ? Curve->GetFloatValue( LinearAlpha ) : LinearAlpha;
+}
+
+UShooterActionComponent::UShooterActionComponent( ) :
+	Duration( 1.f ),
+	Curve( nullptr ),
+	bStartAtEnd( false )
+{
+	// only tick while a transition is running
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+}
+
+void UShooterActionComponent::BeginPlay( )
+{
+	Super::BeginPlay( );
+
+	Timeline.Duration = Duration;
+	Timeline.Curve = Curve;
+	Timeline.SetLinearAlpha( bStartAtEnd ? 1.f : 0.f );
+	ApplyActionAlpha( Timeline.GetAlpha( ) );
+}
+
+void UShooterActionComponent::EndPlay( const EEndPlayReason::Type EndPlayReason )
+{
+	SetTicking( false );
+
+	Super::EndPlay( EndPlayReason );
+}
+
+void UShooterActionComponent::PlayForward( )
+{
+	StartTransition( true );
+}
+
+void UShooterActionComponent::PlayReverse( )
+{
+	StartTransition( false );
+}
+
+void UShooterActionComponent::Toggle( )
+{
+	if ( Timeline.IsPlaying( ) )
+	{
+		StartTransition( Timeline.PlayRate < 0.f );
+	}
+	else
+	{
+		StartTransition( Timeline.GetLinearAlpha( ) < 0.5f );
+	}
+}
+
+void UShooterActionComponent::SetActionAlpha( float Alpha )
+{
+	Timeline.Stop( );
+	Timeline.SetLinearAlpha( Alpha );
+	SetTicking( false );
+	ApplyActionAlpha( Timeline.GetAlpha( ) );
+}
+
+void UShooterActionComponent::WriteSnapshot( FShooterActionSnapshot& OutSnapshot ) const
+{
+	OutSnapshot.Progress = Timeline.GetLinearAlpha( );
+	OutSnapshot.Direction = static_cast<int8>( FMath::Sign( Timeline.PlayRate ) );
+}
+
+void UShooterActionComponent::ReadSnapshot( const FShooterActionSnapshot& Snapshot )
+{
+	SetActionAlpha( Snapshot.Progress );
+	if ( Snapshot.Direction > 0 )
+	{
+		PlayForward( );
+	}
+	else if ( Snapshot.Direction < 0 )
+	{
+		PlayReverse( );
+	}
+}
+
+void UShooterActionComponent::StartTransition( bool bForward )
+{
+	// pick up edits made from Blueprint since BeginPlay, keeping our place along the action
+	const float LinearAlpha { Timeline.GetLinearAlpha( ) };
+	Timeline.Duration = Duration;
+	Timeline.Curve = Curve;
+	Timeline.SetLinearAlpha( LinearAlpha );
+
+	OnTransitionStarted( bForward );
+	if ( bForward )
+	{
+		Timeline.PlayForward( );
+	}
+	else
+	{
+		Timeline.PlayReverse( );
+	}
+	SetTicking( true );
+}
+
+void UShooterActionComponent::TickComponent( float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction )
+{
+	Super::TickComponent( DeltaTime, TickType, ThisTickFunction );
+
+	const bool bForward { Timeline.PlayRate > 0.f };
+	const bool bFinished { Timeline.Advance( DeltaTime ) };
+	ApplyActionAlpha( Timeline.GetAlpha( ) );
+
+	if ( bFinished || !Timeline.IsPlaying( ) )
+	{
+		SetTicking( false );
+		OnTransitionFinished( bForward );
+		OnActionFinished.Broadcast( bForward );
+	}
+}
+
+void UShooterActionComponent::ApplyActionAlpha( float Alpha )
+{
+	ReceiveActionAlpha( Alpha );
+}
+
+void UShooterActionComponent::SetTicking( bool bTicking )
+{
+	if ( IsComponentTickEnabled( ) == bTicking )
+	{
+		return;
+	}
+	SetComponentTickEnabled( bTicking );
+	if ( bTicking )
+	{
+		INC_DWORD_STAT( STAT_ActionComponentsTicking );
+	}
+	else
+	{
+		DEC_DWORD_STAT( STAT_ActionComponentsTicking );
+	}
+}
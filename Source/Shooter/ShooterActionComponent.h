@@ -0,0 +1,157 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "ShooterActionComponent.generated.h"
+
+class UCurveFloat;
+
+/* plays a 0..1 alpha forwards or backwards over a duration, optionally shaped by a curve */
+struct SHOOTER_API FShooterTimelineEvaluator
+{
+	float Duration { 1.f };
+	float Time { 0.f };
+	float PlayRate { 0.f };
+	const UCurveFloat* Curve { nullptr };
+	/* which end a zero duration timeline rests at, since Time can't tell */
+	bool bAtEnd { false };
+
+	void PlayForward( ) { PlayRate = 1.f; }
+	void PlayReverse( ) { PlayRate = -1.f; }
+	void Stop( ) { PlayRate = 0.f; }
+	void SetLinearAlpha( float Alpha ) { Time = FMath::Clamp( Alpha, 0.f, 1.f ) * Duration; bAtEnd = Alpha >= 0.5f; }
+
+	/* advance by DeltaTime; returns true once the timeline reaches the end it was playing toward */
+	bool Advance( float DeltaTime );
+
+	/* linear progress 0..1 */
+	float GetLinearAlpha( ) const { return Duration > 0.f ? Time / Duration : ( bAtEnd ? 1.f : 0.f ); }
+
+	/* progress shaped by Curve, if any */
+	float GetAlpha( ) const;
+
+	bool IsPlaying( ) const { return PlayRate != 0.f; }
+};
+
+/* an action's state as stored in a world snapshot; plain data so it can be read straight from the file */
+struct FShooterActionSnapshot
+{
+	/* linear progress 0..1 */
+	float Progress { 0.f };
+	/* subclass specific, e.g. the elevator's floor */
+	int32 State { 0 };
+	/* 1 forwards, -1 reverse, 0 idle */
+	int8 Direction { 0 };
+	uint8 Pad[3] {};
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam( FOnShooterActionFinished, bool, bForward );
+
+/**
+ * Base for timed or curve-driven gameplay props (doors, elevators, showers, animations).
+ * Only ticks while a transition is running; idle components cost nothing per frame.
+ * Subclasses apply the alpha natively, Blueprint subclasses can use ReceiveActionAlpha.
+ */
+UCLASS( Abstract, Blueprintable, ClassGroup = ( Custom ) )
+class SHOOTER_API UShooterActionComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UShooterActionComponent( );
+
+	/* run the action toward its end state (open, on, arrived) */
+	UFUNCTION( BlueprintCallable, Category = Action )
+	void PlayForward( );
+
+	/* run the action back toward its start state (closed, off) */
+	UFUNCTION( BlueprintCallable, Category = Action )
+	void PlayReverse( );
+
+	/* reverse direction, or start whichever way leads away from the current end */
+	UFUNCTION( BlueprintCallable, Category = Action )
+	void Toggle( );
+
+	/* jump straight to Alpha (0..1) without a transition */
+	UFUNCTION( BlueprintCallable, Category = Action )
+	void SetActionAlpha( float Alpha );
+
+	UFUNCTION( BlueprintPure, Category = Action )
+	float GetActionAlpha( ) const { return Timeline.GetAlpha( ); }
+
+	UFUNCTION( BlueprintPure, Category = Action )
+	bool IsActionPlaying( ) const { return Timeline.IsPlaying( ); }
+
+	/* capture the action's state for a world snapshot */
+	virtual void WriteSnapshot( FShooterActionSnapshot& OutSnapshot ) const;
+
+	/* put the action back to a snapshot's state without a transition */
+	virtual void ReadSnapshot( const FShooterActionSnapshot& Snapshot );
+
+	/* called when a transition reaches its end */
+	UPROPERTY( BlueprintAssignable, Category = Action )
+	FOnShooterActionFinished OnActionFinished;
+
+	virtual void TickComponent( float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction ) override;
+
+protected:
+	virtual void BeginPlay( ) override;
+	virtual void EndPlay( const EEndPlayReason::Type EndPlayReason ) override;
+
+	/* move the prop to Alpha along the action */
+	virtual void ApplyActionAlpha( float Alpha );
+
+	/* a transition is about to start */
+	virtual void OnTransitionStarted( bool bForward ) {}
+
+	/* a transition reached its end */
+	virtual void OnTransitionFinished( bool bForward ) {}
+
+	/* Blueprint hook for ApplyActionAlpha */
+	UFUNCTION( BlueprintImplementableEvent, Category = Action, meta = ( DisplayName = "On Action Alpha" ) )
+	void ReceiveActionAlpha( float Alpha );
+
+	/* find the owner's scene component named Name, or its root if Name is None */
+	template<class T>
+	T* FindOwnerComponent( FName Name ) const
+	{
+		const AActor* Owner = GetOwner( );
+		if ( Owner == nullptr )
+		{
+			return nullptr;
+		}
+		if ( Name == NAME_None )
+		{
+			return Cast<T>( Owner->GetRootComponent( ) );
+		}
+		TInlineComponentArray<T*> Components( Owner );
+		for ( T* Component : Components )
+		{
+			if ( Component->GetFName( ) == Name )
+			{
+				return Component;
+			}
+		}
+		return nullptr;
+	}
+
+	/* seconds a full transition takes */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Action, meta = ( ClampMin = "0.0" ) )
+	float Duration;
+
+	/* optional easing; maps linear progress 0..1 to alpha */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Action )
+	UCurveFloat* Curve;
+
+	/* start at the end state instead of the start state */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Action )
+	bool bStartAtEnd;
+
+	FShooterTimelineEvaluator Timeline;
+
+private:
+	void StartTransition( bool bForward );
+	void SetTicking( bool bTicking );
+};
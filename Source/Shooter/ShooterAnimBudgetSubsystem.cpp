@@ -0,0 +1,206 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterAnimBudgetSubsystem.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "ShooterAnimInstance.h"
+#include "ShooterStats.h"
+
+DECLARE_CYCLE_STAT( TEXT( "Anim Budget" ), STAT_AnimBudget, STATGROUP_Shooter );
+DECLARE_DWORD_COUNTER_STAT( TEXT( "Anim Budget Full Rate Meshes" ), STAT_AnimBudgetFullRate, STATGROUP_Shooter );
+DECLARE_DWORD_COUNTER_STAT( TEXT( "Anim Budget Throttled Meshes" ), STAT_AnimBudgetThrottled, STATGROUP_Shooter );
+DECLARE_FLOAT_COUNTER_STAT( TEXT( "Anim Budget Planned ms" ), STAT_AnimBudgetPlannedMs, STATGROUP_Shooter );
+DECLARE_DWORD_ACCUMULATOR_STAT( TEXT( "Anim Budget Hits" ), STAT_AnimBudgetHits, STATGROUP_Shooter );
+DECLARE_DWORD_ACCUMULATOR_STAT( TEXT( "Anim Budget Misses" ), STAT_AnimBudgetMisses, STATGROUP_Shooter );
+
+static TAutoConsoleVariable<int32> CVarAnimBudgetEnabled(
+	TEXT( "shooter.AnimBudget.Enabled" ),
+	1,
+	TEXT( "Share a per-frame animation budget between ShooterCharacters" ) );
+
+static TAutoConsoleVariable<float> CVarAnimBudgetMs(
+	TEXT( "shooter.AnimBudget.BudgetMs" ),
+	1.0f,
+	TEXT( "Milliseconds per frame all character animation updates should fit in" ) );
+
+static TAutoConsoleVariable<int32> CVarAnimBudgetMaxRate(
+	TEXT( "shooter.AnimBudget.MaxRate" ),
+	8,
+	TEXT( "Slowest update rate (update every N frames) for off-screen or distant characters" ) );
+
+static TAutoConsoleVariable<float> CVarAnimBudgetFarDistance(
+	TEXT( "shooter.AnimBudget.FarDistance" ),
+	5000.f,
+	TEXT( "Distance at which a visible character's significance reaches its minimum" ) );
+
+void UShooterAnimBudgetSubsystem::RegisterMesh( USkeletalMeshComponent* Mesh )
+{
+	if ( Mesh == nullptr )
+	{
+		return;
+	}
+	for ( const FBudgetedMesh& Budgeted : BudgetedMeshes )
+	{
+		if ( Budgeted.Mesh == Mesh )
+		{
+			return;
+		}
+	}
+	// URO does the frame skipping, accumulated delta time and interpolation; we only pick the rate
+	Mesh->bEnableUpdateRateOptimizations = true;
+	BudgetedMeshes.Add( { Mesh, 1.f } );
+}
+
+void UShooterAnimBudgetSubsystem::UnregisterMesh( USkeletalMeshComponent* Mesh )
+{
+	BudgetedMeshes.RemoveAllSwap( [Mesh]( const FBudgetedMesh& Budgeted ) { return Budgeted.Mesh == Mesh; } );
+	if ( Mesh )
+	{
+		Mesh->EnableExternalTickRateControl( false );
+	}
+}
+
+bool UShooterAnimBudgetSubsystem::IsTickable( ) const
+{
+	const UWorld* World = GetWorld( );
+	return !IsTemplate( ) && World && World->IsGameWorld( ) && BudgetedMeshes.Num( ) > 0;
+}
+
+TStatId UShooterAnimBudgetSubsystem::GetStatId( ) const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT( UShooterAnimBudgetSubsystem, STATGROUP_Tickables );
+}
+
+void UShooterAnimBudgetSubsystem::Tick( float DeltaTime )
+{
+	SCOPE_CYCLE_COUNTER( STAT_AnimBudget );
+
+	BudgetedMeshes.RemoveAllSwap( []( const FBudgetedMesh& Budgeted ) { return !Budgeted.Mesh.IsValid( ); } );
+
+	if ( CVarAnimBudgetEnabled.GetValueOnGameThread( ) == 0 )
+	{
+		for ( const FBudgetedMesh& Budgeted : BudgetedMeshes )
+		{
+			ApplyUpdateRate( Budgeted.Mesh.Get( ), 1 );
+		}
+		return;
+	}
+
+	// average graph update plus pose evaluation of the meshes that updated last frame; game thread
+	// event graphs and meshes on other anim instances aren't in it
+	float MeasuredCostMs { 0.f };
+	int32 MeasuredUpdates { 0 };
+	for ( const FBudgetedMesh& Budgeted : BudgetedMeshes )
+	{
+		const UShooterAnimInstance* AnimInstance = Cast<UShooterAnimInstance>( Budgeted.Mesh->GetAnimInstance( ) );
+		if ( AnimInstance && AnimInstance->GetLastUpdateCostMs( ) > 0.f )
+		{
+			MeasuredCostMs += AnimInstance->GetLastUpdateCostMs( );
+			MeasuredUpdates++;
+		}
+	}
+	if ( MeasuredUpdates > 0 )
+	{
+		AverageUpdateCostMs = FMath::Lerp( AverageUpdateCostMs, MeasuredCostMs / MeasuredUpdates, 0.1f );
+	}
+
+	TArray<FVector, TInlineAllocator<4>> ViewLocations;
+	for ( FConstPlayerControllerIterator It = GetWorld( )->GetPlayerControllerIterator( ); It; ++It )
+	{
+		if ( const APlayerController* PlayerController = It->Get( ) )
+		{
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PlayerController->GetPlayerViewPoint( ViewLocation, ViewRotation );
+			ViewLocations.Add( ViewLocation );
+		}
+	}
+
+	for ( FBudgetedMesh& Budgeted : BudgetedMeshes )
+	{
+		Budgeted.Significance = CalculateSignificance( Budgeted.Mesh.Get( ), ViewLocations );
+	}
+	BudgetedMeshes.Sort( []( const FBudgetedMesh& A, const FBudgetedMesh& B ) { return A.Significance > B.Significance; } );
+
+	// most significant meshes get full rate until the budget runs out
+	const float BudgetMs { CVarAnimBudgetMs.GetValueOnGameThread( ) };
+	float PlannedMs { 0.f };
+	int32 FullRateMeshes { 0 };
+	for ( const FBudgetedMesh& Budgeted : BudgetedMeshes )
+	{
+		int32 UpdateRate { 1 };
+		if ( PlannedMs + AverageUpdateCostMs > BudgetMs )
+		{
+			UpdateRate = GetReducedUpdateRate( Budgeted.Significance );
+		}
+		else
+		{
+			FullRateMeshes++;
+		}
+		PlannedMs += AverageUpdateCostMs / UpdateRate;
+		ApplyUpdateRate( Budgeted.Mesh.Get( ), UpdateRate );
+	}
+
+	SET_DWORD_STAT( STAT_AnimBudgetFullRate, FullRateMeshes );
+	SET_DWORD_STAT( STAT_AnimBudgetThrottled, BudgetedMeshes.Num( ) - FullRateMeshes );
+	SET_FLOAT_STAT( STAT_AnimBudgetPlannedMs, PlannedMs );
+	if ( PlannedMs <= BudgetMs )
+	{
+		INC_DWORD_STAT( STAT_AnimBudgetHits );
+	}
+	else
+	{
+		// even at reduced rates the characters don't fit
+		INC_DWORD_STAT( STAT_AnimBudgetMisses );
+	}
+}
+
+float UShooterAnimBudgetSubsystem::CalculateSignificance(
+	const USkeletalMeshComponent* Mesh,
+	const TArray<FVector, TInlineAllocator<4>>& ViewLocations ) const
+{
+	if ( ViewLocations.Num( ) == 0 )
+	{
+		return 0.f;
+	}
+
+	float ClosestDistSquared { MAX_flt };
+	const FVector MeshLocation { Mesh->GetComponentLocation( ) };
+	for ( const FVector& ViewLocation : ViewLocations )
+	{
+		ClosestDistSquared = FMath::Min( ClosestDistSquared, FVector::DistSquared( MeshLocation, ViewLocation ) );
+	}
+
+	const float FarDistance { FMath::Max( CVarAnimBudgetFarDistance.GetValueOnGameThread( ), 1.f ) };
+	const float DistanceSignificance { 1.f - FMath::Clamp( FMath::Sqrt( ClosestDistSquared ) / FarDistance, 0.f, 1.f ) };
+
+	// off-screen meshes always rank below on-screen ones
+	if ( !Mesh->WasRecentlyRendered( 0.2f ) )
+	{
+		return DistanceSignificance * 0.1f;
+	}
+	return 0.2f + DistanceSignificance * 0.8f;
+}
+
+int32 UShooterAnimBudgetSubsystem::GetReducedUpdateRate( float Significance ) const
+{
+	const int32 MaxRate { FMath::Max( CVarAnimBudgetMaxRate.GetValueOnGameThread( ), 2 ) };
+	if ( Significance > 0.6f )
+	{
+		return FMath::Min( 2, MaxRate );
+	}
+	if ( Significance > 0.2f )
+	{
+		return FMath::Min( 4, MaxRate );
+	}
+	return MaxRate;
+}
+
+void UShooterAnimBudgetSubsystem::ApplyUpdateRate( USkeletalMeshComponent* Mesh, int32 UpdateRate ) const
+{
+	Mesh->EnableExternalTickRateControl( UpdateRate > 1 );
+	Mesh->SetExternalTickRate( static_cast<uint8>( UpdateRate ) );
+	Mesh->EnableExternalInterpolation( UpdateRate > 1 );
+}
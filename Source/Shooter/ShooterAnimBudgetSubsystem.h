@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ShooterAnimBudgetSubsystem.generated.h"
+
+/**
+ * Shares a per-frame animation budget between all registered character meshes.
+ * The most significant meshes (close and on screen) update every frame until the budget is spent;
+ * the rest drop to reduced update rates with interpolation.
+ */
+UCLASS()
+class SHOOTER_API UShooterAnimBudgetSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	/* start budgeting Mesh; its anim instance should be a UShooterAnimInstance to report its cost */
+	void RegisterMesh( USkeletalMeshComponent* Mesh );
+	void UnregisterMesh( USkeletalMeshComponent* Mesh );
+
+	// FTickableGameObject
+	virtual void Tick( float DeltaTime ) override;
+	virtual bool IsTickable( ) const override;
+	virtual TStatId GetStatId( ) const override;
+	virtual UWorld* GetTickableGameObjectWorld( ) const override { return GetWorld( ); }
+
+private:
+	struct FBudgetedMesh
+	{
+		TWeakObjectPtr<USkeletalMeshComponent> Mesh;
+		float Significance;
+	};
+
+	/* how much a mesh matters this frame, 0..1 */
+	float CalculateSignificance( const USkeletalMeshComponent* Mesh, const TArray<FVector, TInlineAllocator<4>>& ViewLocations ) const;
+
+	/* update rate for a mesh that didn't fit in the full rate budget */
+	int32 GetReducedUpdateRate( float Significance ) const;
+
+	void ApplyUpdateRate( USkeletalMeshComponent* Mesh, int32 UpdateRate ) const;
+
+	/* smoothed cost of one mesh's anim graph update and pose evaluation, ms */
+	float AverageUpdateCostMs { 0.1f };
+
+	TArray<FBudgetedMesh> BudgetedMeshes;
+};
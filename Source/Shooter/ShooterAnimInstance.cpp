@@ -5,9 +5,16 @@
 #include "ShooterCharacter.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Kismet/KismetMathLibrary.h"
+#include "Misc/ScopeExit.h"
 
 void UShooterAnimInstance::UpdateAnimationProperties( float DeltaTime )
 {
+	// the animation budget skipped us this frame; the pose is being interpolated
+	if ( IsUpdateThrottled( ) )
+	{
+		return;
+	}
+
 	if ( ShooterCharacter == nullptr )
 	{
 		ShooterCharacter = Cast<AShooterCharacter>( TryGetPawnOwner( ) );
@@ -75,3 +82,133 @@ void UShooterAnimInstance::NativeInitializeAnimation( )
 {
 	ShooterCharacter = Cast<AShooterCharacter>( TryGetPawnOwner( ) );
 }
+
+void UShooterAnimInstance::AddRecoilImpulse( float Kick, float Pitch, float Yaw )
+{
+#if !UE_SERVER
+	// accumulate until the next animation update hands them to the proxy
+	PendingRecoilImpulse += FVector( Kick, Pitch, Yaw );
+#endif
+}
+
+bool UShooterAnimInstance::IsUpdateThrottled( ) const
+{
+	const USkeletalMeshComponent* Mesh = GetSkelMeshComponent( );
+	return Mesh &&
+		Mesh->ShouldUseUpdateRateOptimizations( ) &&
+		Mesh->AnimUpdateRateParams &&
+		Mesh->AnimUpdateRateParams->ShouldSkipUpdate( );
+}
+
+float UShooterAnimInstance::GetLastUpdateCostMs( ) const
+{
+	return LastUpdateFrame == GFrameCounter ? LastUpdateCostMs : 0.f;
+}
+
+float UShooterAnimInstance::FrameUpdateCostMs { 0.f };
+uint64 UShooterAnimInstance::FrameUpdateCostFrame { 0 };
+
+float UShooterAnimInstance::GetFrameUpdateCostMs( )
+{
+	return FrameUpdateCostFrame == GFrameCounter ? FrameUpdateCostMs : 0.f;
+}
+
+FAnimInstanceProxy* UShooterAnimInstance::CreateAnimInstanceProxy( )
+{
+	return new FShooterAnimInstanceProxy( this );
+}
+
+void FShooterAnimInstanceProxy::PreUpdate( UAnimInstance* InAnimInstance, float DeltaSeconds )
+{
+	Super::PreUpdate( InAnimInstance, DeltaSeconds );
+
+	UShooterAnimInstance* ShooterAnimInstance = CastChecked<UShooterAnimInstance>( InAnimInstance );
+	Spring = ShooterAnimInstance->RecoilSpring;
+	PendingImpulse = ShooterAnimInstance->PendingRecoilImpulse;
+	ShooterAnimInstance->PendingRecoilImpulse = FVector::ZeroVector;
+	UpdateCostMs = 0.f;
+}
+
+void FShooterAnimInstanceProxy::Update( float DeltaSeconds )
+{
+	const uint64 StartCycles { FPlatformTime::Cycles64( ) };
+	ON_SCOPE_EXIT
+	{
+		UpdateCostMs += static_cast<float>( FPlatformTime::ToMilliseconds64( FPlatformTime::Cycles64( ) - StartCycles ) );
+	};
+
+	Super::Update( DeltaSeconds );
+
+#if !UE_SERVER
+	// the fire reaction only moves the weapon hand; hit validation only needs the body pose
+	RecoilVelocity += PendingImpulse;
+	PendingImpulse = FVector::ZeroVector;
+
+	if ( RecoilOffset.IsNearlyZero( ) && RecoilVelocity.IsNearlyZero( ) )
+	{
+		RecoilOffset = FVector::ZeroVector;
+		RecoilVelocity = FVector::ZeroVector;
+		return;
+	}
+
+	// damped spring, sub-stepped so long frames stay stable
+	const float MaxStep { 1.f / 120.f };
+	const float Damping { 2.f * Spring.DampingRatio * FMath::Sqrt( Spring.Stiffness ) };
+	float TimeLeft { DeltaSeconds };
+	while ( TimeLeft > KINDA_SMALL_NUMBER )
+	{
+		const float Step { FMath::Min( TimeLeft, MaxStep ) };
+		const FVector Acceleration { -Spring.Stiffness * RecoilOffset - Damping * RecoilVelocity };
+		RecoilVelocity += Acceleration * Step;
+		RecoilOffset += RecoilVelocity * Step;
+		TimeLeft -= Step;
+	}
+
+	RecoilOffset.X = FMath::Clamp( RecoilOffset.X, -Spring.MaxKick, Spring.MaxKick );
+	RecoilOffset.Y = FMath::Clamp( RecoilOffset.Y, -Spring.MaxAngle, Spring.MaxAngle );
+	RecoilOffset.Z = FMath::Clamp( RecoilOffset.Z, -Spring.MaxAngle, Spring.MaxAngle );
+#endif
+}
+
+void FShooterAnimInstanceProxy::UpdateAnimationNode_WithRoot( const FAnimationUpdateContext& InContext, FAnimNode_Base* InRootNode )
+{
+	const uint64 StartCycles { FPlatformTime::Cycles64( ) };
+	Super::UpdateAnimationNode_WithRoot( InContext, InRootNode );
+
+	// linked graphs update inside the main one; count the main graph only
+	if ( InRootNode == GetRootNode( ) )
+	{
+		UpdateCostMs += static_cast<float>( FPlatformTime::ToMilliseconds64( FPlatformTime::Cycles64( ) - StartCycles ) );
+	}
+}
+
+void FShooterAnimInstanceProxy::EvaluateAnimationNode_WithRoot( FPoseContext& Output, FAnimNode_Base* InRootNode )
+{
+	const uint64 StartCycles { FPlatformTime::Cycles64( ) };
+	Super::EvaluateAnimationNode_WithRoot( Output, InRootNode );
+
+	if ( InRootNode == GetRootNode( ) )
+	{
+		EvaluateCostMs = static_cast<float>( FPlatformTime::ToMilliseconds64( FPlatformTime::Cycles64( ) - StartCycles ) );
+	}
+}
+
+void FShooterAnimInstanceProxy::PostUpdate( UAnimInstance* InAnimInstance ) const
+{
+	Super::PostUpdate( InAnimInstance );
+
+	UShooterAnimInstance* ShooterAnimInstance = CastChecked<UShooterAnimInstance>( InAnimInstance );
+	ShooterAnimInstance->RecoilTranslation = FVector( -RecoilOffset.X, 0.f, 0.f );
+	ShooterAnimInstance->RecoilRotation = FRotator( RecoilOffset.Y, RecoilOffset.Z, 0.f );
+	// evaluation comes after this on the game thread path, so that's last frame's pose; close enough for a running average
+	const float CostMs { UpdateCostMs + EvaluateCostMs };
+	ShooterAnimInstance->LastUpdateCostMs = CostMs;
+	ShooterAnimInstance->LastUpdateFrame = GFrameCounter;
+
+	if ( UShooterAnimInstance::FrameUpdateCostFrame != GFrameCounter )
+	{
+		UShooterAnimInstance::FrameUpdateCostMs = 0.f;
+		UShooterAnimInstance::FrameUpdateCostFrame = GFrameCounter;
+	}
+	UShooterAnimInstance::FrameUpdateCostMs += CostMs;
+}
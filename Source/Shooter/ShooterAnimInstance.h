@@ -4,8 +4,72 @@
 
 #include "CoreMinimal.h"
 #include "Animation/AnimInstance.h"
+#include "Animation/AnimInstanceProxy.h"
 #include "ShooterAnimInstance.generated.h"
 
+/* damped spring that pulls the fire reaction back to rest */
+USTRUCT( BlueprintType )
+struct FRecoilSpringSettings
+{
+	GENERATED_BODY( )
+
+	/* how hard the spring pulls back to rest; higher recovers faster */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Recoil, meta = ( ClampMin = "1.0" ) )
+	float Stiffness = 300.f;
+
+	/* 1 is critically damped, lower values overshoot */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Recoil, meta = ( ClampMin = "0.0", ClampMax = "2.0" ) )
+	float DampingRatio = 0.6f;
+
+	/* largest kick back (cm) the spring may reach */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Recoil, meta = ( ClampMin = "0.0" ) )
+	float MaxKick = 8.f;
+
+	/* largest pitch/yaw (degrees) the spring may reach */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Recoil, meta = ( ClampMin = "0.0" ) )
+	float MaxAngle = 10.f;
+};
+
+/**
+ * Runs the recoil spring on the animation worker thread and times the graph update and pose evaluation
+ */
+USTRUCT( )
+struct FShooterAnimInstanceProxy : public FAnimInstanceProxy
+{
+	GENERATED_BODY( )
+
+	FShooterAnimInstanceProxy( ) {}
+	FShooterAnimInstanceProxy( UAnimInstance* InAnimInstance ) : FAnimInstanceProxy( InAnimInstance ) {}
+
+protected:
+	/* game thread: take the impulses queued since the last update */
+	virtual void PreUpdate( UAnimInstance* InAnimInstance, float DeltaSeconds ) override;
+
+	/* worker thread: integrate the spring */
+	virtual void Update( float DeltaSeconds ) override;
+
+	/* worker thread: the anim graph update, timed for the animation budget */
+	virtual void UpdateAnimationNode_WithRoot( const FAnimationUpdateContext& InContext, FAnimNode_Base* InRootNode ) override;
+
+	/* worker thread: the pose evaluation, timed for the animation budget */
+	virtual void EvaluateAnimationNode_WithRoot( FPoseContext& Output, FAnimNode_Base* InRootNode ) override;
+
+	/* game thread: publish the recoil pose to the anim instance */
+	virtual void PostUpdate( UAnimInstance* InAnimInstance ) const override;
+
+private:
+	FRecoilSpringSettings Spring;
+
+	/* X is kick (cm/s), Y is pitch and Z is yaw (deg/s) */
+	FVector PendingImpulse { FVector::ZeroVector };
+	FVector RecoilOffset { FVector::ZeroVector };
+	FVector RecoilVelocity { FVector::ZeroVector };
+
+	/* wall time of this update's native hook and graph, and of the last pose evaluation, reported to the animation budget */
+	float UpdateCostMs { 0.f };
+	float EvaluateCostMs { 0.f };
+};
+
 /**
  * 
  */
@@ -19,7 +83,32 @@ public:
 
 	virtual void NativeInitializeAnimation( ) override;
 
+	/**
+	* Kick the fire reaction spring. Called once per shot instead of restarting a montage
+	* @param Kick   Backwards velocity added to the weapon hand, cm/s
+	* @param Pitch  Upwards angular velocity, deg/s
+	* @param Yaw    Sideways angular velocity, deg/s
+	*/
+	UFUNCTION( BlueprintCallable, Category = Recoil )
+	void AddRecoilImpulse( float Kick, float Pitch, float Yaw );
+
+	/* true if the anim Blueprint applies RecoilTranslation/RecoilRotation, so the fire montage isn't needed */
+	FORCEINLINE bool UsesProceduralRecoil( ) const { return bProceduralRecoil; }
+
+	/* true on frames the animation budget skips this mesh's update */
+	bool IsUpdateThrottled( ) const;
+
+	/* cost of this frame's animation update and pose evaluation in ms, 0 if it didn't update this frame */
+	float GetLastUpdateCostMs( ) const;
+
+	/* summed cost of every ShooterAnimInstance update this frame in ms */
+	static float GetFrameUpdateCostMs( );
+
+protected:
+	virtual FAnimInstanceProxy* CreateAnimInstanceProxy( ) override;
+
 private:
+	friend struct FShooterAnimInstanceProxy;
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Movement, meta = (AllowPrivateAccess = "true" ) )
 	class AShooterCharacter* ShooterCharacter;
@@ -48,4 +137,31 @@ private:
 
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Movement, Meta = ( AllowPrivateAccess = "true" ) )
 	bool bAiming;
+
+	/* set once the anim graph feeds RecoilTranslation/RecoilRotation to the weapon hand; until then shots play the fire montage */
+	UPROPERTY( EditDefaultsOnly, BlueprintReadOnly, Category = Recoil, Meta = ( AllowPrivateAccess = "true" ) )
+	bool bProceduralRecoil { false };
+
+	/* spring driving the procedural fire reaction */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Recoil, Meta = ( AllowPrivateAccess = "true" ) )
+	FRecoilSpringSettings RecoilSpring;
+
+	/* additive rotation for the weapon hand, fed to a Transform (Modify) Bone node in Add To Existing mode */
+	UPROPERTY( VisibleAnywhere, BlueprintReadOnly, Category = Recoil, Meta = ( AllowPrivateAccess = "true" ) )
+	FRotator RecoilRotation;
+
+	/* additive translation for the weapon hand, fed to a Transform (Modify) Bone node in Add To Existing mode */
+	UPROPERTY( VisibleAnywhere, BlueprintReadOnly, Category = Recoil, Meta = ( AllowPrivateAccess = "true" ) )
+	FVector RecoilTranslation;
+
+	/* impulses added on the game thread since the last animation update */
+	FVector PendingRecoilImpulse;
+
+	/* cost of the last animation update and the frame it happened on */
+	float LastUpdateCostMs;
+	uint64 LastUpdateFrame;
+
+	/* running total for GetFrameUpdateCostMs, written on the game thread */
+	static float FrameUpdateCostMs;
+	static uint64 FrameUpdateCostFrame;
 };
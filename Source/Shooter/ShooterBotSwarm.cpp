@@ -0,0 +1,341 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterBotSwarm.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "WeaponStats.h"
+#include "ShooterCharacter.h"
+#include "ShooterStats.h"
+
+DECLARE_CYCLE_STAT( TEXT( "Bot Swarm Move" ), STAT_BotSwarmMove, STATGROUP_Shooter );
+DECLARE_CYCLE_STAT( TEXT( "Bot Swarm Sight" ), STAT_BotSwarmSight, STATGROUP_Shooter );
+DECLARE_CYCLE_STAT( TEXT( "Bot Swarm Combat" ), STAT_BotSwarmCombat, STATGROUP_Shooter );
+DECLARE_CYCLE_STAT( TEXT( "Bot Swarm Instances" ), STAT_BotSwarmInstances, STATGROUP_Shooter );
+DECLARE_DWORD_COUNTER_STAT( TEXT( "Bot Shots" ), STAT_BotShots, STATGROUP_Shooter );
+DECLARE_DWORD_COUNTER_STAT( TEXT( "Bot Shots Traced" ), STAT_BotShotsTraced, STATGROUP_Shooter );
+DECLARE_DWORD_COUNTER_STAT( TEXT( "Bot Hits" ), STAT_BotHits, STATGROUP_Shooter );
+DECLARE_DWORD_COUNTER_STAT( TEXT( "Bot Respawns" ), STAT_BotRespawns, STATGROUP_Shooter );
+DECLARE_DWORD_COUNTER_STAT( TEXT( "Bots Engaging Players" ), STAT_BotsEngagingPlayers, STATGROUP_Shooter );
+
+AShooterBotSwarm::AShooterBotSwarm( ) :
+	BotCount( 100 ),
+	WanderRadius( 3000.f ),
+	MoveSpeed( 300.f ),
+	EngageRange( 2500.f ),
+	EyeHeight( 60.f ),
+	WeaponType( NAME_None ),
+	MaxShotTracesPerFrame( 256 ),
+	SightAngle( 45.f ),
+	MaxSightTracesPerFrame( 64 ),
+	BotMaxHealth( 100.f ),
+	BotHitRadius( 40.f ),
+	RandomSeed( 1337 ),
+	DamageSubsystem( nullptr ),
+	TargetingSubsystem( nullptr ),
+	WeaponId( 0 )
+{
+	PrimaryActorTick.bCanEverTick = true;
+
+	SwarmRoot = CreateDefaultSubobject<USceneComponent>( TEXT( "SwarmRoot" ) );
+	SetRootComponent( SwarmRoot );
+
+	BotInstances = CreateDefaultSubobject<UInstancedStaticMeshComponent>( TEXT( "BotInstances" ) );
+	BotInstances->SetupAttachment( SwarmRoot );
+	BotInstances->SetCollisionEnabled( ECollisionEnabled::NoCollision );
+	BotInstances->SetCastShadow( false );
+}
+
+void AShooterBotSwarm::BeginPlay( )
+{
+	Super::BeginPlay( );
+
+	const UGameInstance* GameInstance = GetGameInstance( );
+	const UWeaponStatsSubsystem* WeaponStats = GameInstance ? GameInstance->GetSubsystem<UWeaponStatsSubsystem>( ) : nullptr;
+	if ( WeaponStats )
+	{
+		WeaponId = WeaponStats->FindWeaponId( WeaponType );
+	}
+	DamageSubsystem = GetWorld( )->GetSubsystem<UShooterDamageSubsystem>( );
+	TargetingSubsystem = GetWorld( )->GetSubsystem<UShooterTargetingSubsystem>( );
+
+	SpawnBots( BotCount );
+}
+
+void AShooterBotSwarm::EndPlay( const EEndPlayReason::Type EndPlayReason )
+{
+	UnregisterBots( );
+
+	Super::EndPlay( EndPlayReason );
+}
+
+void AShooterBotSwarm::UnregisterBots( )
+{
+	if ( DamageSubsystem )
+	{
+		for ( FShooterDamageHandle& Handle : DamageHandles )
+		{
+			DamageSubsystem->Unregister( Handle );
+		}
+	}
+	DamageHandles.Reset( );
+}
+
+void AShooterBotSwarm::SpawnBots( int32 Count )
+{
+	Count = FMath::Max( Count, 0 );
+	RandomStream.Initialize( RandomSeed );
+	UnregisterBots( );
+
+	Positions.SetNumUninitialized( Count );
+	MoveGoals.SetNumUninitialized( Count );
+	Targets.SetNumUninitialized( Count );
+	CombatStates.Reset( Count );
+	CombatStates.AddDefaulted( Count );
+
+	for ( int32 Bot = 0; Bot < Count; Bot++ )
+	{
+		Positions[Bot] = RandomGoal( );
+		MoveGoals[Bot] = RandomGoal( );
+		Targets[Bot] = RandomTarget( Bot );
+	}
+
+	if ( DamageSubsystem )
+	{
+		DamageHandles.Reserve( Count );
+		for ( int32 Bot = 0; Bot < Count; Bot++ )
+		{
+			DamageHandles.Add( DamageSubsystem->Register( this, BotMaxHealth, 0.f ) );
+		}
+	}
+
+	BotInstances->ClearInstances( );
+	if ( BotInstances->GetStaticMesh( ) && FApp::CanEverRender( ) )
+	{
+		InstanceTransforms.SetNum( Count );
+		for ( int32 Bot = 0; Bot < Count; Bot++ )
+		{
+			InstanceTransforms[Bot] = FTransform( Positions[Bot] );
+			BotInstances->AddInstanceWorldSpace( InstanceTransforms[Bot] );
+		}
+	}
+}
+
+void AShooterBotSwarm::Tick( float DeltaTime )
+{
+	Super::Tick( DeltaTime );
+
+	UpdateBotSight( );
+	UpdateBotCombat( DeltaTime );
+	UpdateBotInstances( );
+}
+
+void AShooterBotSwarm::MoveBots( float StepSeconds )
+{
+	SCOPE_CYCLE_COUNTER( STAT_BotSwarmMove );
+
+	const float StepDistance { MoveSpeed * StepSeconds };
+	for ( int32 Bot = 0; Bot < Positions.Num( ); Bot++ )
+	{
+		const FVector ToGoal { MoveGoals[Bot] - Positions[Bot] };
+		const float DistToGoal { ToGoal.Size( ) };
+		if ( DistToGoal <= StepDistance )
+		{
+			Positions[Bot] = MoveGoals[Bot];
+			MoveGoals[Bot] = RandomGoal( );
+		}
+		else
+		{
+			Positions[Bot] += ToGoal * ( StepDistance / DistToGoal );
+		}
+	}
+}
+
+void AShooterBotSwarm::UpdateBotSight( )
+{
+	SCOPE_CYCLE_COUNTER( STAT_BotSwarmSight );
+
+	if ( TargetingSubsystem == nullptr || TargetingSubsystem->GetNumTargets( ) == 0 )
+	{
+		Sightings.Reset( );
+		return;
+	}
+
+	const FVector EyeOffset { 0.f, 0.f, EyeHeight };
+	SightQueries.SetNum( Positions.Num( ) );
+	Sightings.SetNum( Positions.Num( ) );
+	for ( int32 Bot = 0; Bot < Positions.Num( ); Bot++ )
+	{
+		FShooterTargetQuery& Query = SightQueries[Bot];
+		Query.Origin = Positions[Bot] + EyeOffset;
+		Query.Direction = ( MoveGoals[Bot] - Positions[Bot] ).GetSafeNormal2D( );
+		Query.MaxRange = EngageRange;
+		Query.HalfAngleDegrees = SightAngle;
+	}
+	TargetingSubsystem->RunQueries( SightQueries, Sightings, MaxSightTracesPerFrame );
+}
+
+void AShooterBotSwarm::UpdateBotCombat( float DeltaTime )
+{
+	SCOPE_CYCLE_COUNTER( STAT_BotSwarmCombat );
+
+	const UWorld* World = GetWorld( );
+	const FWeaponStats& WeaponStats = UWeaponStatsSubsystem::GetStats( this, WeaponId );
+	const FVector EyeOffset { 0.f, 0.f, EyeHeight };
+	const float EngageRangeSquared { EngageRange * EngageRange };
+	const float HitRadiusSquared { BotHitRadius * BotHitRadius };
+	const bool bTakesDamage { DamageSubsystem && DamageHandles.Num( ) == Positions.Num( ) };
+
+	// every bot steps together on the swarm's combat clock; movement, targeting and fire all happen
+	// per step and bot by bot within a step, so the random stream is drawn in the same order at any frame rate.
+	// Sightings of players are still taken once a frame, so what bots see of players isn't step exact
+	const int32 Steps { CombatClock.Consume( DeltaTime ) };
+	const float StepSeconds { ShooterCombat::GetStepSeconds( ) };
+
+	// one chance a second, on average, to switch targets
+	const float RetargetChance { FMath::Min( StepSeconds, 1.f ) };
+
+	int32 Shots { 0 };
+	int32 TracedShots { 0 };
+	int32 Hits { 0 };
+	int32 Respawns { 0 };
+	int32 EngagingPlayers { 0 };
+
+	FMemMark Mark( FMemStack::Get( ) );
+	FShotSegmentArray ShotSegments;
+
+	FShooterCombatInputs CombatInputs;
+	CombatInputs.HorizontalSpeed = MoveSpeed;
+	CombatInputs.bIsInAir = false;
+
+	for ( int32 Step = 0; Step < Steps; Step++ )
+	{
+		MoveBots( StepSeconds );
+
+		for ( int32 Bot = 0; Bot < Positions.Num( ); Bot++ )
+		{
+			FShooterCombatState& State = CombatStates[Bot];
+
+			// killed last frame: back in somewhere else, not shooting until the next step
+			if ( bTakesDamage && DamageSubsystem->IsDead( DamageHandles[Bot] ) )
+			{
+				Positions[Bot] = RandomGoal( );
+				MoveGoals[Bot] = RandomGoal( );
+				State = FShooterCombatState( );
+				DamageSubsystem->Revive( DamageHandles[Bot] );
+				Respawns++;
+				continue;
+			}
+
+			if ( RandomStream.FRand( ) < RetargetChance )
+			{
+				Targets[Bot] = RandomTarget( Bot );
+			}
+			const int32 Target { Targets[Bot] };
+
+			// a player in sight takes priority over the bot we were fighting; sightings past the trace budget weren't checked, so they don't count
+			const AShooterCharacter* Player = Sightings.IsValidIndex( Bot ) && Sightings[Bot].bTraced ? Sightings[Bot].Target.Get( ) : nullptr;
+			const bool bEngaged { Player != nullptr || ( Target != INDEX_NONE &&
+				FVector::DistSquared( Positions[Bot], Positions[Target] ) <= EngageRangeSquared ) };
+			if ( Player && Step == 0 )
+			{
+				EngagingPlayers++;
+			}
+
+			State.bFireButtonPressed = bEngaged;
+			CombatInputs.bAiming = bEngaged;
+
+			ShooterCombat::AdvanceTimers( State, StepSeconds );
+			ShooterCombat::CalculateCrosshairSpread( State, CombatInputs, StepSeconds );
+
+			if ( !bEngaged || !ShooterCombat::TryFire( State, WeaponStats ) )
+			{
+				continue;
+			}
+			Shots++;
+
+			const FVector Muzzle { Positions[Bot] + EyeOffset };
+			const FVector AimPoint { Player ? Sightings[Bot].AimPoint : Positions[Target] + EyeOffset };
+			const FVector ToTarget { AimPoint - Muzzle };
+			const FVector ShotDirection { ShooterCombat::ApplySpread( State, ToTarget.GetSafeNormal( ), RandomStream ) };
+			const FVector ShotEnd { Muzzle + ShotDirection * ToTarget.Size( ) };
+			bool bHit { FVector::DistSquared( ShotEnd, AimPoint ) <= HitRadiusSquared };
+
+			// shots at bots over the trace budget land unless spread sends them wide; a player is never hit without a trace
+			if ( Player && TracedShots >= MaxShotTracesPerFrame )
+			{
+				bHit = false;
+			}
+			else if ( TracedShots < MaxShotTracesPerFrame )
+			{
+				TracedShots++;
+				const bool bBlocked { ShooterCombat::TraceHitscan(
+					World,
+					Muzzle,
+					ShotEnd,
+					WeaponStats,
+					this,
+					ShotSegments ) };
+
+				// bots have no collision, so whatever the shot hits short of the target is in the way; the trace runs
+				// the weapon's full range, so a wall behind the target isn't. A player has to be hit by the trace itself
+				const bool bObstructed { bBlocked && ShotSegments.Num( ) > 0 &&
+					ShotSegments[0].EndType != EShotSegmentEnd::ESE_None &&
+					FVector::DistSquared( Muzzle, ShotSegments[0].End ) < ToTarget.SizeSquared( ) };
+				bHit = Player
+					? bBlocked && ShotSegments.ContainsByPredicate( [Player]( const FShotSegment& Segment )
+						{
+							return Segment.HitComponent && Segment.HitComponent->GetOwner( ) == Player;
+						} )
+					: bHit && !bObstructed;
+			}
+
+			if ( bHit && bTakesDamage )
+			{
+				DamageSubsystem->ApplyHit( Player ? Player->GetDamageHandle( ) : DamageHandles[Target], DamageHandles[Bot], WeaponStats.Damage );
+				Hits++;
+			}
+		}
+	}
+
+	SET_DWORD_STAT( STAT_BotShots, Shots );
+	SET_DWORD_STAT( STAT_BotShotsTraced, TracedShots );
+	SET_DWORD_STAT( STAT_BotHits, Hits );
+	SET_DWORD_STAT( STAT_BotRespawns, Respawns );
+	SET_DWORD_STAT( STAT_BotsEngagingPlayers, EngagingPlayers );
+}
+
+void AShooterBotSwarm::UpdateBotInstances( )
+{
+	SCOPE_CYCLE_COUNTER( STAT_BotSwarmInstances );
+
+	if ( BotInstances->GetInstanceCount( ) != Positions.Num( ) )
+	{
+		return;
+	}
+
+	for ( int32 Bot = 0; Bot < Positions.Num( ); Bot++ )
+	{
+		const FRotator Facing { ( MoveGoals[Bot] - Positions[Bot] ).Rotation( ) };
+		InstanceTransforms[Bot] = FTransform( FRotator( 0.f, Facing.Yaw, 0.f ), Positions[Bot] );
+	}
+	BotInstances->BatchUpdateInstancesTransforms( 0, InstanceTransforms, true, true, true );
+}
+
+FVector AShooterBotSwarm::RandomGoal( )
+{
+	const FVector2D Offset { FVector2D( RandomStream.VRand( ) ).GetSafeNormal( ) * RandomStream.FRandRange( 0.f, WanderRadius ) };
+	return GetActorLocation( ) + FVector( Offset, 0.f );
+}
+
+int32 AShooterBotSwarm::RandomTarget( int32 BotIndex )
+{
+	const int32 NumBots { Positions.Num( ) };
+	if ( NumBots < 2 )
+	{
+		return INDEX_NONE;
+	}
+	// any bot but ourselves
+	return ( BotIndex + RandomStream.RandRange( 1, NumBots - 1 ) ) % NumBots;
+}
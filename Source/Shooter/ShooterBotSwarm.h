@@ -0,0 +1,143 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "ShooterCombat.h"
+#include "ShooterDamageSubsystem.h"
+#include "ShooterTargetingSubsystem.h"
+#include "ShooterBotSwarm.generated.h"
+
+/**
+ * Many lightweight shooter bots in one actor.
+ * Bot transforms and combat state live in flat arrays; movement is a straight walk between
+ * random goals on the swarm's plane, and combat runs the same ShooterCombat rules as AShooterCharacter.
+ * Bots shoot at player characters they can see ahead of them, found for the whole swarm in one
+ * targeting batch a frame, and otherwise at each other.
+ */
+UCLASS()
+class SHOOTER_API AShooterBotSwarm : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AShooterBotSwarm( );
+
+	virtual void Tick( float DeltaTime ) override;
+
+	/* replace all bots with Count new ones scattered around the swarm */
+	UFUNCTION( BlueprintCallable, Category = Bots )
+	void SpawnBots( int32 Count );
+
+	FORCEINLINE int32 GetNumBots( ) const { return Positions.Num( ); }
+
+	/* bots to spawn in BeginPlay; set before FinishSpawning */
+	FORCEINLINE void SetBotCount( int32 Count ) { BotCount = Count; }
+
+protected:
+	virtual void BeginPlay( ) override;
+
+	virtual void EndPlay( const EEndPlayReason::Type EndPlayReason ) override;
+
+	/* walk every bot one combat step toward its goal, picking a new goal on arrival */
+	void MoveBots( float StepSeconds );
+
+	/* look for player characters ahead of every bot in one targeting batch */
+	void UpdateBotSight( );
+
+	/* this frame's fixed combat steps for every bot: movement, targeting, fire cadence, spread and hitscan */
+	void UpdateBotCombat( float DeltaTime );
+
+	/* write all bot transforms to the instanced mesh in one batch */
+	void UpdateBotInstances( );
+
+private:
+	UPROPERTY( VisibleAnywhere, BlueprintReadOnly, Category = Bots, meta = ( AllowPrivateAccess = "true" ) )
+	USceneComponent* SwarmRoot;
+
+	/* optional stand-in mesh for the bots, one instance per bot */
+	UPROPERTY( VisibleAnywhere, BlueprintReadOnly, Category = Bots, meta = ( AllowPrivateAccess = "true" ) )
+	class UInstancedStaticMeshComponent* BotInstances;
+
+	/* bots spawned in BeginPlay */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = Bots, meta = ( AllowPrivateAccess = "true", ClampMin = "0" ) )
+	int32 BotCount;
+
+	/* bots spawn and wander within this distance of the swarm */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = Bots, meta = ( AllowPrivateAccess = "true" ) )
+	float WanderRadius;
+
+	/* walking speed, cm/s */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = Bots, meta = ( AllowPrivateAccess = "true" ) )
+	float MoveSpeed;
+
+	/* bots hold the trigger while their target is closer than this */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = Bots, meta = ( AllowPrivateAccess = "true" ) )
+	float EngageRange;
+
+	/* height of the muzzle and aim point above a bot's position */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = Bots, meta = ( AllowPrivateAccess = "true" ) )
+	float EyeHeight;
+
+	/* row of the weapon definition table every bot fires */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = Bots, meta = ( AllowPrivateAccess = "true" ) )
+	FName WeaponType;
+
+	/* most world traces the swarm may run per frame; shots beyond it count as hits without tracing */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = Bots, meta = ( AllowPrivateAccess = "true" ) )
+	int32 MaxShotTracesPerFrame;
+
+	/* bots see player characters within this many degrees of their walking direction, up to EngageRange */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = Bots, meta = ( AllowPrivateAccess = "true", ClampMin = "0.0", ClampMax = "89.0" ) )
+	float SightAngle;
+
+	/* most visibility traces the swarm's sight batch may run per frame; bots ignore players they couldn't trace */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = Bots, meta = ( AllowPrivateAccess = "true" ) )
+	int32 MaxSightTracesPerFrame;
+
+	/* health each bot spawns and respawns with */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = Bots, meta = ( AllowPrivateAccess = "true", ClampMin = "1.0" ) )
+	float BotMaxHealth;
+
+	/* a shot that ends this close to its target's eye point hits */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = Bots, meta = ( AllowPrivateAccess = "true" ) )
+	float BotHitRadius;
+
+	/* seed for bot placement, goals, targets and spread */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = Bots, meta = ( AllowPrivateAccess = "true" ) )
+	int32 RandomSeed;
+
+	/* per-bot state, all indexed by bot */
+	TArray<FVector> Positions;
+	TArray<FVector> MoveGoals;
+	TArray<FShooterCombatState> CombatStates;
+
+	/* fixed combat steps shared by every bot */
+	FShooterCombatClock CombatClock;
+	TArray<int32> Targets;
+	TArray<FShooterDamageHandle> DamageHandles;
+
+	UPROPERTY( Transient )
+	UShooterDamageSubsystem* DamageSubsystem;
+
+	UPROPERTY( Transient )
+	UShooterTargetingSubsystem* TargetingSubsystem;
+
+	/* scratch for the sight batch, one per bot, kept to avoid reallocating every frame */
+	TArray<FShooterTargetQuery> SightQueries;
+	TArray<FShooterTargetResult> Sightings;
+
+	/* scratch for UpdateBotInstances, kept to avoid reallocating every frame */
+	TArray<FTransform> InstanceTransforms;
+
+	/* id of WeaponType's baked stats */
+	uint8 WeaponId;
+
+	FRandomStream RandomStream;
+
+	FVector RandomGoal( );
+	int32 RandomTarget( int32 BotIndex );
+
+	void UnregisterBots( );
+};
@@ -0,0 +1,223 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterCaptureScheduler.h"
+#include "Components/SceneCaptureComponent2D.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "UObject/UObjectIterator.h"
+#include "ShooterStats.h"
+
+DECLARE_CYCLE_STAT( TEXT( "Capture Scheduler" ), STAT_CaptureScheduler, STATGROUP_Shooter );
+DECLARE_DWORD_COUNTER_STAT( TEXT( "Captures Per Frame" ), STAT_CapturesPerFrame, STATGROUP_Shooter );
+DECLARE_DWORD_COUNTER_STAT( TEXT( "Captures Skipped (Irrelevant)" ), STAT_CapturesSkipped, STATGROUP_Shooter );
+DECLARE_DWORD_COUNTER_STAT( TEXT( "Captures Waiting (Over Budget)" ), STAT_CapturesWaiting, STATGROUP_Shooter );
+DECLARE_DWORD_COUNTER_STAT( TEXT( "Captures Registered" ), STAT_CapturesRegistered, STATGROUP_Shooter );
+
+static TAutoConsoleVariable<int32> CVarCaptureBudget(
+	TEXT( "shooter.Capture.Budget" ),
+	2,
+	TEXT( "Most scene captures rendered per frame" ) );
+
+static TAutoConsoleVariable<float> CVarCaptureMaxDistance(
+	TEXT( "shooter.Capture.MaxDistance" ),
+	3000.f,
+	TEXT( "Default distance beyond which a capture's monitor is too far away to update" ) );
+
+void UShooterCaptureScheduler::Initialize( FSubsystemCollectionBase& Collection )
+{
+	Super::Initialize( Collection );
+
+	// captures that show up after the first scan would otherwise keep rendering every frame
+	if ( UWorld* World = GetWorld( ) )
+	{
+		ActorSpawnedHandle = World->AddOnActorSpawnedHandler( FOnActorSpawned::FDelegate::CreateUObject( this, &UShooterCaptureScheduler::OnActorSpawned ) );
+	}
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject( this, &UShooterCaptureScheduler::OnLevelAdded );
+}
+
+void UShooterCaptureScheduler::Deinitialize( )
+{
+	if ( UWorld* World = GetWorld( ) )
+	{
+		World->RemoveOnActorSpawnedHandler( ActorSpawnedHandle );
+	}
+	FWorldDelegates::LevelAddedToWorld.Remove( LevelAddedHandle );
+	Captures.Reset( );
+
+	Super::Deinitialize( );
+}
+
+void UShooterCaptureScheduler::RegisterCapture( USceneCaptureComponent2D* Capture, UPrimitiveComponent* DisplaySurface, float MaxDistance )
+{
+	if ( Capture == nullptr )
+	{
+		return;
+	}
+
+	// the scheduler decides when it renders from now on
+	Capture->bCaptureEveryFrame = false;
+	Capture->bCaptureOnMovement = false;
+
+	for ( FScheduledCapture& Scheduled : Captures )
+	{
+		if ( Scheduled.Capture == Capture )
+		{
+			Scheduled.DisplaySurface = DisplaySurface;
+			Scheduled.MaxDistance = MaxDistance;
+			return;
+		}
+	}
+	Captures.Add( { Capture, DisplaySurface, MaxDistance } );
+}
+
+void UShooterCaptureScheduler::UnregisterCapture( USceneCaptureComponent2D* Capture )
+{
+	Captures.RemoveAll( [Capture]( const FScheduledCapture& Scheduled ) { return Scheduled.Capture == Capture; } );
+}
+
+bool UShooterCaptureScheduler::IsTickable( ) const
+{
+	const UWorld* World = GetWorld( );
+	return !IsTemplate( ) && World && World->IsGameWorld( ) && !IsRunningDedicatedServer( );
+}
+
+TStatId UShooterCaptureScheduler::GetStatId( ) const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT( UShooterCaptureScheduler, STATGROUP_Tickables );
+}
+
+void UShooterCaptureScheduler::DiscoverCaptures( )
+{
+	const UWorld* World = GetWorld( );
+	for ( USceneCaptureComponent2D* Capture : TObjectRange<USceneCaptureComponent2D>( ) )
+	{
+		if ( Capture->GetWorld( ) == World && Capture->bCaptureEveryFrame && !Capture->IsTemplate( ) )
+		{
+			RegisterCapture( Capture, nullptr );
+		}
+	}
+	bDiscoveredCaptures = true;
+}
+
+void UShooterCaptureScheduler::TakeOverCaptures( const AActor* Actor )
+{
+	TInlineComponentArray<USceneCaptureComponent2D*> ActorCaptures( Actor );
+	for ( USceneCaptureComponent2D* Capture : ActorCaptures )
+	{
+		if ( Capture->bCaptureEveryFrame )
+		{
+			RegisterCapture( Capture, nullptr );
+		}
+	}
+}
+
+void UShooterCaptureScheduler::OnActorSpawned( AActor* Actor )
+{
+	// before the first scan, that scan finds it
+	if ( bDiscoveredCaptures && Actor )
+	{
+		TakeOverCaptures( Actor );
+	}
+}
+
+void UShooterCaptureScheduler::OnLevelAdded( ULevel* Level, UWorld* World )
+{
+	if ( World == GetWorld( ) )
+	{
+		bDiscoveredCaptures = false;
+	}
+}
+
+bool UShooterCaptureScheduler::IsCaptureRelevant(
+	const FScheduledCapture& Scheduled,
+	const TArray<FVector, TInlineAllocator<4>>& ViewLocations ) const
+{
+	const USceneCaptureComponent2D* Capture = Scheduled.Capture.Get( );
+	if ( Capture == nullptr || Capture->TextureTarget == nullptr )
+	{
+		return false;
+	}
+
+	// without a known monitor we can only go by where the capture is
+	const UPrimitiveComponent* DisplaySurface = Scheduled.DisplaySurface.Get( );
+	if ( DisplaySurface && !DisplaySurface->WasRecentlyRendered( 0.2f ) )
+	{
+		return false;
+	}
+
+	const FVector DisplayLocation { DisplaySurface ? DisplaySurface->GetComponentLocation( ) : Capture->GetComponentLocation( ) };
+	const float MaxDistance { Scheduled.MaxDistance > 0.f ? Scheduled.MaxDistance : CVarCaptureMaxDistance.GetValueOnGameThread( ) };
+	for ( const FVector& ViewLocation : ViewLocations )
+	{
+		if ( FVector::DistSquared( ViewLocation, DisplayLocation ) <= FMath::Square( MaxDistance ) )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void UShooterCaptureScheduler::Tick( float DeltaTime )
+{
+	SCOPE_CYCLE_COUNTER( STAT_CaptureScheduler );
+
+	if ( !bDiscoveredCaptures )
+	{
+		DiscoverCaptures( );
+	}
+	Captures.RemoveAll( []( const FScheduledCapture& Scheduled ) { return !Scheduled.Capture.IsValid( ); } );
+	SET_DWORD_STAT( STAT_CapturesRegistered, Captures.Num( ) );
+	if ( Captures.Num( ) == 0 )
+	{
+		return;
+	}
+
+	TArray<FVector, TInlineAllocator<4>> ViewLocations;
+	for ( FConstPlayerControllerIterator It = GetWorld( )->GetPlayerControllerIterator( ); It; ++It )
+	{
+		const APlayerController* PlayerController = It->Get( );
+		if ( PlayerController && PlayerController->IsLocalController( ) )
+		{
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PlayerController->GetPlayerViewPoint( ViewLocation, ViewRotation );
+			ViewLocations.Add( ViewLocation );
+		}
+	}
+
+	// walk the ring once from where we stopped last frame, rendering relevant captures until the budget is spent
+	const int32 Budget { FMath::Max( CVarCaptureBudget.GetValueOnGameThread( ), 0 ) };
+	int32 Rendered { 0 };
+	int32 Skipped { 0 };
+	int32 Waiting { 0 };
+	const int32 NumCaptures { Captures.Num( ) };
+	int32 ResumeAt { INDEX_NONE };
+	for ( int32 Step = 0; Step < NumCaptures; Step++ )
+	{
+		const int32 CaptureIndex { ( NextCapture + Step ) % NumCaptures };
+		const FScheduledCapture& Scheduled = Captures[CaptureIndex];
+		if ( !IsCaptureRelevant( Scheduled, ViewLocations ) )
+		{
+			Skipped++;
+			continue;
+		}
+		if ( Rendered >= Budget )
+		{
+			// first capture that missed out goes first next frame
+			if ( ResumeAt == INDEX_NONE )
+			{
+				ResumeAt = CaptureIndex;
+			}
+			Waiting++;
+			continue;
+		}
+		Scheduled.Capture->CaptureScene( );
+		Rendered++;
+	}
+	NextCapture = ResumeAt != INDEX_NONE ? ResumeAt : ( NextCapture + 1 ) % NumCaptures;
+
+	SET_DWORD_STAT( STAT_CapturesPerFrame, Rendered );
+	SET_DWORD_STAT( STAT_CapturesSkipped, Skipped );
+	SET_DWORD_STAT( STAT_CapturesWaiting, Waiting );
+}
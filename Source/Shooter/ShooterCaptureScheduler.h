@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ShooterCaptureScheduler.generated.h"
+
+/**
+ * Updates the world's render-target scene captures round-robin under a per-frame capture budget.
+ * Captures whose monitor is off-screen or far from every local player are skipped.
+ * Every USceneCaptureComponent2D set to capture every frame is taken over automatically, including
+ * ones spawned or streamed in later;
+ * Blueprints can call RegisterCapture to tell the scheduler which mesh displays the render target.
+ */
+UCLASS()
+class SHOOTER_API UShooterCaptureScheduler : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize( FSubsystemCollectionBase& Collection ) override;
+	virtual void Deinitialize( ) override;
+
+	/**
+	* Schedule Capture instead of letting it render every frame
+	* @param DisplaySurface  The monitor showing the capture's render target; visibility and distance are tested against it
+	* @param MaxDistance     Skip the capture while no player is this close to the monitor. 0 uses shooter.Capture.MaxDistance
+	*/
+	UFUNCTION( BlueprintCallable, Category = SceneCapture )
+	void RegisterCapture( class USceneCaptureComponent2D* Capture, UPrimitiveComponent* DisplaySurface, float MaxDistance = 0.f );
+
+	UFUNCTION( BlueprintCallable, Category = SceneCapture )
+	void UnregisterCapture( USceneCaptureComponent2D* Capture );
+
+	// FTickableGameObject
+	virtual void Tick( float DeltaTime ) override;
+	virtual bool IsTickable( ) const override;
+	virtual TStatId GetStatId( ) const override;
+	virtual UWorld* GetTickableGameObjectWorld( ) const override { return GetWorld( ); }
+
+private:
+	struct FScheduledCapture
+	{
+		TWeakObjectPtr<USceneCaptureComponent2D> Capture;
+		TWeakObjectPtr<UPrimitiveComponent> DisplaySurface;
+		float MaxDistance;
+	};
+
+	/* take over every every-frame capture already in the world */
+	void DiscoverCaptures( );
+
+	/* take over Actor's every-frame captures */
+	void TakeOverCaptures( const AActor* Actor );
+
+	void OnActorSpawned( AActor* Actor );
+
+	/* a streamed level came in; rescan on the next tick */
+	void OnLevelAdded( ULevel* Level, UWorld* World );
+
+	/* should Scheduled render this frame, given the local players' view locations */
+	bool IsCaptureRelevant( const FScheduledCapture& Scheduled, const TArray<FVector, TInlineAllocator<4>>& ViewLocations ) const;
+
+	TArray<FScheduledCapture> Captures;
+
+	/* where the round-robin picks up next frame */
+	int32 NextCapture { 0 };
+
+	bool bDiscoveredCaptures { false };
+
+	FDelegateHandle ActorSpawnedHandle;
+	FDelegateHandle LevelAddedHandle;
+};
@@ -6,6 +6,10 @@
 #include "Camera/CameraComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Kismet/GameplayStatics.h"
+#include "GameFramework/PlayerController.h"
+#include "Components/InputComponent.h"
+#include "Engine/GameInstance.h"
+#include "Net/UnrealNetwork.h"
 #include "Sound/SoundCue.h"
 #include "Engine/SkeletalMeshSocket.h"
 #include "DrawDebugHelpers.h"
@@ -15,6 +19,13 @@
 #include "Weapon.h"
 #include "Components/BoxComponent.h"
 #include "Components/SphereComponent.h"
+#include "WeaponStats.h"
+#include "ShooterAnimInstance.h"
+#include "ShooterAnimBudgetSubsystem.h"
+#include "ShooterCollision.h"
+#include "ShooterHUD.h"
+#include "ShooterInputSubsystem.h"
+#include "ShooterTargetingSubsystem.h"
 
 // Sets default values
 AShooterCharacter::AShooterCharacter( ) :
@@ -44,15 +55,27 @@ AShooterCharacter::AShooterCharacter( ) :
 	CrosshairInAirFactor( 0.f ),
 	CrosshairAimFactor( 0.f ),
 	CrosshairShootingFactor( 0.f ),
-	// automatic fire variables
+	// equipped weapon stats
+	EquippedWeaponId( 0 ),
 	AutomaticFireRate( 0.1f ),
-	bShouldFire( true ),
-	bFireButtonPressed( false ),
-	// Item trace variables
-	bShouldTraceForItems( false ),
-	// bullet fire timer variables
 	ShootTimeDuration( 0.05f ),
-	bFiringBullet( false )
+	DefaultWeaponStats( UWeaponStatsSubsystem::GetDefaultStats( ) ),
+	// vehicle seat
+	bSeated( false ),
+	UnseatedAnimTickOption( EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones ),
+	InputSubsystem( nullptr ),
+	bJumpButtonPressed( false ),
+	// health and armor
+	MaxHealth( 100.f ),
+	MaxArmor( 0.f ),
+	DamageSubsystem( nullptr ),
+	// aim assist
+	AimAssistSlowdown( 0.4f ),
+	AimAssistAngle( 4.f ),
+	AimAssistRange( 6000.f ),
+	AimAssistScale( 1.f ),
+	TargetingSubsystem( nullptr ),
+	AimAssistQuerier( INDEX_NONE )
 
 {
 	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
@@ -92,8 +115,60 @@ void AShooterCharacter::BeginPlay( )
 		CameraDefaultFOV = GetFollowCamera( )->FieldOfView;
 		CameraCurrentFOV = CameraDefaultFOV;
 	}
-	// spawn the default weapon and equip it
-	EquipWeapon( SpawnDefaultWeapon() );
+	// weapons without a definition row keep the cadence tuned on the character
+	DefaultWeaponStats.AutomaticFireRate = AutomaticFireRate;
+	DefaultWeaponStats.ShootTimeDuration = ShootTimeDuration;
+	// spawn the default weapon and equip it; clients get the server's weapon through replication
+	if ( HasAuthority( ) )
+	{
+		EquipWeapon( SpawnDefaultWeapon( ) );
+	}
+
+	if ( const UGameInstance* GameInstance = GetGameInstance( ) )
+	{
+		InputSubsystem = GameInstance->GetSubsystem<UShooterInputSubsystem>( );
+	}
+
+	// share the per-frame animation budget with every other character
+	if ( UShooterAnimBudgetSubsystem* AnimBudget = GetWorld( )->GetSubsystem<UShooterAnimBudgetSubsystem>( ) )
+	{
+		AnimBudget->RegisterMesh( GetMesh( ) );
+	}
+
+	DamageSubsystem = GetWorld( )->GetSubsystem<UShooterDamageSubsystem>( );
+	if ( DamageSubsystem )
+	{
+		DamageHandle = DamageSubsystem->Register( this, MaxHealth, MaxArmor );
+		DamageSubsystem->SetOnDamaged( DamageHandle, FOnShooterDamaged::CreateUObject( this, &AShooterCharacter::OnDamaged ) );
+	}
+
+	// other players' aim assist and bots find us here
+	TargetingSubsystem = GetWorld( )->GetSubsystem<UShooterTargetingSubsystem>( );
+	if ( TargetingSubsystem )
+	{
+		TargetingSubsystem->RegisterTarget( this );
+	}
+}
+
+void AShooterCharacter::EndPlay( const EEndPlayReason::Type EndPlayReason )
+{
+	if ( UShooterAnimBudgetSubsystem* AnimBudget = GetWorld( )->GetSubsystem<UShooterAnimBudgetSubsystem>( ) )
+	{
+		AnimBudget->UnregisterMesh( GetMesh( ) );
+	}
+
+	if ( DamageSubsystem )
+	{
+		DamageSubsystem->Unregister( DamageHandle );
+	}
+
+	if ( TargetingSubsystem )
+	{
+		TargetingSubsystem->RemoveQuerier( AimAssistQuerier );
+		TargetingSubsystem->UnregisterTarget( this );
+	}
+
+	Super::EndPlay( EndPlayReason );
 }
 
 void AShooterCharacter::MoveForward( float Value )
@@ -125,12 +200,12 @@ void AShooterCharacter::MoveRight( float Value )
 void AShooterCharacter::TurnAtRate( float Rate )
 {
 	// calculate delta for this frame from the rate information
-	AddControllerYawInput( Rate * BaseTurnRate * GetWorld( )->GetDeltaSeconds( ) ); // deg/sec * sec/frame
+	AddControllerYawInput( Rate * BaseTurnRate * AimAssistScale * GetWorld( )->GetDeltaSeconds( ) ); // deg/sec * sec/frame
 }
 
 void AShooterCharacter::LookUpAtRate( float Rate )
 {
-	AddControllerPitchInput( Rate * BaseLookUpRate * GetWorld( )->GetDeltaSeconds( ) ); // deg/sec * sec/frame
+	AddControllerPitchInput( Rate * BaseLookUpRate * AimAssistScale * GetWorld( )->GetDeltaSeconds( ) ); // deg/sec * sec/frame
 }
 
 void AShooterCharacter::Turn( float Value )
@@ -145,6 +220,11 @@ void AShooterCharacter::Turn( float Value )
 		TurnScaleFactor = MouseHipTurnRate;
 	}
 	AddControllerYawInput( Value * TurnScaleFactor );
+
+	if ( ShouldMeasureLatency( ) && Value != 0.f )
+	{
+		InputSubsystem->MarkInput( EShooterLatencyEvent::ESLE_Look );
+	}
 }
 
 void AShooterCharacter::LookUp( float Value )
@@ -159,93 +239,130 @@ void AShooterCharacter::LookUp( float Value )
 		LookUpScaleFactor = MouseHipLookUpRate;
 	}
 	AddControllerPitchInput( Value * LookUpScaleFactor );
+
+	if ( ShouldMeasureLatency( ) && Value != 0.f )
+	{
+		InputSubsystem->MarkInput( EShooterLatencyEvent::ESLE_Look );
+	}
 }
 
 void AShooterCharacter::FireWeapon( )
 {
-	if ( FireSound )
+	const FWeaponStats& WeaponStats = GetEquippedWeaponStats( );
+
+#if !UE_SERVER
+	// the character's own effects stand in for anything the weapon definition leaves out
+	USoundCue* WeaponFireSound = WeaponStats.FireSound ? WeaponStats.FireSound : FireSound;
+	UParticleSystem* WeaponMuzzleFlash = WeaponStats.MuzzleFlash ? WeaponStats.MuzzleFlash : MuzzleFlash;
+	UParticleSystem* WeaponImpactParticles = WeaponStats.ImpactParticles ? WeaponStats.ImpactParticles : ImpactParticles;
+	UParticleSystem* WeaponBeamParticles = WeaponStats.BeamParticles ? WeaponStats.BeamParticles : BeamParticles;
+	UAnimMontage* WeaponHipFireMontage = WeaponStats.HipFireMontage ? WeaponStats.HipFireMontage : HipFireMontage;
+
+	if ( WeaponFireSound )
 	{
-		UGameplayStatics::PlaySound2D( this, FireSound );
+		UGameplayStatics::PlaySound2D( this, WeaponFireSound );
 	}
+#endif
 	const USkeletalMeshSocket* BarrelSocket = GetMesh( )->GetSocketByName( "BarrelSocket" );
 	if ( BarrelSocket )
 	{
 		const FTransform SocketTransform = BarrelSocket->GetSocketTransform( GetMesh( ) );
 
-		if ( MuzzleFlash )
+#if !UE_SERVER
+		if ( WeaponMuzzleFlash )
 		{
-			UGameplayStatics::SpawnEmitterAtLocation( GetWorld( ), MuzzleFlash, SocketTransform );
+			UGameplayStatics::SpawnEmitterAtLocation( GetWorld( ), WeaponMuzzleFlash, SocketTransform );
+		}
+#endif
+		if ( ShouldMeasureLatency( ) )
+		{
+			InputSubsystem->MarkResponse( EShooterLatencyEvent::ESLE_Fire );
 		}
 
-		FVector BeamEnd;
+		// shot segments and hits are scratch data for this frame only
+		FMemMark Mark( FMemStack::Get( ) );
+		FShotSegmentArray BeamSegments;
 		bool bBeamEnd = GetBeamEndLocation(
-			SocketTransform.GetLocation( ), BeamEnd );
+			SocketTransform.GetLocation( ), BeamSegments );
 		if ( bBeamEnd )
 		{
-			if ( ImpactParticles )
+#if !UE_SERVER
+			const APlayerController* PlayerController = Cast<APlayerController>( GetController( ) );
+			AShooterHUD* ShooterHUD = PlayerController ? PlayerController->GetHUD<AShooterHUD>( ) : nullptr;
+#endif
+			for ( int32 i = 0; i < BeamSegments.Num( ); i++ )
 			{
-				UGameplayStatics::SpawnEmitterAtLocation(
-					GetWorld( ),
-					ImpactParticles,
-					BeamEnd );
-			}
+				const FShotSegment& Segment = BeamSegments[i];
+				// queued for the end of the frame, with every other hit
+				if ( DamageSubsystem && Segment.HitComponent )
+				{
+					DamageSubsystem->ApplyHit( DamageSubsystem->FindHandle( Segment.HitComponent->GetOwner( ) ), DamageHandle, WeaponStats.Damage );
+				}
 
-			UParticleSystemComponent* Beam = UGameplayStatics::SpawnEmitterAtLocation(
-				GetWorld( ),
-				BeamParticles,
-				SocketTransform );
-			if ( Beam )
-			{
-				Beam->SetVectorParameter( FName( "Target" ), BeamEnd );
+#if !UE_SERVER
+				if ( WeaponImpactParticles && Segment.EndType != EShotSegmentEnd::ESE_None )
+				{
+					UGameplayStatics::SpawnEmitterAtLocation(
+						GetWorld( ),
+						WeaponImpactParticles,
+						Segment.End );
+				}
+				if ( ShooterHUD && Segment.EndType != EShotSegmentEnd::ESE_None )
+				{
+					ShooterHUD->AddHitMarker( Segment.End );
+				}
+
+				// the first beam leaves the barrel, the rest start where the bullet penetrated or bounced
+				UParticleSystemComponent* Beam = UGameplayStatics::SpawnEmitterAtLocation(
+					GetWorld( ),
+					WeaponBeamParticles,
+					i == 0 ? SocketTransform : FTransform( Segment.Start ) );
+				if ( Beam )
+				{
+					Beam->SetVectorParameter( FName( "Target" ), Segment.End );
+				}
+#endif
 			}
 		}
 	}
+
+#if !UE_SERVER
 	UAnimInstance* AnimInstance = GetMesh( )->GetAnimInstance( );
-	if ( AnimInstance && HipFireMontage )
+	UShooterAnimInstance* ShooterAnimInstance = Cast<UShooterAnimInstance>( AnimInstance );
+	if ( ShooterAnimInstance && ShooterAnimInstance->UsesProceduralRecoil( ) )
 	{
-		AnimInstance->Montage_Play( HipFireMontage );
+		// procedural fire reaction, no montage restart per shot
+		ShooterAnimInstance->AddRecoilImpulse(
+			WeaponStats.RecoilKick,
+			WeaponStats.RecoilPitch,
+			FMath::FRandRange( -WeaponStats.RecoilYawJitter, WeaponStats.RecoilYawJitter ) );
+	}
+	else if ( AnimInstance && WeaponHipFireMontage && !AnimInstance->Montage_IsPlaying( WeaponHipFireMontage ) )
+	{
+		AnimInstance->Montage_Play( WeaponHipFireMontage );
 		AnimInstance->Montage_JumpToSection( FName( "StartFire" ) );
 	}
-
-	// start bullet fire timer for crosshairs
-	StartCrosshairBulletFire( );
+#endif
 }
 
 bool AShooterCharacter::GetBeamEndLocation(
 	const FVector& MuzzleSocketLocation,
-	FVector& OutBeamLocation )
+	FShotSegmentArray& OutSegments )
 {
 	// check for crosshair trace hit
 	FHitResult CrossHairHitResult;
-	bool bCrosshairHit = TraceUnderCrossHars( CrossHairHitResult, OutBeamLocation );
-
-	if ( bCrosshairHit )
-	{
-		// tentative beam l;ocation - still need to trace from gun
-		OutBeamLocation = CrossHairHitResult.Location;
-	}
-	else // no crosshair trace hit
-	{
-		// out beam location is the end location for the line trace
-	}
-
-	// Perform a second trace, this time from the gun barrel
-	FHitResult WeaponTraceHit;
-	const FVector WeaponTraceStart { MuzzleSocketLocation };
-	const FVector StartToEnd { OutBeamLocation - MuzzleSocketLocation };
-	const FVector WeaponTraceEnd { MuzzleSocketLocation + StartToEnd * 1.25f };
-
-	GetWorld( )->LineTraceSingleByChannel(
-		WeaponTraceHit,
-		WeaponTraceStart,
-		WeaponTraceEnd,
-		ECollisionChannel::ECC_Visibility );
-	if ( WeaponTraceHit.bBlockingHit ) // object between barrel and BeamEndPoint?
-	{
-		OutBeamLocation = WeaponTraceHit.Location;
-		return true;
-	}
-	return false; 
+	FVector BeamTargetLocation;
+	TraceUnderCrossHars( CrossHairHitResult, BeamTargetLocation, EShooterQuery::ESQ_Bullet );
+	// BeamTargetLocation is the crosshair hit, or the end of the crosshair trace if nothing was hit
+
+	// Perform a second trace, this time from the gun barrel, penetrating/ricocheting as the weapon allows
+	return ShooterCombat::TraceHitscan(
+		GetWorld( ),
+		MuzzleSocketLocation,
+		BeamTargetLocation,
+		GetEquippedWeaponStats( ),
+		this,
+		OutSegments );
 }
 
 void AShooterCharacter::AimingButtonPressed( )
@@ -258,6 +375,7 @@ void AShooterCharacter::AimingButtonReleased( )
 	bAiming = false;
 }
 
+#if !UE_SERVER
 void AShooterCharacter::CameraInterpZoom( float DeltaTime )
 {
 	// Set current camera field of view
@@ -296,169 +414,160 @@ void AShooterCharacter::SetLookRates( )
 	}
 }
 
-void AShooterCharacter::CalculateCrosshairSpread( float DeltaTime )
+void AShooterCharacter::UpdateAimAssist( )
 {
-	FVector2D WalkSpeedRange { 0.f, 600.f };
-	FVector2D VelocityMultiplierRange { 0.f, 1.f };
-	FVector Velocity { GetVelocity( ) };
-	Velocity.Z = 0.f;
-
-	CrosshairVelocityFactor = FMath::GetMappedRangeValueClamped(
-		WalkSpeedRange,
-		VelocityMultiplierRange,
-	
-		Velocity.Size( ) );
-
-	// calculate crosshair in air factor
-	if ( GetCharacterMovement( )->IsFalling( ) ) // is in air?
+	AimAssistScale = 1.f;
+	if ( TargetingSubsystem == nullptr || !IsLocallyControlled( ) || !IsPlayerControlled( ) || IsDead( ) || AimAssistSlowdown >= 1.f )
 	{
-		// spread the crosshairs slowly while in air
-		CrosshairInAirFactor = FMath::FInterpTo(
-			CrosshairInAirFactor,
-			2.25f,
-			DeltaTime,
-			2.25f );
+		if ( TargetingSubsystem && AimAssistQuerier != INDEX_NONE )
+		{
+			TargetingSubsystem->RemoveQuerier( AimAssistQuerier );
+		}
+		return;
 	}
-	else // character is on the ground
+	if ( AimAssistQuerier == INDEX_NONE )
 	{
-		// shrink the crosshairs rapidly when on the ground
-		CrosshairInAirFactor = FMath::FInterpTo(
-			CrosshairInAirFactor,
-			0.f,
-			DeltaTime,
-			30.f );
+		AimAssistQuerier = TargetingSubsystem->AddQuerier( );
 	}
 
-	// Calculate crosshair aim factor
-	if ( bAiming ) // are we aiming?
+	// last frame's answer: full slowdown dead on, none at the edge of the cone
+	const FShooterTargetResult& Result = TargetingSubsystem->GetResult( AimAssistQuerier );
+	if ( Result.Target.IsValid( ) )
 	{
-		// Shrink crosshairs a small amount very quickly
-		CrosshairAimFactor = FMath::FInterpTo(
-			CrosshairAimFactor,
-			0.6f,
-			DeltaTime,
-			30.f );
-	}
-	else // not aiming
-	{
-		// spread crosshairs back to normal very quickly
-		CrosshairAimFactor = FMath::FInterpTo(
-			CrosshairAimFactor,
-			0.f,
-			DeltaTime,
-			30.f );
+		const float CosEdge { FMath::Cos( FMath::DegreesToRadians( AimAssistAngle ) ) };
+		const float OnTarget { FMath::Clamp( FMath::GetRangePct( CosEdge, 1.f, Result.CosAngle ), 0.f, 1.f ) };
+		AimAssistScale = FMath::Lerp( 1.f, AimAssistSlowdown, OnTarget );
 	}
 
-	// true 0.05 seconds after firing
-	if ( bFiringBullet )
+	// the crosshair is the middle of the view
+	FShooterTargetQuery Query;
+	Query.Origin = FollowCamera->GetComponentLocation( );
+	Query.Direction = FollowCamera->GetForwardVector( );
+	Query.MaxRange = AimAssistRange;
+	Query.HalfAngleDegrees = AimAssistAngle;
+	Query.IgnoreActor = this;
+	TargetingSubsystem->SetQuery( AimAssistQuerier, Query );
+}
+#endif
+
+void AShooterCharacter::FireButtonPressed( )
+{
+	if ( IsDead( ) )
 	{
-		CrosshairShootingFactor = FMath::FInterpTo(
-			CrosshairShootingFactor, 
-			0.3f, 
-			DeltaTime, 
-			60.f );
+		return;
 	}
-	else
+	CombatState.bFireButtonPressed = true;
+	if ( ShouldMeasureLatency( ) )
 	{
-		CrosshairShootingFactor = FMath::FInterpTo(
-			CrosshairShootingFactor,
-			0.f,
-			DeltaTime,
-			60.f );
+		InputSubsystem->MarkInput( EShooterLatencyEvent::ESLE_Fire );
 	}
-
-	CrosshairSpreadMultiplier = 
-		0.5f + 
-		CrosshairVelocityFactor + 
-		CrosshairInAirFactor -
-		CrosshairAimFactor +
-		CrosshairShootingFactor;
+	// the whole burst, first shot included, is fired from UpdateCombat's fixed steps
 }
 
-void AShooterCharacter::StartCrosshairBulletFire( )
+void AShooterCharacter::FireButtonReleased( )
 {
-	bFiringBullet = true;
-
-	GetWorldTimerManager( ).SetTimer(
-		CrosshairShootTimer,
-		this,
-		&AShooterCharacter::FinishCrosshairBulletFire,
-		ShootTimeDuration );
+	CombatState.bFireButtonPressed = false;
 }
 
-void AShooterCharacter::FinishCrosshairBulletFire( )
+void AShooterCharacter::JumpButtonPressed( )
 {
-	bFiringBullet = false;
+	bJumpButtonPressed = true;
+	Jump( );
 }
 
-void AShooterCharacter::FireButtonPressed( )
+void AShooterCharacter::JumpButtonReleased( )
 {
-	bFireButtonPressed = true;
-	StartFireTimer( );
+	bJumpButtonPressed = false;
+	StopJumping( );
 }
 
-void AShooterCharacter::FireButtonReleased( )
+void AShooterCharacter::UpdateCombat( float DeltaTime )
 {
-	bFireButtonPressed = false;
-}
+	FVector Velocity { GetVelocity( ) };
+	Velocity.Z = 0.f;
 
-void AShooterCharacter::StartFireTimer( )
-{
-	if ( bShouldFire )
-	{
-		FireWeapon( );
-		bShouldFire = false;
-		GetWorldTimerManager( ).SetTimer(
-			AutoFireTimer,
-			this,
-			&AShooterCharacter::AutoFireReset,
-			AutomaticFireRate );
-	}
-}
+	FShooterCombatInputs CombatInputs;
+	CombatInputs.HorizontalSpeed = Velocity.Size( );
+	CombatInputs.bIsInAir = GetCharacterMovement( )->IsFalling( );
+	CombatInputs.bAiming = bAiming;
 
-void AShooterCharacter::AutoFireReset( )
-{
-	bShouldFire = true;
-	if ( bFireButtonPressed )
+	// combat advances in fixed steps so spread and cadence come out the same at any frame rate
+	const int32 Steps { CombatClock.Consume( DeltaTime ) };
+	const float StepSeconds { ShooterCombat::GetStepSeconds( ) };
+	for ( int32 Step = 0; Step < Steps; Step++ )
 	{
-		StartFireTimer( );
+		ShooterCombat::AdvanceTimers( CombatState, StepSeconds );
+
+		// every shot while the button is held, so bursts line up with the steps at any frame rate
+		if ( CombatState.bFireButtonPressed && !IsDead( ) && ShooterCombat::TryFire( CombatState, GetEquippedWeaponStats( ) ) )
+		{
+			FireWeapon( );
+		}
+
+		ShooterCombat::CalculateCrosshairSpread( CombatState, CombatInputs, StepSeconds );
 	}
+
+	// the crosshair widget still reads these by their old names
+	CrosshairSpreadMultiplier = GetCrosshairSpreadMultiplier( );
+	CrosshairVelocityFactor = CombatState.CrosshairVelocityFactor;
+	CrosshairInAirFactor = CombatState.CrosshairInAirFactor;
+	CrosshairAimFactor = CombatState.CrosshairAimFactor;
+	CrosshairShootingFactor = CombatState.CrosshairShootingFactor;
 }
 
-bool AShooterCharacter::TraceUnderCrossHars( FHitResult& OutHitResult, FVector& OutHitLocation    )
+bool AShooterCharacter::TraceUnderCrossHars( FHitResult& OutHitResult, FVector& OutHitLocation, EShooterQuery Query )
 {
-	// get viewport size
-	FVector2D ViewportSize;
-	if ( GEngine && GEngine->GameViewport )
-	{
-		GEngine->GameViewport->GetViewportSize( ViewportSize );
-	}
-
-	// Get screen space location of crosshairs
-	FVector2D CrosshairLocation( ViewportSize.X / 2.f, ViewportSize.Y / 2.f );
-	//CrosshairLocation.Y -= 50.f; // don't need this line as crosshairs now in screen center and NOT 50 up
+	// without a viewport of our own, on a dedicated server or for anyone but the local player,
+	// the crosshairs are wherever the controller is looking
 	FVector CrosshairWorldPosition;
 	FVector CrosshairWorldDirection;
+	bool bScreenToWorld { false };
+
+#if !UE_SERVER
+	APlayerController* PlayerController = Cast<APlayerController>( GetController( ) );
+	if ( PlayerController && PlayerController->IsLocalPlayerController( ) )
+	{
+		// get viewport size
+		int32 ViewportSizeX { 0 };
+		int32 ViewportSizeY { 0 };
+		PlayerController->GetViewportSize( ViewportSizeX, ViewportSizeY );
+
+		// Get screen space location of crosshairs
+		FVector2D CrosshairLocation( ViewportSizeX / 2.f, ViewportSizeY / 2.f );
+		//CrosshairLocation.Y -= 50.f; // don't need this line as crosshairs now in screen center and NOT 50 up
 
-	// Get world position and direction of crosshairs
-	bool bScreenToWorld = UGameplayStatics::DeprojectScreenToWorld(
-		UGameplayStatics::GetPlayerController( this, 0 ),
-		CrosshairLocation,
-		CrosshairWorldPosition,
-		CrosshairWorldDirection );
+		// Get world position and direction of crosshairs
+		bScreenToWorld = UGameplayStatics::DeprojectScreenToWorld(
+			PlayerController,
+			CrosshairLocation,
+			CrosshairWorldPosition,
+			CrosshairWorldDirection );
+	}
+	else
+#endif
+	{
+		FRotator CrosshairWorldRotation;
+		GetActorEyesViewPoint( CrosshairWorldPosition, CrosshairWorldRotation );
+		CrosshairWorldDirection = CrosshairWorldRotation.Vector( );
+		bScreenToWorld = true;
+	}
 
 	if ( bScreenToWorld )
 	{
 		// trace from crosshair world location outward
+		const FShooterQueryPreset& Preset = ShooterCollision::GetQueryPreset( Query );
 		const FVector Start { CrosshairWorldPosition };
-		const FVector End { Start + CrosshairWorldDirection * 50'000.f };
+		const FVector End { Start + CrosshairWorldDirection * Preset.MaxDistance };
 		OutHitLocation = End;
 
+		FCollisionQueryParams QueryParams { Preset.Params };
+		QueryParams.AddIgnoredActor( this );
 		GetWorld( )->LineTraceSingleByChannel(
 			OutHitResult,
 			Start,
 			End,
-			ECollisionChannel::ECC_Visibility );
+			Preset.Channel,
+			QueryParams );
 		if ( OutHitResult.bBlockingHit )
 		{
 			OutHitLocation = OutHitResult.Location;
@@ -468,13 +577,14 @@ bool AShooterCharacter::TraceUnderCrossHars( FHitResult& OutHitResult, FVector&
 	return false;
 }
 
+#if !UE_SERVER
 void AShooterCharacter::TraceForItems( )
 {
-	if ( bShouldTraceForItems )
+	if ( CombatState.bShouldTraceForItems )
 	{
 		FHitResult ItemTraceResult;
 		FVector HiiLocation;
-		TraceUnderCrossHars( ItemTraceResult, HiiLocation );
+		TraceUnderCrossHars( ItemTraceResult, HiiLocation, EShooterQuery::ESQ_Item );
 		if ( ItemTraceResult.bBlockingHit )
 		{
 			AItem* HitItem = Cast<AItem>( ItemTraceResult.Actor );
@@ -503,6 +613,7 @@ void AShooterCharacter::TraceForItems( )
 		TraceHitItemLastFrame->GetPickupWidget( )->SetVisibility( false );
 	}
 }
+#endif
 
 AWeapon* AShooterCharacter::SpawnDefaultWeapon( )
 {
@@ -510,7 +621,9 @@ AWeapon* AShooterCharacter::SpawnDefaultWeapon( )
 	if ( DefaultWeaponClass )
 	{
 		// Spawn the Weapon
-		return GetWorld( )->SpawnActor<AWeapon>( DefaultWeaponClass );
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.Owner = this;
+		return GetWorld( )->SpawnActor<AWeapon>( DefaultWeaponClass, SpawnParams );
 	}
 
 	return nullptr;
@@ -520,25 +633,59 @@ void AShooterCharacter::EquipWeapon( AWeapon* WeaponToEquip )
 {
 	if ( WeaponToEquip )
 	{
-		// set area sphere to ignore all collision channels
-		WeaponToEquip->GetAreaSphere( )->SetCollisionResponseToAllChannels(
-			ECollisionResponse::ECR_Ignore );
-		// set CollisionBox to ignore all collision channels
-		WeaponToEquip->GetCollisionBox( )->SetCollisionResponseToAllChannels(
-			ECollisionResponse::ECR_Ignore );
-
-		// Get the Hand Socket
-		const USkeletalMeshSocket* HandSocket = GetMesh( )->GetSocketByName(
-			FName( "RightHandSocket" ) );
-		if ( HandSocket )
+		AttachWeapon( WeaponToEquip );
+
+		// a held weapon moves with its holder, so it can't stay dormant in the replication grid
+		if ( HasAuthority( ) )
 		{
-			// attach the weapon to the hand socket  RightHandSocket
-			HandSocket->AttachActor( WeaponToEquip, GetMesh( ) );
+			WeaponToEquip->SetNetDormancy( DORM_Awake );
 		}
+
 		// set equipped weapon to the newly spawned weapon
-			EquippedWeapon = WeaponToEquip;
+		EquippedWeapon = WeaponToEquip;
+	}
+}
+
+void AShooterCharacter::AttachWeapon( AWeapon* WeaponToEquip )
+{
+	// set area sphere to ignore all collision channels
+	WeaponToEquip->GetAreaSphere( )->SetCollisionResponseToAllChannels(
+		ECollisionResponse::ECR_Ignore );
+	// set CollisionBox to ignore all collision channels
+	WeaponToEquip->GetCollisionBox( )->SetCollisionResponseToAllChannels(
+		ECollisionResponse::ECR_Ignore );
 
+	// Get the Hand Socket
+	const USkeletalMeshSocket* HandSocket = GetMesh( )->GetSocketByName(
+		FName( "RightHandSocket" ) );
+	if ( HandSocket )
+	{
+		// attach the weapon to the hand socket  RightHandSocket
+		HandSocket->AttachActor( WeaponToEquip, GetMesh( ) );
 	}
+
+	// switching weapons only swaps which stats we read
+	EquippedWeaponId = WeaponToEquip->GetWeaponId( );
+}
+
+void AShooterCharacter::OnRep_EquippedWeapon( )
+{
+	if ( EquippedWeapon )
+	{
+		AttachWeapon( EquippedWeapon );
+	}
+}
+
+void AShooterCharacter::GetLifetimeReplicatedProps( TArray<FLifetimeProperty>& OutLifetimeProps ) const
+{
+	Super::GetLifetimeReplicatedProps( OutLifetimeProps );
+
+	DOREPLIFETIME( AShooterCharacter, EquippedWeapon );
+}
+
+const FWeaponStats& AShooterCharacter::GetEquippedWeaponStats( ) const
+{
+	return EquippedWeaponId == 0 ? DefaultWeaponStats : UWeaponStatsSubsystem::GetStats( this, EquippedWeaponId );
 }
 
 // Called every frame
@@ -546,14 +693,22 @@ void AShooterCharacter::Tick( float DeltaTime )
 {
 	Super::Tick( DeltaTime );
 
+	// Record the input this frame was driven by
+	UpdateInputRecording( DeltaTime );
+#if !UE_SERVER
 	// Handle interpolation for zoom when aiming
 	CameraInterpZoom( DeltaTime );
 	// Change look sensitivity based on aiming
 	SetLookRates( );
-	// Calculate crosshair spread multiplier
-	CalculateCrosshairSpread( DeltaTime );
+	// Slow gamepad look while the crosshair is on a target
+	UpdateAimAssist( );
+#endif
+	// Fire cadence, crosshair timers and crosshair spread multiplier
+	UpdateCombat( DeltaTime );
+#if !UE_SERVER
 	// Check OverlappedItemCount, then trace for items
 	TraceForItems( );
+#endif
 }
 
 // Called to bind functionality to input
@@ -562,6 +717,14 @@ void AShooterCharacter::SetupPlayerInputComponent( UInputComponent* PlayerInputC
 	Super::SetupPlayerInputComponent( PlayerInputComponent );
 	check( PlayerInputComponent );
 
+	// replayed input stands in for the live bindings; an unmapped axis still runs every frame
+	const UShooterInputSubsystem* Input = GetGameInstance( ) ? GetGameInstance( )->GetSubsystem<UShooterInputSubsystem>( ) : nullptr;
+	if ( Input && Input->IsReplaying( ) )
+	{
+		PlayerInputComponent->BindAxis( "ReplayInput", this, &AShooterCharacter::ReplayInputFrame );
+		return;
+	}
+
 	PlayerInputComponent->BindAxis( "MoveForward", this, &AShooterCharacter::MoveForward );
 	PlayerInputComponent->BindAxis( "MoveRight", this, &AShooterCharacter::MoveRight );
 	PlayerInputComponent->BindAxis( "TurnRate", this, &AShooterCharacter::TurnAtRate );
@@ -569,8 +732,8 @@ void AShooterCharacter::SetupPlayerInputComponent( UInputComponent* PlayerInputC
 	PlayerInputComponent->BindAxis( "Turn", this, &AShooterCharacter::Turn );
 	PlayerInputComponent->BindAxis( "LookUp", this, &AShooterCharacter::LookUp );
 
-	PlayerInputComponent->BindAction( "Jump", IE_Pressed, this, &ACharacter::Jump );
-	PlayerInputComponent->BindAction( "Jump", IE_Released, this, &ACharacter::StopJumping );
+	PlayerInputComponent->BindAction( "Jump", IE_Pressed, this, &AShooterCharacter::JumpButtonPressed );
+	PlayerInputComponent->BindAction( "Jump", IE_Released, this, &AShooterCharacter::JumpButtonReleased );
 
 	PlayerInputComponent->BindAction( "FireButton", IE_Pressed, this,
 		&AShooterCharacter::FireButtonPressed );
@@ -583,22 +746,206 @@ void AShooterCharacter::SetupPlayerInputComponent( UInputComponent* PlayerInputC
 		&AShooterCharacter::AimingButtonReleased );
 }
 
+void AShooterCharacter::CalcCamera( float DeltaTime, FMinimalViewInfo& OutResult )
+{
+	Super::CalcCamera( DeltaTime, OutResult );
+
+	if ( ShouldMeasureLatency( ) )
+	{
+		InputSubsystem->MarkResponse( EShooterLatencyEvent::ESLE_Look );
+	}
+}
+
+void AShooterCharacter::UpdateInputRecording( float DeltaTime )
+{
+	if ( InputSubsystem == nullptr || !InputSubsystem->IsRecording( ) || !IsLocallyControlled( ) || InputComponent == nullptr )
+	{
+		return;
+	}
+
+	FShooterInputFrame Frame;
+	Frame.DeltaTime = DeltaTime;
+	Frame.SetAxis( EShooterInputAxis::ESIA_MoveForward, InputComponent->GetAxisValue( "MoveForward" ) );
+	Frame.SetAxis( EShooterInputAxis::ESIA_MoveRight, InputComponent->GetAxisValue( "MoveRight" ) );
+	Frame.SetAxis( EShooterInputAxis::ESIA_Turn, InputComponent->GetAxisValue( "Turn" ) );
+	Frame.SetAxis( EShooterInputAxis::ESIA_LookUp, InputComponent->GetAxisValue( "LookUp" ) );
+	Frame.SetAxis( EShooterInputAxis::ESIA_TurnRate, InputComponent->GetAxisValue( "TurnRate" ) );
+	Frame.SetAxis( EShooterInputAxis::ESIA_LookUpRate, InputComponent->GetAxisValue( "LookUpRate" ) );
+	Frame.bFireButton = CombatState.bFireButtonPressed;
+	Frame.bAimingButton = bAiming;
+	Frame.bJumpButton = bJumpButtonPressed;
+	InputSubsystem->RecordFrame( Frame );
+}
+
+void AShooterCharacter::ReplayInputFrame( float Value )
+{
+	FShooterInputFrame Frame;
+	if ( InputSubsystem == nullptr || !InputSubsystem->ReadFrame( Frame ) )
+	{
+		return;
+	}
+	MoveForward( Frame.GetAxis( EShooterInputAxis::ESIA_MoveForward ) );
+	MoveRight( Frame.GetAxis( EShooterInputAxis::ESIA_MoveRight ) );
+	Turn( Frame.GetAxis( EShooterInputAxis::ESIA_Turn ) );
+	LookUp( Frame.GetAxis( EShooterInputAxis::ESIA_LookUp ) );
+	TurnAtRate( Frame.GetAxis( EShooterInputAxis::ESIA_TurnRate ) );
+	LookUpAtRate( Frame.GetAxis( EShooterInputAxis::ESIA_LookUpRate ) );
+
+	// buttons are recorded as held state; replay the edges
+	if ( Frame.bAimingButton != bAiming )
+	{
+		Frame.bAimingButton ? AimingButtonPressed( ) : AimingButtonReleased( );
+	}
+	if ( Frame.bFireButton != CombatState.bFireButtonPressed )
+	{
+		Frame.bFireButton ? FireButtonPressed( ) : FireButtonReleased( );
+	}
+	if ( Frame.bJumpButton != bJumpButtonPressed )
+	{
+		Frame.bJumpButton ? JumpButtonPressed( ) : JumpButtonReleased( );
+	}
+}
+
 float AShooterCharacter::GetCrosshairSpreadMultiplier( ) const
 {
-	return CrosshairSpreadMultiplier;
+	return ShooterCombat::GetInterpolatedSpread( CombatState, CombatClock.GetAlpha( ) );
 }
 
 void AShooterCharacter::IncrementOverlappedItemCount( int8 Amount )
 {
-	if ( OverlappedItemCount + Amount <= 0 )
+	ShooterCombat::IncrementOverlappedItemCount( CombatState, Amount );
+}
+
+void AShooterCharacter::SetSeated( bool bNewSeated )
+{
+	if ( bSeated == bNewSeated )
+	{
+		return;
+	}
+	bSeated = bNewSeated;
+
+	// nothing we do per frame matters while someone else is being driven
+	SetActorTickEnabled( !bSeated );
+	SetActorEnableCollision( !bSeated );
+	CameraBoom->SetComponentTickEnabled( !bSeated );
+	if ( EquippedWeapon )
 	{
-		OverlappedItemCount = 0;
-		bShouldTraceForItems = false;
+		EquippedWeapon->SetActorTickEnabled( !bSeated );
+	}
+
+	UCharacterMovementComponent* Movement = GetCharacterMovement( );
+	if ( bSeated )
+	{
+		Movement->StopMovementImmediately( );
+		Movement->DisableMovement( );
+		Movement->SetComponentTickEnabled( false );
+
+		// stop input that was held on the way in
+		CombatState.bFireButtonPressed = false;
+		AimingButtonReleased( );
+
+		UnseatedAnimTickOption = GetMesh( )->VisibilityBasedAnimTickOption;
+		GetMesh( )->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered;
 	}
 	else
 	{
-		OverlappedItemCount += Amount;
-		bShouldTraceForItems = true;
+		Movement->SetComponentTickEnabled( true );
+		Movement->SetMovementMode( MOVE_Walking );
+
+		GetMesh( )->VisibilityBasedAnimTickOption = UnseatedAnimTickOption;
+	}
+}
+
+AWeapon* AShooterCharacter::DropDefaultWeapon( const FVector& Location )
+{
+	if ( !HasAuthority( ) || DefaultWeaponClass == nullptr )
+	{
+		return nullptr;
 	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	return GetWorld( )->SpawnActor<AWeapon>( DefaultWeaponClass, Location, GetActorRotation( ), SpawnParams );
 }
 
+void AShooterCharacter::PickUpWeapon( AWeapon* Weapon )
+{
+	if ( !HasAuthority( ) || Weapon == nullptr || Weapon == EquippedWeapon )
+	{
+		return;
+	}
+
+	// equipping switches off the item's area sphere, which ends its overlap with us
+	AWeapon* OldWeapon = EquippedWeapon;
+	Weapon->SetOwner( this );
+	EquipWeapon( Weapon );
+	if ( OldWeapon )
+	{
+		OldWeapon->Destroy( );
+	}
+}
+
+void AShooterCharacter::ResetForRestart( const FTransform& Transform, const FRotator& ControlRotation, AWeapon* Weapon )
+{
+	SetSeated( false );
+	SetActorTransform( Transform, false, nullptr, ETeleportType::ResetPhysics );
+	GetCharacterMovement( )->StopMovementImmediately( );
+	if ( Controller )
+	{
+		Controller->SetControlRotation( ControlRotation );
+	}
+
+	// overlaps are recounted by the teleport, so keep the item interest
+	FShooterCombatState FreshState;
+	FreshState.OverlappedItemCount = CombatState.OverlappedItemCount;
+	FreshState.bShouldTraceForItems = CombatState.bShouldTraceForItems;
+	CombatState = FreshState;
+	CombatClock.Reset( );
+	Revive( );
+
+	bAiming = false;
+	CameraCurrentFOV = CameraDefaultFOV;
+	if ( FollowCamera )
+	{
+		FollowCamera->SetFieldOfView( CameraDefaultFOV );
+	}
+
+	if ( Weapon && Weapon != EquippedWeapon )
+	{
+		EquipWeapon( Weapon );
+	}
+}
+
+float AShooterCharacter::GetHealth( ) const
+{
+	return DamageSubsystem ? DamageSubsystem->GetHealth( DamageHandle ) : MaxHealth;
+}
+
+float AShooterCharacter::GetArmor( ) const
+{
+	return DamageSubsystem ? DamageSubsystem->GetArmor( DamageHandle ) : MaxArmor;
+}
+
+bool AShooterCharacter::IsDead( ) const
+{
+	return DamageSubsystem && DamageSubsystem->IsDead( DamageHandle );
+}
+
+void AShooterCharacter::Revive( )
+{
+	if ( DamageSubsystem )
+	{
+		DamageSubsystem->Revive( DamageHandle );
+	}
+}
+
+void AShooterCharacter::OnDamaged( const FShooterDamageEvent& Event )
+{
+	if ( Event.bKilled )
+	{
+		// stop shooting; what dying looks like is up to the Blueprint
+		CombatState.bFireButtonPressed = false;
+		bAiming = false;
+		ReceiveKilled( DamageSubsystem->GetOwner( Event.LastInstigator ) );
+	}
+}
@@ -4,8 +4,13 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
+#include "ShooterCombat.h"
+#include "ShooterDamageSubsystem.h"
+#include "WeaponStats.h"
 #include "ShooterCharacter.generated.h"
 
+enum class EShooterQuery : uint8;
+
 UCLASS( )
 class SHOOTER_API AShooterCharacter : public ACharacter
 {
@@ -19,6 +24,8 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay( ) override;
 
+	virtual void EndPlay( const EEndPlayReason::Type EndPlayReason ) override;
+
 	/** Called for forwards/backwards input */
 	void MoveForward( float Value );
 
@@ -52,7 +59,12 @@ protected:
 	/** Called when the Fire Button is pressed */
 	void FireWeapon( );
 
-	bool GetBeamEndLocation( const FVector& MuzzleSocketLocation, FVector& OutBeamLocation );
+	/**
+	* Trace the shot from the barrel toward whatever is under the crosshairs
+	* @param OutSegments  Segments of the shot; caller must hold an FMemMark
+	* @return true if the shot hit something
+	*/
+	bool GetBeamEndLocation( const FVector& MuzzleSocketLocation, FShotSegmentArray& OutSegments );
 
 	/** Set bAiming to true or false with button press */
 	void AimingButtonPressed( );
@@ -63,23 +75,21 @@ protected:
 	/** Set BaseTurnRate and BaseLookUpRate based on aiming */
 	void SetLookRates( );
 
-	void CalculateCrosshairSpread( float DeltaTime );
-	
-	void StartCrosshairBulletFire( );
-
-	UFUNCTION( )
-	void FinishCrosshairBulletFire( );
+	/* slow the gamepad rates while the crosshair is on a target, and aim the next frame's target query */
+	void UpdateAimAssist( );
 
 	void FireButtonPressed( );
 	void FireButtonReleased( );
 
-	void StartFireTimer( );
+	/* Jump and StopJumping, keeping the held state for input recordings */
+	void JumpButtonPressed( );
+	void JumpButtonReleased( );
 
-	UFUNCTION()
-	void AutoFireReset( );
+	/* advance the shared combat rules: fire cadence, crosshair timers and spread */
+	void UpdateCombat( float DeltaTime );
 
-	/* line trace for items under the crosshairs */
-	bool TraceUnderCrossHars( FHitResult& OutHitResult,  FVector& OutHitLocation );
+	/* line trace under the crosshairs with Query's channel and range */
+	bool TraceUnderCrossHars( FHitResult& OutHitResult, FVector& OutHitLocation, EShooterQuery Query );
 
 	/* trace for items if OverlappedItemCOunt > 0 */
 	void TraceForItems( );
@@ -87,9 +97,34 @@ protected:
 	//spawns a default weapon and equips it
 	class AWeapon* SpawnDefaultWeapon( );
 
-	/* takes a weapon and attaches it to the mesh*/
+	/* takes a weapon and attaches it to the mesh; the server's choice replicates to clients */
 	void EquipWeapon( AWeapon* WeaponToEquip );
 
+	/* attach WeaponToEquip to the hand and read its stats, on every machine */
+	void AttachWeapon( AWeapon* WeaponToEquip );
+
+	UFUNCTION( )
+	void OnRep_EquippedWeapon( );
+
+	/* stats of the equipped weapon, or the default weapon if nothing is equipped */
+	const FWeaponStats& GetEquippedWeaponStats( ) const;
+
+	/* record this frame's input */
+	void UpdateInputRecording( float DeltaTime );
+
+	/* apply the next replayed frame; bound as an axis so it runs where live input would, before the controller's rotation update */
+	void ReplayInputFrame( float Value );
+
+	/* latency is only measured for the local player's own input */
+	bool ShouldMeasureLatency( ) const { return InputSubsystem && IsLocallyControlled( ) && IsPlayerControlled( ); }
+
+	/* this frame's hits, resolved by UShooterDamageSubsystem */
+	void OnDamaged( const FShooterDamageEvent& Event );
+
+	/* Blueprint hook for death; Killer is null if nothing claimed the last hit */
+	UFUNCTION( BlueprintImplementableEvent, Category = Combat, meta = ( DisplayName = "On Killed" ) )
+	void ReceiveKilled( AActor* Killer );
+
 
 public:
 	// Called every frame
@@ -98,6 +133,10 @@ public:
 	// Called to bind functionality to input
 	virtual void SetupPlayerInputComponent( class UInputComponent* PlayerInputComponent ) override;
 
+	virtual void CalcCamera( float DeltaTime, struct FMinimalViewInfo& OutResult ) override;
+
+	virtual void GetLifetimeReplicatedProps( TArray<FLifetimeProperty>& OutLifetimeProps ) const override;
+
 private:
 	/** Camera boom positioning the camera behind the character */
 	UPROPERTY( VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = ( AllowPrivateAccess = "true" ) )
@@ -147,23 +186,23 @@ private:
 	UPROPERTY( EditDefaultsOnly, BlueprintReadOnly, Category = Camera, meta = ( AllowPrivateAccess = "true" ), meta = ( ClampMin = "0.0", ClampMax = "1.0", UIMin = "0.0", UIMax = "1.0" ) )
 	float MouseAimingLookUpRate;
 
-	/** Randomized gunshot sound cue */
+	/** Randomized gunshot sound cue, used when the equipped weapon's definition has none */
 	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Combat, meta = ( AllowPrivateAccess = "true" ) )
 	class USoundCue* FireSound;
 
-	/** Flash spawned at BarrelSocket */
+	/** Flash spawned at BarrelSocket, used when the equipped weapon's definition has none */
 	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Combat, meta = ( AllowPrivateAccess = "true" ) )
 	class UParticleSystem* MuzzleFlash;
 
-	/** Montage for firing the weapon */
+	/** Montage for firing the weapon, used when the equipped weapon's definition has none */
 	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Combat, meta = ( AllowPrivateAccess = "true" ) )
 	class UAnimMontage* HipFireMontage;
 
-	/** Particles spawned upon bullet impact */
+	/** Particles spawned upon bullet impact, used when the equipped weapon's definition has none */
 	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Combat, meta = ( AllowPrivateAccess = "true" ) )
 	UParticleSystem* ImpactParticles;
 
-	/** Smoke trail for bullets */
+	/** Smoke trail for bullets, used when the equipped weapon's definition has none */
 	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Combat, meta = ( AllowPrivateAccess = "true" ) )
 	UParticleSystem* BeamParticles;
 
@@ -184,59 +223,108 @@ private:
 	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Combat, meta = ( AllowPrivateAccess = "true" ) )
 	float ZoomInterpSpeed;
 
-	/** Determines the spread of the crosshairs */
+	/** Crosshair spread, fire cadence and item interest, shared with AShooterBotSwarm */
+	UPROPERTY( VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = ( AllowPrivateAccess = "true" ) )
+	FShooterCombatState CombatState;
+
+	/* splits frame time into the fixed combat steps that advance CombatState */
+	FShooterCombatClock CombatClock;
+
+	/** Determines the spread of the crosshairs. Copied from CombatState each frame for existing Blueprints */
 	UPROPERTY( VisibleAnywhere, BlueprintReadOnly, Category = Crosshairs, meta = ( AllowPrivateAccess = "true" ) )
 	float CrosshairSpreadMultiplier;
 
-	/** Velocity component for crosshairs spread */
+	/** Velocity component for crosshairs spread. Copied from CombatState each frame for existing Blueprints */
 	UPROPERTY( VisibleAnywhere, BlueprintReadOnly, Category = Crosshairs, meta = ( AllowPrivateAccess = "true" ) )
 	float CrosshairVelocityFactor;
 
-	/** In air component for crosshairs spread */
+	/** In air component for crosshairs spread. Copied from CombatState each frame for existing Blueprints */
 	UPROPERTY( VisibleAnywhere, BlueprintReadOnly, Category = Crosshairs, meta = ( AllowPrivateAccess = "true" ) )
 	float CrosshairInAirFactor;
 
-	/** Aim component for crosshairs spread */
+	/** Aim component for crosshairs spread. Copied from CombatState each frame for existing Blueprints */
 	UPROPERTY( VisibleAnywhere, BlueprintReadOnly, Category = Crosshairs, meta = ( AllowPrivateAccess = "true" ) )
 	float CrosshairAimFactor;
 
-	/** Shooting component for crosshairs spread */
+	/** Shooting component for crosshairs spread. Copied from CombatState each frame for existing Blueprints */
 	UPROPERTY( VisibleAnywhere, BlueprintReadOnly, Category = Crosshairs, meta = ( AllowPrivateAccess = "true" ) )
 	float CrosshairShootingFactor;
 
-	/* left mouse button or right console trigger pressed  */
-	bool bFireButtonPressed;
-
-	/* true when we can fire and false when waiting for the timer. */
-	bool bShouldFire;
-
-	/* rate of Automatic gun fire*/
-	float AutomaticFireRate;
-
-	/*  sets a timer between gunshots */
-	FTimerHandle AutoFireTimer;
-
-	/* true if we should trace every frame for items */
-	bool bShouldTraceForItems;
-
-	/* number of overlapped AItems */
-	int8 OverlappedItemCount;
-
 	/* the AItem hit last frame */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = TItems, meta = ( AllowPrivateAccess = "true" ) )
 	class AItem* TraceHitItemLastFrame;
 
-	/* currently equipped weapon */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = ( AllowPrivateAccess = "true" ) )
+	/* currently equipped weapon, spawned and chosen by the server */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, ReplicatedUsing = OnRep_EquippedWeapon, Category = Combat, meta = ( AllowPrivateAccess = "true" ) )
 	AWeapon* EquippedWeapon;
 
 	/* Set this in Blueprints for the default weapon class */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Combat, meta = ( AllowPrivateAccess = "true" ) )
 	TSubclassOf<AWeapon> DefaultWeaponClass;
 
+	/* id of the equipped weapon's stats in UWeaponStatsSubsystem */
+	uint8 EquippedWeaponId;
+
+	/* seconds between automatic gunshots, used when the equipped weapon has no definition row */
+	UPROPERTY( EditDefaultsOnly, BlueprintReadOnly, Category = Combat, meta = ( AllowPrivateAccess = "true" ) )
+	float AutomaticFireRate;
+
+	/* seconds the crosshairs stay spread after a gunshot, used when the equipped weapon has no definition row */
+	UPROPERTY( EditDefaultsOnly, BlueprintReadOnly, Category = Combat, meta = ( AllowPrivateAccess = "true" ) )
 	float ShootTimeDuration;
-	bool bFiringBullet;
-	FTimerHandle CrosshairShootTimer;
+
+	/* default weapon stats with this character's cadence, for weapon id 0 */
+	FWeaponStats DefaultWeaponStats;
+
+	/* true while sitting in a vehicle */
+	UPROPERTY( VisibleAnywhere, BlueprintReadOnly, Category = Vehicle, meta = ( AllowPrivateAccess = "true" ) )
+	bool bSeated;
+
+	/* mesh anim tick option to restore when leaving the seat */
+	EVisibilityBasedAnimTickOption UnseatedAnimTickOption;
+
+	/* input record/replay and latency markers */
+	UPROPERTY( Transient )
+	class UShooterInputSubsystem* InputSubsystem;
+
+	/* Jump is held; ACharacter's own flag clears itself once the jump runs out */
+	bool bJumpButtonPressed;
+
+	/* health the character spawns and revives with */
+	UPROPERTY( EditDefaultsOnly, BlueprintReadOnly, Category = Combat, meta = ( AllowPrivateAccess = "true", ClampMin = "1.0" ) )
+	float MaxHealth;
+
+	/* armor the character spawns and revives with */
+	UPROPERTY( EditDefaultsOnly, BlueprintReadOnly, Category = Combat, meta = ( AllowPrivateAccess = "true", ClampMin = "0.0" ) )
+	float MaxArmor;
+
+	/* health, armor and hits live in the damage subsystem */
+	UPROPERTY( Transient )
+	UShooterDamageSubsystem* DamageSubsystem;
+
+	FShooterDamageHandle DamageHandle;
+
+	/* gamepad turn and look rates are scaled down to this with the crosshair dead on a target; 1 turns aim assist off */
+	UPROPERTY( EditDefaultsOnly, BlueprintReadOnly, Category = Camera, meta = ( AllowPrivateAccess = "true", ClampMin = "0.0", ClampMax = "1.0" ) )
+	float AimAssistSlowdown;
+
+	/* targets within this many degrees of the crosshair slow the gamepad rates */
+	UPROPERTY( EditDefaultsOnly, BlueprintReadOnly, Category = Camera, meta = ( AllowPrivateAccess = "true", ClampMin = "0.0", ClampMax = "45.0" ) )
+	float AimAssistAngle;
+
+	/* and are closer than this */
+	UPROPERTY( EditDefaultsOnly, BlueprintReadOnly, Category = Camera, meta = ( AllowPrivateAccess = "true", ClampMin = "0.0" ) )
+	float AimAssistRange;
+
+	/* this frame's multiplier on the gamepad rates */
+	float AimAssistScale;
+
+	/* finds us for other players' aim assist and for bots, and runs our own aim assist query */
+	UPROPERTY( Transient )
+	class UShooterTargetingSubsystem* TargetingSubsystem;
+
+	/* our standing query in TargetingSubsystem, while locally controlled */
+	int32 AimAssistQuerier;
 
 public:
 	/** Returns CameraBoom subobject */
@@ -249,8 +337,42 @@ public:
 	UFUNCTION( BlueprintCallable )
 	float GetCrosshairSpreadMultiplier( ) const;
 
-	FORCEINLINE int8 GetOverlappedItemCount( ) const { return OverlappedItemCount; }
+	FORCEINLINE int8 GetOverlappedItemCount( ) const { return CombatState.OverlappedItemCount; }
 
 	/* adds/subtracts to/from OverlappedItemCount and updates bSHouldTraceForItems */
 	void IncrementOverlappedItemCount( int8 Amount );
+
+	/* enter or leave the reduced-cost seated state: no ticking, movement, collision or off-screen animation */
+	void SetSeated( bool bNewSeated );
+
+	FORCEINLINE bool IsSeated( ) const { return bSeated; }
+
+	FORCEINLINE AWeapon* GetEquippedWeapon( ) const { return EquippedWeapon; }
+
+	/* put the character back to a snapshot's state without re-running BeginPlay */
+	void ResetForRestart( const FTransform& Transform, const FRotator& ControlRotation, AWeapon* Weapon );
+
+	/* hold or release the trigger without going through input, for soak bots */
+	FORCEINLINE void SetTriggerHeld( bool bHeld ) { CombatState.bFireButtonPressed = bHeld; }
+
+	/* lay a fresh default weapon in the world at Location, for someone to pick up */
+	AWeapon* DropDefaultWeapon( const FVector& Location );
+
+	/* equip a weapon lying in the world and destroy the one that was held */
+	void PickUpWeapon( AWeapon* Weapon );
+
+	UFUNCTION( BlueprintPure, Category = Combat )
+	float GetHealth( ) const;
+
+	UFUNCTION( BlueprintPure, Category = Combat )
+	float GetArmor( ) const;
+
+	UFUNCTION( BlueprintPure, Category = Combat )
+	bool IsDead( ) const;
+
+	/* back to full health and armor */
+	UFUNCTION( BlueprintCallable, Category = Combat )
+	void Revive( );
+
+	FORCEINLINE const FShooterDamageHandle& GetDamageHandle( ) const { return DamageHandle; }
 };
@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterCollision.h"
+
+namespace
+{
+	FShooterQueryPreset MakeItemPreset( )
+	{
+		// pickups are only looked for while standing in an item's AreaSphere, a short way past the camera boom does
+		FShooterQueryPreset Preset { ShooterCollision::ECC_Item, 2'000.f, FCollisionQueryParams( SCENE_QUERY_STAT( ItemTrace ), false ) };
+		return Preset;
+	}
+
+	FShooterQueryPreset MakeBulletPreset( )
+	{
+		FShooterQueryPreset Preset { ShooterCollision::ECC_Bullet, 50'000.f, FCollisionQueryParams( SCENE_QUERY_STAT( BulletTrace ), false ) };
+		// penetration and ricochet read UShooterPhysicalMaterial off the hit
+		Preset.Params.bReturnPhysicalMaterial = true;
+		return Preset;
+	}
+}
+
+const FShooterQueryPreset& ShooterCollision::GetQueryPreset( EShooterQuery Query )
+{
+	static const FShooterQueryPreset Presets[] { MakeItemPreset( ), MakeBulletPreset( ) };
+	static_assert( UE_ARRAY_COUNT( Presets ) == static_cast<int32>( EShooterQuery::ESQ_MAX ), "one preset per EShooterQuery" );
+
+	check( Query < EShooterQuery::ESQ_MAX );
+	return Presets[static_cast<int32>( Query )];
+}
@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CollisionQueryParams.h"
+#include "Engine/EngineTypes.h"
+
+/* scene query types, each with its own channel and cached query params */
+enum class EShooterQuery : uint8
+{
+	ESQ_Item,		// crosshair looking for pickups
+	ESQ_Bullet,		// crosshair aim and hitscan shots
+	ESQ_MAX
+};
+
+struct FShooterQueryPreset
+{
+	ECollisionChannel Channel;
+
+	/* furthest the query looks from its start */
+	float MaxDistance;
+
+	/* shared; copy before adding ignored actors */
+	FCollisionQueryParams Params;
+};
+
+namespace ShooterCollision
+{
+	/* trace channels from [/Script/Engine.CollisionProfile] in DefaultEngine.ini */
+	constexpr ECollisionChannel ECC_Item { ECC_GameTraceChannel1 };
+	constexpr ECollisionChannel ECC_Bullet { ECC_GameTraceChannel2 };
+
+	/* item CollisionBox: answers item traces only, so bullets pass through pickups */
+	const FName ItemTraceProfile { TEXT( "ItemTrace" ) };
+
+	/* item AreaSphere: overlaps pawns, invisible to every trace */
+	const FName ItemAreaProfile { TEXT( "ItemArea" ) };
+
+	/* level meshes: blocks bullets and movement, ignores item traces */
+	const FName WorldGeometryProfile { TEXT( "WorldGeometry" ) };
+
+	SHOOTER_API const FShooterQueryPreset& GetQueryPreset( EShooterQuery Query );
+}
@@ -0,0 +1,196 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterCombat.h"
+#include "WeaponStats.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<float> CVarCombatTickRate(
+	TEXT( "shooter.Combat.TickRate" ),
+	60.f,
+	TEXT( "Combat steps per second; spread, fire cadence and shoot timers only advance in whole steps" ) );
+
+static TAutoConsoleVariable<int32> CVarCombatMaxSubsteps(
+	TEXT( "shooter.Combat.MaxSubsteps" ),
+	4,
+	TEXT( "Most combat steps a shooter runs in one frame; longer frames drop the extra time" ) );
+
+namespace
+{
+	/* degrees of shot deflection per unit of crosshair spread */
+	constexpr float SpreadDegreesPerUnit = 1.5f;
+}
+
+int32 FShooterCombatClock::Consume( float DeltaTime )
+{
+	const float StepSeconds { ShooterCombat::GetStepSeconds( ) };
+	Accumulator += DeltaTime;
+
+	int32 Steps { FMath::FloorToInt( Accumulator / StepSeconds ) };
+	const int32 MaxSteps { FMath::Max( CVarCombatMaxSubsteps.GetValueOnGameThread( ), 1 ) };
+	if ( Steps > MaxSteps )
+	{
+		// a hitch: catch up what we can afford and let the rest go, which bounds the cost per shooter
+		Steps = MaxSteps;
+		Accumulator = FMath::Fmod( Accumulator, StepSeconds );
+	}
+	else
+	{
+		Accumulator -= Steps * StepSeconds;
+	}
+	return Steps;
+}
+
+float FShooterCombatClock::GetAlpha( ) const
+{
+	return FMath::Clamp( Accumulator / ShooterCombat::GetStepSeconds( ), 0.f, 1.f );
+}
+
+float ShooterCombat::GetStepSeconds( )
+{
+	return 1.f / FMath::Clamp( CVarCombatTickRate.GetValueOnGameThread( ), 10.f, 240.f );
+}
+
+void ShooterCombat::AdvanceTimers( FShooterCombatState& State, float DeltaTime )
+{
+	// keep up to one step of overshoot when a shot's cooldown runs out with the trigger held, so the
+	// cadence doesn't drift with the step length; from rest the cooldown stays at 0, so the first gap is whole
+	const bool bCoolingDown { State.FireCooldown > 0.f };
+	State.FireCooldown = FMath::Max(
+		State.FireCooldown - DeltaTime,
+		State.bFireButtonPressed && bCoolingDown ? -DeltaTime : 0.f );
+	State.ShootTimeRemaining = FMath::Max( State.ShootTimeRemaining - DeltaTime, 0.f );
+}
+
+void ShooterCombat::CalculateCrosshairSpread( FShooterCombatState& State, const FShooterCombatInputs& Inputs, float DeltaTime )
+{
+	State.PreviousCrosshairSpreadMultiplier = State.CrosshairSpreadMultiplier;
+
+	FVector2D WalkSpeedRange { 0.f, 600.f };
+	FVector2D VelocityMultiplierRange { 0.f, 1.f };
+
+	State.CrosshairVelocityFactor = FMath::GetMappedRangeValueClamped(
+		WalkSpeedRange,
+		VelocityMultiplierRange,
+		Inputs.HorizontalSpeed );
+
+	// calculate crosshair in air factor
+	if ( Inputs.bIsInAir ) // is in air?
+	{
+		// spread the crosshairs slowly while in air
+		State.CrosshairInAirFactor = FMath::FInterpTo(
+			State.CrosshairInAirFactor,
+			2.25f,
+			DeltaTime,
+			2.25f );
+	}
+	else // character is on the ground
+	{
+		// shrink the crosshairs rapidly when on the ground
+		State.CrosshairInAirFactor = FMath::FInterpTo(
+			State.CrosshairInAirFactor,
+			0.f,
+			DeltaTime,
+			30.f );
+	}
+
+	// Calculate crosshair aim factor
+	if ( Inputs.bAiming ) // are we aiming?
+	{
+		// Shrink crosshairs a small amount very quickly
+		State.CrosshairAimFactor = FMath::FInterpTo(
+			State.CrosshairAimFactor,
+			0.6f,
+			DeltaTime,
+			30.f );
+	}
+	else // not aiming
+	{
+		// spread crosshairs back to normal very quickly
+		State.CrosshairAimFactor = FMath::FInterpTo(
+			State.CrosshairAimFactor,
+			0.f,
+			DeltaTime,
+			30.f );
+	}
+
+	// true ShootTimeDuration seconds after firing
+	if ( State.IsFiringBullet( ) )
+	{
+		State.CrosshairShootingFactor = FMath::FInterpTo(
+			State.CrosshairShootingFactor,
+			0.3f,
+			DeltaTime,
+			60.f );
+	}
+	else
+	{
+		State.CrosshairShootingFactor = FMath::FInterpTo(
+			State.CrosshairShootingFactor,
+			0.f,
+			DeltaTime,
+			60.f );
+	}
+
+	State.CrosshairSpreadMultiplier =
+		0.5f +
+		State.CrosshairVelocityFactor +
+		State.CrosshairInAirFactor -
+		State.CrosshairAimFactor +
+		State.CrosshairShootingFactor;
+}
+
+float ShooterCombat::GetInterpolatedSpread( const FShooterCombatState& State, float Alpha )
+{
+	return FMath::Lerp( State.PreviousCrosshairSpreadMultiplier, State.CrosshairSpreadMultiplier, Alpha );
+}
+
+bool ShooterCombat::TryFire( FShooterCombatState& State, const FWeaponStats& WeaponStats )
+{
+	if ( State.FireCooldown > 0.f )
+	{
+		return false;
+	}
+	State.FireCooldown += WeaponStats.AutomaticFireRate;
+	State.ShootTimeRemaining = WeaponStats.ShootTimeDuration;
+	return true;
+}
+
+void ShooterCombat::IncrementOverlappedItemCount( FShooterCombatState& State, int8 Amount )
+{
+	if ( State.OverlappedItemCount + Amount <= 0 )
+	{
+		State.OverlappedItemCount = 0;
+		State.bShouldTraceForItems = false;
+	}
+	else
+	{
+		State.OverlappedItemCount += Amount;
+		State.bShouldTraceForItems = true;
+	}
+}
+
+FVector ShooterCombat::ApplySpread( const FShooterCombatState& State, const FVector& AimDirection, FRandomStream& RandomStream )
+{
+	const float HalfAngle { FMath::DegreesToRadians( FMath::Max( State.CrosshairSpreadMultiplier, 0.f ) * SpreadDegreesPerUnit ) };
+	return RandomStream.VRandCone( AimDirection, HalfAngle );
+}
+
+bool ShooterCombat::TraceHitscan(
+	const UWorld* World,
+	const FVector& Muzzle,
+	const FVector& Target,
+	const FWeaponStats& WeaponStats,
+	const AActor* Shooter,
+	FShotSegmentArray& OutSegments )
+{
+	FShotHitArray ShotHits;
+	return ShotTrace::TraceShot(
+		World,
+		Muzzle,
+		Target - Muzzle,
+		WeaponStats.TraceBudget,
+		Shooter,
+		OutSegments,
+		ShotHits );
+}
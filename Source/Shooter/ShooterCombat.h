@@ -0,0 +1,127 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ShotTrace.h"
+#include "ShooterCombat.generated.h"
+
+struct FWeaponStats;
+
+/**
+ * Everything the combat logic needs to remember about one shooter.
+ * Plain data so it can live on an AShooterCharacter or in a flat array of bots.
+ */
+USTRUCT( BlueprintType )
+struct FShooterCombatState
+{
+	GENERATED_BODY( )
+
+	/** Determines the spread of the crosshairs */
+	UPROPERTY( VisibleAnywhere, BlueprintReadOnly, Category = Crosshairs )
+	float CrosshairSpreadMultiplier = 0.f;
+
+	/** Velocity component for crosshairs spread */
+	UPROPERTY( VisibleAnywhere, BlueprintReadOnly, Category = Crosshairs )
+	float CrosshairVelocityFactor = 0.f;
+
+	/** In air component for crosshairs spread */
+	UPROPERTY( VisibleAnywhere, BlueprintReadOnly, Category = Crosshairs )
+	float CrosshairInAirFactor = 0.f;
+
+	/** Aim component for crosshairs spread */
+	UPROPERTY( VisibleAnywhere, BlueprintReadOnly, Category = Crosshairs )
+	float CrosshairAimFactor = 0.f;
+
+	/** Shooting component for crosshairs spread */
+	UPROPERTY( VisibleAnywhere, BlueprintReadOnly, Category = Crosshairs )
+	float CrosshairShootingFactor = 0.f;
+
+	/* left mouse button or right console trigger pressed  */
+	bool bFireButtonPressed = false;
+
+	/* CrosshairSpreadMultiplier before the last combat step, for interpolating between steps */
+	float PreviousCrosshairSpreadMultiplier = 0.f;
+
+	/* seconds until the weapon may fire again */
+	float FireCooldown = 0.f;
+
+	/* seconds the crosshairs stay spread from the last shot */
+	float ShootTimeRemaining = 0.f;
+
+	/* number of overlapped AItems */
+	int8 OverlappedItemCount = 0;
+
+	/* true if we should trace every frame for items */
+	bool bShouldTraceForItems = false;
+
+	FORCEINLINE bool IsFiringBullet( ) const { return ShootTimeRemaining > 0.f; }
+};
+
+/* what the combat logic reads from the shooter's movement each update */
+struct FShooterCombatInputs
+{
+	/* speed in the horizontal plane */
+	float HorizontalSpeed;
+	bool bIsInAir;
+	bool bAiming;
+};
+
+/**
+ * Turns variable frame times into a whole number of fixed-length combat steps, so combat state
+ * only depends on the inputs at each step and not on the frame rate.
+ * Time that doesn't make a full step carries over and is the interpolation alpha for drawing.
+ */
+struct SHOOTER_API FShooterCombatClock
+{
+	/* add a frame's time and return the steps to run; time past shooter.Combat.MaxSubsteps steps is dropped */
+	int32 Consume( float DeltaTime );
+
+	/* how far the frame is between the last step and the next, 0..1 */
+	float GetAlpha( ) const;
+
+	void Reset( ) { Accumulator = 0.f; }
+
+private:
+	float Accumulator = 0.f;
+};
+
+/**
+ * Combat rules shared by AShooterCharacter and AShooterBotSwarm
+ */
+namespace ShooterCombat
+{
+	/* length of one combat step, from shooter.Combat.TickRate */
+	SHOOTER_API float GetStepSeconds( );
+
+	/* advance the fire cadence and crosshair shoot timers */
+	SHOOTER_API void AdvanceTimers( FShooterCombatState& State, float DeltaTime );
+
+	/* interpolate the crosshair spread factors toward their targets */
+	SHOOTER_API void CalculateCrosshairSpread( FShooterCombatState& State, const FShooterCombatInputs& Inputs, float DeltaTime );
+
+	/* crosshair spread to draw, Alpha of the way from the previous step to the last one */
+	SHOOTER_API float GetInterpolatedSpread( const FShooterCombatState& State, float Alpha );
+
+	/* if the weapon is ready, start its cooldown and shoot timer and return true */
+	SHOOTER_API bool TryFire( FShooterCombatState& State, const FWeaponStats& WeaponStats );
+
+	/* adds/subtracts to/from OverlappedItemCount and updates bShouldTraceForItems */
+	SHOOTER_API void IncrementOverlappedItemCount( FShooterCombatState& State, int8 Amount );
+
+	/* deflect AimDirection randomly inside the cone given by the current spread */
+	SHOOTER_API FVector ApplySpread( const FShooterCombatState& State, const FVector& AimDirection, FRandomStream& RandomStream );
+
+	/**
+	* Hitscan a shot from Muzzle toward Target with the weapon's trace budget
+	* @param OutSegments  Segments of the shot; caller must hold an FMemMark
+	* @return true if the shot hit something
+	*/
+	SHOOTER_API bool TraceHitscan(
+		const UWorld* World,
+		const FVector& Muzzle,
+		const FVector& Target,
+		const FWeaponStats& WeaponStats,
+		const AActor* Shooter,
+		FShotSegmentArray& OutSegments );
+}
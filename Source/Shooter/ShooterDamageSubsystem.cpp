@@ -0,0 +1,203 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterDamageSubsystem.h"
+#include "HAL/IConsoleManager.h"
+#include "ShooterStats.h"
+
+DECLARE_CYCLE_STAT( TEXT( "Resolve Damage" ), STAT_ResolveDamage, STATGROUP_Shooter );
+DECLARE_DWORD_COUNTER_STAT( TEXT( "Damage Hits" ), STAT_DamageHits, STATGROUP_Shooter );
+DECLARE_DWORD_COUNTER_STAT( TEXT( "Damage Victims" ), STAT_DamageVictims, STATGROUP_Shooter );
+DECLARE_DWORD_ACCUMULATOR_STAT( TEXT( "Damageables" ), STAT_Damageables, STATGROUP_Shooter );
+
+static TAutoConsoleVariable<float> CVarDamageArmorAbsorb(
+	TEXT( "shooter.Damage.ArmorAbsorb" ),
+	0.5f,
+	TEXT( "Fraction of each hit taken by armor while any is left" ) );
+
+void UShooterDamageSubsystem::Deinitialize( )
+{
+	DEC_DWORD_STAT_BY( STAT_Damageables, Generations.Num( ) - FreeSlots.Num( ) );
+
+	Super::Deinitialize( );
+}
+
+FShooterDamageHandle UShooterDamageSubsystem::Register( AActor* Owner, float InMaxHealth, float InMaxArmor )
+{
+	FShooterDamageHandle Handle;
+	if ( FreeSlots.Num( ) > 0 )
+	{
+		Handle.Index = FreeSlots.Pop( false );
+	}
+	else
+	{
+		Handle.Index = Generations.Add( 0 );
+		Health.AddUninitialized( );
+		MaxHealth.AddUninitialized( );
+		Armor.AddUninitialized( );
+		MaxArmor.AddUninitialized( );
+		LastInstigators.AddDefaulted( );
+		Owners.AddDefaulted( );
+		FrameDamage.Add( 0.f );
+		FrameHits.Add( 0 );
+	}
+	Handle.Generation = Generations[Handle.Index];
+
+	const int32 Index { Handle.Index };
+	MaxHealth[Index] = FMath::Max( InMaxHealth, 1.f );
+	MaxArmor[Index] = FMath::Max( InMaxArmor, 0.f );
+	Health[Index] = MaxHealth[Index];
+	Armor[Index] = MaxArmor[Index];
+	LastInstigators[Index].Reset( );
+	Owners[Index] = Owner;
+
+	if ( Owner && !ActorHandles.Contains( Owner ) )
+	{
+		ActorHandles.Add( Owner, Handle );
+	}
+
+	INC_DWORD_STAT( STAT_Damageables );
+	return Handle;
+}
+
+void UShooterDamageSubsystem::Unregister( FShooterDamageHandle& Handle )
+{
+	if ( !IsValid( Handle ) )
+	{
+		Handle.Reset( );
+		return;
+	}
+
+	const int32 Index { Handle.Index };
+	const AActor* Owner = Owners[Index].Get( );
+	if ( const FShooterDamageHandle* ActorHandle = ActorHandles.Find( Owner ) )
+	{
+		if ( *ActorHandle == Handle )
+		{
+			ActorHandles.Remove( Owner );
+		}
+	}
+	Listeners.Remove( Index );
+	Owners[Index].Reset( );
+
+	// bumping the generation makes this handle, and any hits queued with it, stale
+	Generations[Index]++;
+	FreeSlots.Add( Index );
+	Handle.Reset( );
+
+	DEC_DWORD_STAT( STAT_Damageables );
+}
+
+void UShooterDamageSubsystem::SetOnDamaged( const FShooterDamageHandle& Handle, FOnShooterDamaged Delegate )
+{
+	if ( IsValid( Handle ) )
+	{
+		Listeners.Add( Handle.Index, MoveTemp( Delegate ) );
+	}
+}
+
+FShooterDamageHandle UShooterDamageSubsystem::FindHandle( const AActor* Actor ) const
+{
+	const FShooterDamageHandle* Handle = ActorHandles.Find( Actor );
+	return Handle ? *Handle : FShooterDamageHandle( );
+}
+
+void UShooterDamageSubsystem::Revive( const FShooterDamageHandle& Handle )
+{
+	if ( IsValid( Handle ) )
+	{
+		Health[Handle.Index] = MaxHealth[Handle.Index];
+		Armor[Handle.Index] = MaxArmor[Handle.Index];
+		LastInstigators[Handle.Index].Reset( );
+	}
+}
+
+AActor* UShooterDamageSubsystem::GetOwner( const FShooterDamageHandle& Handle ) const
+{
+	return IsValid( Handle ) ? Owners[Handle.Index].Get( ) : nullptr;
+}
+
+bool UShooterDamageSubsystem::IsTickable( ) const
+{
+	const UWorld* World = GetWorld( );
+	return !IsTemplate( ) && World && World->IsGameWorld( );
+}
+
+TStatId UShooterDamageSubsystem::GetStatId( ) const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT( UShooterDamageSubsystem, STATGROUP_Tickables );
+}
+
+void UShooterDamageSubsystem::Tick( float DeltaTime )
+{
+	// tickable objects run after every tick group, so this frame's shots are all queued by now
+	if ( PendingHits.Num( ) > 0 )
+	{
+		ResolveHits( );
+	}
+}
+
+void UShooterDamageSubsystem::ResolveHits( )
+{
+	SCOPE_CYCLE_COUNTER( STAT_ResolveDamage );
+
+	// first pass: sum each victim's hits in place, noting victims in the order they were first hit
+	FrameVictims.Reset( );
+	for ( const FPendingHit& Hit : PendingHits )
+	{
+		if ( !IsValid( Hit.Victim ) )
+		{
+			continue;
+		}
+
+		const int32 Index { Hit.Victim.Index };
+		if ( FrameHits[Index] == 0 )
+		{
+			FrameVictims.Add( Index );
+		}
+		FrameHits[Index]++;
+		FrameDamage[Index] += Hit.Damage;
+		LastInstigators[Index] = Hit.Instigator;
+	}
+
+	SET_DWORD_STAT( STAT_DamageHits, PendingHits.Num( ) );
+	SET_DWORD_STAT( STAT_DamageVictims, FrameVictims.Num( ) );
+	PendingHits.Reset( );
+
+	// second pass: apply each victim's total once
+	const float ArmorAbsorb { FMath::Clamp( CVarDamageArmorAbsorb.GetValueOnGameThread( ), 0.f, 1.f ) };
+	Events.Reset( );
+	for ( const int32 Index : FrameVictims )
+	{
+		const float Damage { FrameDamage[Index] };
+		const float ArmorDamage { FMath::Min( Armor[Index], Damage * ArmorAbsorb ) };
+		const float HealthBefore { Health[Index] };
+
+		Armor[Index] -= ArmorDamage;
+		Health[Index] = FMath::Max( HealthBefore - ( Damage - ArmorDamage ), 0.f );
+
+		FShooterDamageEvent& Event = Events.AddDefaulted_GetRef( );
+		Event.Victim = { Index, Generations[Index] };
+		Event.LastInstigator = LastInstigators[Index];
+		Event.HealthDamage = HealthBefore - Health[Index];
+		Event.ArmorDamage = ArmorDamage;
+		Event.NumHits = FrameHits[Index];
+		Event.bKilled = HealthBefore > 0.f && Health[Index] <= 0.f;
+
+		FrameDamage[Index] = 0.f;
+		FrameHits[Index] = 0;
+	}
+
+	// listeners may register, unregister or queue hits for next frame, so events are fired after all state is settled
+	for ( const FShooterDamageEvent& Event : Events )
+	{
+		const FOnShooterDamaged* Listener = IsValid( Event.Victim ) ? Listeners.Find( Event.Victim.Index ) : nullptr;
+		if ( Listener )
+		{
+			// copied, the listener may change Listeners
+			const FOnShooterDamaged Delegate { *Listener };
+			Delegate.ExecuteIfBound( Event );
+		}
+	}
+	OnDamageResolved.Broadcast( Events );
+}
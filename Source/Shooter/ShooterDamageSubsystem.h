@@ -0,0 +1,134 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ShooterDamageSubsystem.generated.h"
+
+/* refers to one damageable in UShooterDamageSubsystem; goes stale once it is unregistered */
+struct FShooterDamageHandle
+{
+	int32 Index { INDEX_NONE };
+	uint32 Generation { 0 };
+
+	FORCEINLINE bool IsSet( ) const { return Index != INDEX_NONE; }
+	FORCEINLINE void Reset( ) { Index = INDEX_NONE; Generation = 0; }
+
+	FORCEINLINE bool operator==( const FShooterDamageHandle& Other ) const { return Index == Other.Index && Generation == Other.Generation; }
+	FORCEINLINE bool operator!=( const FShooterDamageHandle& Other ) const { return !( *this == Other ); }
+};
+
+/* everything that hit one victim in a frame, resolved together */
+struct FShooterDamageEvent
+{
+	FShooterDamageHandle Victim;
+	/* whoever landed the frame's last hit; unset for damage without an instigator */
+	FShooterDamageHandle LastInstigator;
+	float HealthDamage;
+	float ArmorDamage;
+	int32 NumHits;
+	/* health reached zero this frame */
+	bool bKilled;
+};
+
+DECLARE_MULTICAST_DELEGATE_OneParam( FOnShooterDamageResolved, TArrayView<const FShooterDamageEvent> );
+DECLARE_DELEGATE_OneParam( FOnShooterDamaged, const FShooterDamageEvent& );
+
+/**
+ * Health and armor for everything that can be shot.
+ * Per-damageable state lives in flat arrays indexed by handle. Hits are queued as they land and
+ * resolved in one batch after every actor has ticked, giving each victim at most one event a frame.
+ */
+UCLASS()
+class SHOOTER_API UShooterDamageSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize( ) override;
+
+	/* add a damageable at full health; the first one an actor registers is the one FindHandle returns */
+	FShooterDamageHandle Register( AActor* Owner, float MaxHealth, float MaxArmor );
+
+	/* remove Handle's damageable, drop its queued hits and reset Handle */
+	void Unregister( FShooterDamageHandle& Handle );
+
+	/* called with Handle's event on frames it is hit; unbound when Handle is unregistered */
+	void SetOnDamaged( const FShooterDamageHandle& Handle, FOnShooterDamaged Delegate );
+
+	/* Actor's damageable, or an unset handle */
+	FShooterDamageHandle FindHandle( const AActor* Actor ) const;
+
+	/* queue Damage against Victim for this frame's batch; stale handles are ignored when resolving */
+	FORCEINLINE void ApplyHit( const FShooterDamageHandle& Victim, const FShooterDamageHandle& Instigator, float Damage )
+	{
+		if ( Victim.IsSet( ) && Damage > 0.f )
+		{
+			PendingHits.Add( { Victim, Instigator, Damage } );
+		}
+	}
+
+	/* back to full health and armor */
+	void Revive( const FShooterDamageHandle& Handle );
+
+	FORCEINLINE bool IsValid( const FShooterDamageHandle& Handle ) const
+	{
+		return Generations.IsValidIndex( Handle.Index ) && Generations[Handle.Index] == Handle.Generation;
+	}
+
+	FORCEINLINE float GetHealth( const FShooterDamageHandle& Handle ) const { return IsValid( Handle ) ? Health[Handle.Index] : 0.f; }
+	FORCEINLINE float GetArmor( const FShooterDamageHandle& Handle ) const { return IsValid( Handle ) ? Armor[Handle.Index] : 0.f; }
+	FORCEINLINE bool IsDead( const FShooterDamageHandle& Handle ) const { return IsValid( Handle ) && Health[Handle.Index] <= 0.f; }
+	FORCEINLINE FShooterDamageHandle GetLastInstigator( const FShooterDamageHandle& Handle ) const { return IsValid( Handle ) ? LastInstigators[Handle.Index] : FShooterDamageHandle( ); }
+
+	AActor* GetOwner( const FShooterDamageHandle& Handle ) const;
+
+	/* every victim's event, once a frame after the batch is resolved */
+	FOnShooterDamageResolved OnDamageResolved;
+
+	// FTickableGameObject
+	virtual void Tick( float DeltaTime ) override;
+	virtual bool IsTickable( ) const override;
+	virtual TStatId GetStatId( ) const override;
+	virtual UWorld* GetTickableGameObjectWorld( ) const override { return GetWorld( ); }
+
+private:
+	struct FPendingHit
+	{
+		FShooterDamageHandle Victim;
+		FShooterDamageHandle Instigator;
+		float Damage;
+	};
+
+	/* sum the queued hits per victim, then apply each victim's total once */
+	void ResolveHits( );
+
+	/* per-damageable state, all indexed by handle */
+	TArray<uint32> Generations;
+	TArray<float> Health;
+	TArray<float> MaxHealth;
+	TArray<float> Armor;
+	TArray<float> MaxArmor;
+	TArray<FShooterDamageHandle> LastInstigators;
+	TArray<TWeakObjectPtr<AActor>> Owners;
+
+	/* per-damageable sums for the batch being resolved; zero outside ResolveHits */
+	TArray<float> FrameDamage;
+	TArray<int32> FrameHits;
+
+	/* unregistered slots, reused by Register */
+	TArray<int32> FreeSlots;
+
+	TArray<FPendingHit> PendingHits;
+
+	/* scratch for ResolveHits, kept to avoid reallocating every frame */
+	TArray<int32> FrameVictims;
+	TArray<FShooterDamageEvent> Events;
+
+	/* only the few damageables that want their own event are in here */
+	TMap<int32, FOnShooterDamaged> Listeners;
+
+	TMap<const AActor*, FShooterDamageHandle> ActorHandles;
+};
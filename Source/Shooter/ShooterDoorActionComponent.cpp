@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterDoorActionComponent.h"
+#include "Components/SceneComponent.h"
+
+UShooterDoorActionComponent::UShooterDoorActionComponent( ) :
+	OpenRotation( 0.f, 90.f, 0.f ),
+	OpenOffset( FVector::ZeroVector ),
+	DoorComponent( nullptr ),
+	ClosedLocation( FVector::ZeroVector ),
+	ClosedRotation( FRotator::ZeroRotator )
+{
+}
+
+void UShooterDoorActionComponent::BeginPlay( )
+{
+	DoorComponent = FindOwnerComponent<USceneComponent>( DoorComponentName );
+	if ( DoorComponent )
+	{
+		ClosedLocation = DoorComponent->GetRelativeLocation( );
+		ClosedRotation = DoorComponent->GetRelativeRotation( );
+	}
+
+	// applies the starting alpha, so the closed pose has to be cached first
+	Super::BeginPlay( );
+}
+
+void UShooterDoorActionComponent::ApplyActionAlpha( float Alpha )
+{
+	if ( DoorComponent )
+	{
+		DoorComponent->SetRelativeLocationAndRotation(
+			ClosedLocation + OpenOffset * Alpha,
+			ClosedRotation + OpenRotation * Alpha );
+	}
+
+	Super::ApplyActionAlpha( Alpha );
+}
@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ShooterActionComponent.h"
+#include "ShooterDoorActionComponent.generated.h"
+
+/**
+ * Swings and/or slides one of the owner's components between closed and open.
+ */
+UCLASS( Blueprintable, ClassGroup = ( Custom ), meta = ( BlueprintSpawnableComponent ) )
+class SHOOTER_API UShooterDoorActionComponent : public UShooterActionComponent
+{
+	GENERATED_BODY()
+
+public:
+	UShooterDoorActionComponent( );
+
+	UFUNCTION( BlueprintCallable, Category = Door )
+	void Open( ) { PlayForward( ); }
+
+	UFUNCTION( BlueprintCallable, Category = Door )
+	void Close( ) { PlayReverse( ); }
+
+protected:
+	virtual void BeginPlay( ) override;
+	virtual void ApplyActionAlpha( float Alpha ) override;
+
+private:
+	/* owner component to move; leave empty to move the root */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Door, meta = ( AllowPrivateAccess = "true" ) )
+	FName DoorComponentName;
+
+	/* relative rotation added when fully open */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Door, meta = ( AllowPrivateAccess = "true" ) )
+	FRotator OpenRotation;
+
+	/* relative offset added when fully open */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Door, meta = ( AllowPrivateAccess = "true" ) )
+	FVector OpenOffset;
+
+	UPROPERTY( Transient )
+	USceneComponent* DoorComponent;
+
+	FVector ClosedLocation;
+	FRotator ClosedRotation;
+};
@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterElevatorComponent.h"
+#include "Components/SceneComponent.h"
+
+UShooterElevatorComponent::UShooterElevatorComponent( ) :
+	Speed( 200.f ),
+	CurrentFloor( 0 ),
+	CarComponent( nullptr ),
+	BaseLocation( FVector::ZeroVector ),
+	TripStart( FVector::ZeroVector ),
+	TripEnd( FVector::ZeroVector ),
+	TargetFloor( 0 )
+{
+}
+
+void UShooterElevatorComponent::BeginPlay( )
+{
+	CarComponent = FindOwnerComponent<USceneComponent>( CarComponentName );
+	if ( CarComponent )
+	{
+		BaseLocation = CarComponent->GetRelativeLocation( );
+	}
+	const FVector FloorOffset { Floors.IsValidIndex( CurrentFloor ) ? Floors[CurrentFloor] : FVector::ZeroVector };
+	TripStart = BaseLocation + FloorOffset;
+	TripEnd = TripStart;
+	TargetFloor = CurrentFloor;
+
+	// trips always run forwards from TripStart to TripEnd
+	bStartAtEnd = false;
+	Super::BeginPlay( );
+}
+
+void UShooterElevatorComponent::MoveToFloor( int32 FloorIndex )
+{
+	if ( !Floors.IsValidIndex( FloorIndex ) || CarComponent == nullptr )
+	{
+		return;
+	}
+	TripStart = CarComponent->GetRelativeLocation( );
+	TripEnd = BaseLocation + Floors[FloorIndex];
+	TargetFloor = FloorIndex;
+	Duration = FVector::Dist( TripStart, TripEnd ) / FMath::Max( Speed, 1.f );
+
+	// restart from the car's current position, even if it was mid-trip
+	SetActionAlpha( 0.f );
+	PlayForward( );
+}
+
+void UShooterElevatorComponent::MoveToNextFloor( )
+{
+	if ( Floors.Num( ) > 0 )
+	{
+		MoveToFloor( ( TargetFloor + 1 ) % Floors.Num( ) );
+	}
+}
+
+void UShooterElevatorComponent::WriteSnapshot( FShooterActionSnapshot& OutSnapshot ) const
+{
+	Super::WriteSnapshot( OutSnapshot );
+	OutSnapshot.State = CurrentFloor;
+}
+
+void UShooterElevatorComponent::ReadSnapshot( const FShooterActionSnapshot& Snapshot )
+{
+	// a trip in progress restarts parked at the floor it left from
+	if ( !Floors.IsValidIndex( Snapshot.State ) )
+	{
+		return;
+	}
+	CurrentFloor = Snapshot.State;
+	TargetFloor = Snapshot.State;
+	TripStart = BaseLocation + Floors[Snapshot.State];
+	TripEnd = TripStart;
+	SetActionAlpha( 0.f );
+}
+
+void UShooterElevatorComponent::ApplyActionAlpha( float Alpha )
+{
+	if ( CarComponent )
+	{
+		CarComponent->SetRelativeLocation( FMath::Lerp( TripStart, TripEnd, Alpha ) );
+	}
+
+	Super::ApplyActionAlpha( Alpha );
+}
+
+void UShooterElevatorComponent::OnTransitionFinished( bool bForward )
+{
+	CurrentFloor = TargetFloor;
+}
@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ShooterActionComponent.h"
+#include "ShooterElevatorComponent.generated.h"
+
+/**
+ * Carries one of the owner's components between floors. Each trip is its own transition,
+ * timed from the distance travelled and Speed.
+ */
+UCLASS( Blueprintable, ClassGroup = ( Custom ), meta = ( BlueprintSpawnableComponent ) )
+class SHOOTER_API UShooterElevatorComponent : public UShooterActionComponent
+{
+	GENERATED_BODY()
+
+public:
+	UShooterElevatorComponent( );
+
+	/* travel to Floors[FloorIndex] */
+	UFUNCTION( BlueprintCallable, Category = Elevator )
+	void MoveToFloor( int32 FloorIndex );
+
+	/* travel to the next floor, wrapping to the first */
+	UFUNCTION( BlueprintCallable, Category = Elevator )
+	void MoveToNextFloor( );
+
+	virtual void WriteSnapshot( FShooterActionSnapshot& OutSnapshot ) const override;
+	virtual void ReadSnapshot( const FShooterActionSnapshot& Snapshot ) override;
+
+protected:
+	virtual void BeginPlay( ) override;
+	virtual void ApplyActionAlpha( float Alpha ) override;
+	virtual void OnTransitionFinished( bool bForward ) override;
+
+private:
+	/* owner component to carry; leave empty to move the root */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Elevator, meta = ( AllowPrivateAccess = "true" ) )
+	FName CarComponentName;
+
+	/* floor offsets relative to the car's starting location; the car starts at floor 0 */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Elevator, meta = ( AllowPrivateAccess = "true" ) )
+	TArray<FVector> Floors;
+
+	/* cm/s; each trip's duration is derived from this */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Elevator, meta = ( AllowPrivateAccess = "true", ClampMin = "1.0" ) )
+	float Speed;
+
+	UPROPERTY( VisibleInstanceOnly, BlueprintReadOnly, Category = Elevator, meta = ( AllowPrivateAccess = "true" ) )
+	int32 CurrentFloor;
+
+	UPROPERTY( Transient )
+	USceneComponent* CarComponent;
+
+	FVector BaseLocation;
+	FVector TripStart;
+	FVector TripEnd;
+	int32 TargetFloor;
+};
@@ -2,4 +2,52 @@
 
 
 #include "ShooterGameModeBase.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/CommandLine.h"
+#include "Engine/GameInstance.h"
+#include "ShooterBotSwarm.h"
+#include "ShooterHUD.h"
+#include "ShooterLevelSubsystem.h"
+#include "Shooter.h"
 
+AShooterGameModeBase::AShooterGameModeBase( ) :
+	RequestedBotCount( 0 )
+{
+	BotSwarmClass = AShooterBotSwarm::StaticClass( );
+	HUDClass = AShooterHUD::StaticClass( );
+}
+
+void AShooterGameModeBase::InitGame( const FString& MapName, const FString& Options, FString& ErrorMessage )
+{
+	Super::InitGame( MapName, Options, ErrorMessage );
+
+	// e.g. "Factory?Bots=1000" or "-ShooterBots=1000 -nullrhi" for a headless scaling run
+	RequestedBotCount = UGameplayStatics::GetIntOption( Options, TEXT( "Bots" ), 0 );
+	FParse::Value( FCommandLine::Get( ), TEXT( "ShooterBots=" ), RequestedBotCount );
+}
+
+void AShooterGameModeBase::StartPlay( )
+{
+	Super::StartPlay( );
+
+	if ( RequestedBotCount > 0 && BotSwarmClass )
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		SpawnParams.bDeferConstruction = true;
+
+		const AActor* PlayerStart = FindPlayerStart( nullptr );
+		const FTransform SwarmTransform { PlayerStart ? PlayerStart->GetActorLocation( ) : FVector::ZeroVector };
+
+		AShooterBotSwarm* BotSwarm = GetWorld( )->SpawnActor<AShooterBotSwarm>( BotSwarmClass, SwarmTransform, SpawnParams );
+		if ( BotSwarm )
+		{
+			BotSwarm->SetBotCount( RequestedBotCount );
+			BotSwarm->FinishSpawning( SwarmTransform );
+			UE_LOG( LogShooter, Log, TEXT( "Spawned a swarm of %d bots" ), RequestedBotCount );
+		}
+	}
+
+	// startup timeline, starting snapshot, soak and benchmarks; see each UShooterLevelSubsystem
+	UShooterLevelSubsystem::NotifyLevelStarted( GetGameInstance( ), GetWorld( ) );
+}
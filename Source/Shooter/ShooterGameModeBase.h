@@ -13,5 +13,19 @@ UCLASS()
 class SHOOTER_API AShooterGameModeBase : public AGameModeBase
 {
 	GENERATED_BODY()
-	
+
+public:
+	AShooterGameModeBase( );
+
+	virtual void InitGame( const FString& MapName, const FString& Options, FString& ErrorMessage ) override;
+
+	virtual void StartPlay( ) override;
+
+private:
+	/* class spawned for the "?Bots=N" / "-ShooterBots=N" scaling test */
+	UPROPERTY( EditDefaultsOnly, Category = Bots, meta = ( AllowPrivateAccess = "true" ) )
+	TSubclassOf<class AShooterBotSwarm> BotSwarmClass;
+
+	/* bots requested on the URL or command line, 0 for none */
+	int32 RequestedBotCount;
 };
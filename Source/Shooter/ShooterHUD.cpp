@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterHUD.h"
+#include "Engine/Canvas.h"
+#include "Engine/Texture2D.h"
+#include "Engine/World.h"
+#include "ShooterCharacter.h"
+#include "ShooterStats.h"
+
+DECLARE_CYCLE_STAT( TEXT( "HUD Draw" ), STAT_ShooterHUDDraw, STATGROUP_Shooter );
+DECLARE_DWORD_COUNTER_STAT( TEXT( "Crosshair Layout Rebuilds" ), STAT_CrosshairLayoutRebuilds, STATGROUP_Shooter );
+DECLARE_DWORD_COUNTER_STAT( TEXT( "Hit Markers" ), STAT_HitMarkers, STATGROUP_Shooter );
+
+AShooterHUD::AShooterHUD( ) :
+	CrosshairCenter( nullptr ),
+	CrosshairLeft( nullptr ),
+	CrosshairRight( nullptr ),
+	CrosshairTop( nullptr ),
+	CrosshairBottom( nullptr ),
+	CrosshairSize( 64.f ),
+	CrosshairSpreadMax( 16.f ),
+	SpreadRedrawThreshold( 0.01f ),
+	HitMarkerTexture( nullptr ),
+	HitMarkerSize( 32.f ),
+	HitMarkerDuration( 0.3f ),
+	LayoutSpread( 0.f ),
+	LayoutViewportSize( FVector2D::ZeroVector ),
+	bCrosshairLayoutValid( false )
+{
+}
+
+void AShooterHUD::AddHitMarker( const FVector& WorldLocation )
+{
+	HitMarkers.Add( { WorldLocation, HitMarkerDuration } );
+}
+
+void AShooterHUD::BuildCrosshairLayout( float Spread, const FVector2D& ViewportSize )
+{
+	LayoutSpread = Spread;
+	LayoutViewportSize = ViewportSize;
+	bCrosshairLayoutValid = true;
+	INC_DWORD_STAT( STAT_CrosshairLayoutRebuilds );
+
+	const FVector2D TileSize { CrosshairSize, CrosshairSize };
+	const FVector2D Origin { ViewportSize * 0.5f - TileSize * 0.5f };
+	const float SpreadOffset { Spread * CrosshairSpreadMax };
+
+	CrosshairTiles.Reset( );
+	auto AddTile = [this, &TileSize]( UTexture2D* Texture, const FVector2D& Position )
+	{
+		if ( Texture && Texture->Resource )
+		{
+			FCanvasTileItem& Tile = CrosshairTiles.Emplace_GetRef( Position, Texture->Resource, TileSize, FLinearColor::White );
+			Tile.BlendMode = SE_BLEND_Translucent;
+		}
+	};
+	AddTile( CrosshairCenter, Origin );
+	AddTile( CrosshairLeft, Origin + FVector2D( -SpreadOffset, 0.f ) );
+	AddTile( CrosshairRight, Origin + FVector2D( SpreadOffset, 0.f ) );
+	AddTile( CrosshairTop, Origin + FVector2D( 0.f, -SpreadOffset ) );
+	AddTile( CrosshairBottom, Origin + FVector2D( 0.f, SpreadOffset ) );
+}
+
+void AShooterHUD::DrawHUD( )
+{
+	Super::DrawHUD( );
+
+	SCOPE_CYCLE_COUNTER( STAT_ShooterHUDDraw );
+
+	// no crosshair while driving a vehicle or spectating
+	if ( const AShooterCharacter* ShooterCharacter = Cast<AShooterCharacter>( GetOwningPawn( ) ) )
+	{
+		const float Spread { ShooterCharacter->GetCrosshairSpreadMultiplier( ) };
+		const FVector2D ViewportSize { Canvas->ClipX, Canvas->ClipY };
+		if ( !bCrosshairLayoutValid
+			|| FMath::Abs( Spread - LayoutSpread ) > SpreadRedrawThreshold
+			|| ViewportSize != LayoutViewportSize )
+		{
+			BuildCrosshairLayout( Spread, ViewportSize );
+		}
+		for ( FCanvasTileItem& Tile : CrosshairTiles )
+		{
+			Canvas->DrawItem( Tile );
+		}
+	}
+
+	if ( HitMarkers.Num( ) > 0 )
+	{
+		DrawHitMarkers( );
+	}
+}
+
+void AShooterHUD::DrawHitMarkers( )
+{
+	const float DeltaTime { GetWorld( )->GetDeltaSeconds( ) };
+	const FVector2D TileSize { HitMarkerSize, HitMarkerSize };
+	for ( int32 i = HitMarkers.Num( ) - 1; i >= 0; i-- )
+	{
+		FHitMarker& Marker = HitMarkers[i];
+		Marker.TimeRemaining -= DeltaTime;
+		if ( Marker.TimeRemaining <= 0.f )
+		{
+			HitMarkers.RemoveAtSwap( i );
+			continue;
+		}
+		if ( HitMarkerTexture == nullptr || HitMarkerTexture->Resource == nullptr )
+		{
+			continue;
+		}
+		// behind the camera
+		const FVector ScreenLocation { Project( Marker.WorldLocation ) };
+		if ( ScreenLocation.Z <= 0.f )
+		{
+			continue;
+		}
+		const float Alpha { Marker.TimeRemaining / FMath::Max( HitMarkerDuration, KINDA_SMALL_NUMBER ) };
+		FCanvasTileItem Tile( FVector2D( ScreenLocation ) - TileSize * 0.5f, HitMarkerTexture->Resource, TileSize, FLinearColor( 1.f, 1.f, 1.f, Alpha ) );
+		Tile.BlendMode = SE_BLEND_Translucent;
+		Canvas->DrawItem( Tile );
+	}
+	SET_DWORD_STAT( STAT_HitMarkers, HitMarkers.Num( ) );
+}
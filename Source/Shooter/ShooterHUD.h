@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/HUD.h"
+#include "CanvasItem.h"
+#include "ShooterHUD.generated.h"
+
+class UTexture2D;
+
+/**
+ * Draws the crosshair and hit markers as canvas tiles. The crosshair layout is cached and
+ * only rebuilt when the owning character's spread moves past SpreadRedrawThreshold.
+ */
+UCLASS()
+class SHOOTER_API AShooterHUD : public AHUD
+{
+	GENERATED_BODY()
+
+public:
+	AShooterHUD( );
+
+	virtual void DrawHUD( ) override;
+
+	/* flash a hit marker over WorldLocation */
+	void AddHitMarker( const FVector& WorldLocation );
+
+private:
+	/* place the crosshair tiles around the viewport center for Spread */
+	void BuildCrosshairLayout( float Spread, const FVector2D& ViewportSize );
+
+	void DrawHitMarkers( );
+
+	UPROPERTY( EditDefaultsOnly, Category = Crosshairs, meta = ( AllowPrivateAccess = "true" ) )
+	UTexture2D* CrosshairCenter;
+
+	UPROPERTY( EditDefaultsOnly, Category = Crosshairs, meta = ( AllowPrivateAccess = "true" ) )
+	UTexture2D* CrosshairLeft;
+
+	UPROPERTY( EditDefaultsOnly, Category = Crosshairs, meta = ( AllowPrivateAccess = "true" ) )
+	UTexture2D* CrosshairRight;
+
+	UPROPERTY( EditDefaultsOnly, Category = Crosshairs, meta = ( AllowPrivateAccess = "true" ) )
+	UTexture2D* CrosshairTop;
+
+	UPROPERTY( EditDefaultsOnly, Category = Crosshairs, meta = ( AllowPrivateAccess = "true" ) )
+	UTexture2D* CrosshairBottom;
+
+	/* on-screen size of each crosshair piece, pixels */
+	UPROPERTY( EditDefaultsOnly, Category = Crosshairs, meta = ( AllowPrivateAccess = "true" ) )
+	float CrosshairSize;
+
+	/* pixels the outer pieces move out per unit of spread multiplier */
+	UPROPERTY( EditDefaultsOnly, Category = Crosshairs, meta = ( AllowPrivateAccess = "true" ) )
+	float CrosshairSpreadMax;
+
+	/* spread change needed before the layout is rebuilt */
+	UPROPERTY( EditDefaultsOnly, Category = Crosshairs, meta = ( AllowPrivateAccess = "true" ) )
+	float SpreadRedrawThreshold;
+
+	UPROPERTY( EditDefaultsOnly, Category = HitMarkers, meta = ( AllowPrivateAccess = "true" ) )
+	UTexture2D* HitMarkerTexture;
+
+	UPROPERTY( EditDefaultsOnly, Category = HitMarkers, meta = ( AllowPrivateAccess = "true" ) )
+	float HitMarkerSize;
+
+	/* seconds a hit marker stays up, fading out */
+	UPROPERTY( EditDefaultsOnly, Category = HitMarkers, meta = ( AllowPrivateAccess = "true" ) )
+	float HitMarkerDuration;
+
+	struct FHitMarker
+	{
+		FVector WorldLocation;
+		float TimeRemaining;
+	};
+
+	TArray<FHitMarker> HitMarkers;
+
+	/* crosshair pieces positioned for LayoutSpread and LayoutViewportSize */
+	TArray<FCanvasTileItem, TInlineAllocator<5>> CrosshairTiles;
+	float LayoutSpread;
+	FVector2D LayoutViewportSize;
+	bool bCrosshairLayoutValid;
+};
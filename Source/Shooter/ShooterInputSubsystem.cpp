@@ -0,0 +1,235 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterInputSubsystem.h"
+#include "HAL/FileManager.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/CoreDelegates.h"
+#include "ProfilingDebugging/MiscTrace.h"
+#include "Shooter.h"
+#include "ShooterStats.h"
+
+DECLARE_FLOAT_COUNTER_STAT( TEXT( "Fire Input To Muzzle Flash (ms)" ), STAT_FireInputLatencyMs, STATGROUP_Shooter );
+DECLARE_FLOAT_COUNTER_STAT( TEXT( "Look Input To Camera (ms)" ), STAT_LookInputLatencyMs, STATGROUP_Shooter );
+
+namespace ShooterInputFile
+{
+	constexpr uint32 Magic { 0x52494853 }; // "SHIR"
+	constexpr uint16 Version { 2 };
+
+	// per frame: flags, delta time, then a float for each axis whose bit is set
+	constexpr uint16 FireButtonBit { 1 << 8 };
+	constexpr uint16 AimingButtonBit { 1 << 9 };
+	constexpr uint16 JumpButtonBit { 1 << 10 };
+
+	void SerializeFrame( FArchive& Ar, FShooterInputFrame& Frame )
+	{
+		constexpr int32 NumAxes { static_cast<int32>( EShooterInputAxis::ESIA_Max ) };
+
+		uint16 Flags { 0 };
+		if ( Ar.IsSaving( ) )
+		{
+			for ( int32 Axis = 0; Axis < NumAxes; Axis++ )
+			{
+				Flags |= Frame.Axes[Axis] != 0.f ? 1 << Axis : 0;
+			}
+			Flags |= Frame.bFireButton ? FireButtonBit : 0;
+			Flags |= Frame.bAimingButton ? AimingButtonBit : 0;
+			Flags |= Frame.bJumpButton ? JumpButtonBit : 0;
+		}
+		Ar << Flags;
+		Ar << Frame.DeltaTime;
+		for ( int32 Axis = 0; Axis < NumAxes; Axis++ )
+		{
+			if ( Flags & ( 1 << Axis ) )
+			{
+				Ar << Frame.Axes[Axis];
+			}
+			else
+			{
+				Frame.Axes[Axis] = 0.f;
+			}
+		}
+		Frame.bFireButton = ( Flags & FireButtonBit ) != 0;
+		Frame.bAimingButton = ( Flags & AimingButtonBit ) != 0;
+		Frame.bJumpButton = ( Flags & JumpButtonBit ) != 0;
+	}
+}
+
+void UShooterInputSubsystem::Initialize( FSubsystemCollectionBase& Collection )
+{
+	Super::Initialize( Collection );
+
+	FString Filename;
+	if ( FParse::Value( FCommandLine::Get( ), TEXT( "ReplayInput=" ), Filename ) )
+	{
+		bReplaying = LoadReplay( Filename );
+	}
+	else if ( FParse::Value( FCommandLine::Get( ), TEXT( "RecordInput=" ), Filename ) )
+	{
+		Writer.Reset( IFileManager::Get( ).CreateFileWriter( *Filename ) );
+		if ( Writer.IsValid( ) )
+		{
+			uint32 Magic { ShooterInputFile::Magic };
+			uint16 Version { ShooterInputFile::Version };
+			*Writer << Magic;
+			*Writer << Version;
+			UE_LOG( LogShooter, Log, TEXT( "Recording input to %s" ), *Filename );
+		}
+		else
+		{
+			UE_LOG( LogShooter, Warning, TEXT( "Couldn't open %s to record input" ), *Filename );
+		}
+	}
+
+	BeginFrameHandle = FCoreDelegates::OnBeginFrame.AddUObject( this, &UShooterInputSubsystem::OnBeginFrame );
+}
+
+void UShooterInputSubsystem::Deinitialize( )
+{
+	FCoreDelegates::OnBeginFrame.Remove( BeginFrameHandle );
+
+	if ( Writer.IsValid( ) )
+	{
+		Writer->Close( );
+		Writer.Reset( );
+		UE_LOG( LogShooter, Log, TEXT( "Recorded %d input frames" ), RecordedFrames );
+	}
+	LogLatencySummary( );
+
+	Super::Deinitialize( );
+}
+
+bool UShooterInputSubsystem::LoadReplay( const FString& Filename )
+{
+	TUniquePtr<FArchive> Reader( IFileManager::Get( ).CreateFileReader( *Filename ) );
+	if ( !Reader.IsValid( ) )
+	{
+		UE_LOG( LogShooter, Warning, TEXT( "Couldn't open input replay %s" ), *Filename );
+		return false;
+	}
+
+	uint32 Magic { 0 };
+	uint16 Version { 0 };
+	*Reader << Magic;
+	*Reader << Version;
+	if ( Magic != ShooterInputFile::Magic || Version != ShooterInputFile::Version )
+	{
+		UE_LOG( LogShooter, Warning, TEXT( "%s isn't a version %d input recording" ), *Filename, ShooterInputFile::Version );
+		return false;
+	}
+
+	while ( Reader->Tell( ) < Reader->TotalSize( ) && !Reader->IsError( ) )
+	{
+		ShooterInputFile::SerializeFrame( *Reader, ReplayFrames.AddDefaulted_GetRef( ) );
+	}
+	if ( Reader->IsError( ) )
+	{
+		ReplayFrames.Pop( );
+		UE_LOG( LogShooter, Warning, TEXT( "Input replay %s is truncated, playing %d frames" ), *Filename, ReplayFrames.Num( ) );
+	}
+	if ( ReplayFrames.Num( ) == 0 )
+	{
+		return false;
+	}
+
+	// run the game at the recorded frame times so the replay lands the same inputs on the same simulation steps
+	FApp::SetUseFixedTimeStep( true );
+	FApp::SetFixedDeltaTime( ReplayFrames[0].DeltaTime );
+
+	UE_LOG( LogShooter, Log, TEXT( "Replaying %d input frames from %s" ), ReplayFrames.Num( ), *Filename );
+	return true;
+}
+
+void UShooterInputSubsystem::RecordFrame( const FShooterInputFrame& Frame )
+{
+	if ( Writer.IsValid( ) )
+	{
+		FShooterInputFrame SavedFrame { Frame };
+		ShooterInputFile::SerializeFrame( *Writer, SavedFrame );
+		RecordedFrames++;
+	}
+}
+
+bool UShooterInputSubsystem::ReadFrame( FShooterInputFrame& OutFrame )
+{
+	if ( !bReplaying )
+	{
+		return false;
+	}
+	if ( !ReplayFrames.IsValidIndex( ReplayFrameIndex ) )
+	{
+		bReplaying = false;
+		FApp::SetUseFixedTimeStep( false );
+		UE_LOG( LogShooter, Log, TEXT( "Input replay finished after %d frames" ), ReplayFrameIndex );
+		// the latency summary is logged from Deinitialize on the way out
+		FPlatformMisc::RequestExit( false );
+		return false;
+	}
+
+	OutFrame = ReplayFrames[ReplayFrameIndex++];
+	if ( ReplayFrames.IsValidIndex( ReplayFrameIndex ) )
+	{
+		FApp::SetFixedDeltaTime( ReplayFrames[ReplayFrameIndex].DeltaTime );
+	}
+	return true;
+}
+
+void UShooterInputSubsystem::OnBeginFrame( )
+{
+	FrameStartSeconds = FPlatformTime::Seconds( );
+}
+
+void UShooterInputSubsystem::MarkInput( EShooterLatencyEvent Event )
+{
+	FLatencyTrack& Track = Latency[static_cast<int32>( Event )];
+	if ( !Track.bPending )
+	{
+		Track.bPending = true;
+		Track.InputFrameStartSeconds = FrameStartSeconds;
+	}
+	if ( Event == EShooterLatencyEvent::ESLE_Fire )
+	{
+		TRACE_BOOKMARK( TEXT( "Fire input" ) );
+	}
+}
+
+void UShooterInputSubsystem::MarkResponse( EShooterLatencyEvent Event )
+{
+	FLatencyTrack& Track = Latency[static_cast<int32>( Event )];
+	if ( !Track.bPending )
+	{
+		return;
+	}
+	Track.bPending = false;
+
+	const double LatencyMs { ( FPlatformTime::Seconds( ) - Track.InputFrameStartSeconds ) * 1000.0 };
+	Track.TotalMs += LatencyMs;
+	Track.MaxMs = FMath::Max( Track.MaxMs, LatencyMs );
+	Track.Count++;
+
+	if ( Event == EShooterLatencyEvent::ESLE_Fire )
+	{
+		SET_FLOAT_STAT( STAT_FireInputLatencyMs, LatencyMs );
+		TRACE_BOOKMARK( TEXT( "Muzzle flash" ) );
+	}
+	else
+	{
+		SET_FLOAT_STAT( STAT_LookInputLatencyMs, LatencyMs );
+	}
+}
+
+void UShooterInputSubsystem::LogLatencySummary( ) const
+{
+	static const TCHAR* EventNames[] { TEXT( "Fire input to muzzle flash" ), TEXT( "Look input to camera" ) };
+	for ( int32 Event = 0; Event < static_cast<int32>( EShooterLatencyEvent::ESLE_Max ); Event++ )
+	{
+		const FLatencyTrack& Track = Latency[Event];
+		if ( Track.Count > 0 )
+		{
+			UE_LOG( LogShooter, Log, TEXT( "%s: %d samples, avg %.2f ms, max %.2f ms" ),
+				EventNames[Event], Track.Count, Track.TotalMs / Track.Count, Track.MaxMs );
+		}
+	}
+}
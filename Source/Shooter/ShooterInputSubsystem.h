@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "ShooterInputSubsystem.generated.h"
+
+enum class EShooterInputAxis : uint8
+{
+	ESIA_MoveForward,
+	ESIA_MoveRight,
+	ESIA_Turn,
+	ESIA_LookUp,
+	ESIA_TurnRate,
+	ESIA_LookUpRate,
+
+	ESIA_Max
+};
+
+enum class EShooterLatencyEvent : uint8
+{
+	ESLE_Fire,
+	ESLE_Look,
+
+	ESLE_Max
+};
+
+/* the recorded inputs for one frame */
+struct FShooterInputFrame
+{
+	float DeltaTime { 0.f };
+	float Axes[static_cast<int32>( EShooterInputAxis::ESIA_Max )] {};
+	bool bFireButton { false };
+	bool bAimingButton { false };
+	bool bJumpButton { false };
+
+	float GetAxis( EShooterInputAxis Axis ) const { return Axes[static_cast<int32>( Axis )]; }
+	void SetAxis( EShooterInputAxis Axis, float Value ) { Axes[static_cast<int32>( Axis )] = Value; }
+};
+
+/**
+ * Records the character's input to a compact binary file (-RecordInput=<file>) or plays one back
+ * in place of live input (-ReplayInput=<file>), and measures input-to-response latency.
+ * Replays use the recorded frame times and exit when the file runs out, for headless perf captures.
+ */
+UCLASS()
+class SHOOTER_API UShooterInputSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize( FSubsystemCollectionBase& Collection ) override;
+	virtual void Deinitialize( ) override;
+
+	bool IsRecording( ) const { return Writer.IsValid( ); }
+	bool IsReplaying( ) const { return bReplaying; }
+
+	void RecordFrame( const FShooterInputFrame& Frame );
+
+	/* next recorded frame; false once the replay has run out */
+	bool ReadFrame( FShooterInputFrame& OutFrame );
+
+	/* an input that should lead to Event was handled this frame */
+	void MarkInput( EShooterLatencyEvent Event );
+
+	/* Event's response happened; records the time since the input's frame started */
+	void MarkResponse( EShooterLatencyEvent Event );
+
+private:
+	bool LoadReplay( const FString& Filename );
+	void OnBeginFrame( );
+	void LogLatencySummary( ) const;
+
+	struct FLatencyTrack
+	{
+		bool bPending { false };
+		double InputFrameStartSeconds { 0.0 };
+		double TotalMs { 0.0 };
+		double MaxMs { 0.0 };
+		int32 Count { 0 };
+	};
+
+	TUniquePtr<FArchive> Writer;
+	int32 RecordedFrames { 0 };
+
+	TArray<FShooterInputFrame> ReplayFrames;
+	int32 ReplayFrameIndex { 0 };
+	bool bReplaying { false };
+
+	/* when this frame started; input was polled just after */
+	double FrameStartSeconds { 0.0 };
+	FLatencyTrack Latency[static_cast<int32>( EShooterLatencyEvent::ESLE_Max )];
+	FDelegateHandle BeginFrameHandle;
+};
@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterLevelSubsystem.h"
+#include "Engine/GameInstance.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Shooter.h"
+
+void UShooterLevelSubsystem::NotifyLevelStarted( UGameInstance* GameInstance, UWorld* World )
+{
+	if ( GameInstance == nullptr )
+	{
+		return;
+	}
+
+	TArray<UShooterLevelSubsystem*> LevelSubsystems { GameInstance->GetSubsystemArray<UShooterLevelSubsystem>( ) };
+	LevelSubsystems.StableSort( []( const UShooterLevelSubsystem& A, const UShooterLevelSubsystem& B )
+	{
+		return A.GetLevelStartedOrder( ) < B.GetLevelStartedOrder( );
+	} );
+
+	for ( UShooterLevelSubsystem* LevelSubsystem : LevelSubsystems )
+	{
+		LevelSubsystem->OnLevelStarted( World );
+	}
+}
+
+bool UShooterLevelSubsystem::SaveBenchmarkResults( const TCHAR* BenchmarkName, const FString& Filename, const FString& Header, const FString& Rows, bool bAppend )
+{
+	const bool bNewFile { !bAppend || !IFileManager::Get( ).FileExists( *Filename ) };
+	const FString Contents { bNewFile ? Header + Rows : Rows };
+	const bool bSaved { FFileHelper::SaveStringToFile( Contents, *Filename, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get( ), bAppend ? FILEWRITE_Append : FILEWRITE_None ) };
+
+	if ( bSaved )
+	{
+		UE_LOG( LogShooter, Log, TEXT( "%s written to %s" ), BenchmarkName, *Filename );
+	}
+	else
+	{
+		UE_LOG( LogShooter, Warning, TEXT( "%s couldn't write %s" ), BenchmarkName, *Filename );
+	}
+	return bSaved;
+}
+
+void UShooterLevelSubsystem::FinishBenchmarkRun( bool bSucceeded )
+{
+	if ( !GIsEditor )
+	{
+		FPlatformMisc::RequestExitWithStatus( false, bSucceeded ? 0 : 1 );
+	}
+}
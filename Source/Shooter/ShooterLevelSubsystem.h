@@ -0,0 +1,37 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "ShooterLevelSubsystem.generated.h"
+
+/**
+ * Game instance subsystem that is told when each level has started, once every actor has begun play.
+ * The game mode starts every subclass through NotifyLevelStarted, lowest GetLevelStartedOrder first.
+ * Also holds what the command line benchmarks share: writing their results and quitting afterwards.
+ */
+UCLASS( Abstract )
+class SHOOTER_API UShooterLevelSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnLevelStarted( UWorld* World ) { }
+
+	/* lower starts first; below 0 for subsystems that must see the level before any benchmark touches it */
+	virtual int32 GetLevelStartedOrder( ) const { return 0; }
+
+	/* OnLevelStarted on every level subsystem of GameInstance, in order */
+	static void NotifyLevelStarted( UGameInstance* GameInstance, UWorld* World );
+
+	/**
+	* Write a benchmark's results and log where they went
+	* @param Header   First line, written only if the file is new or being replaced
+	* @param bAppend  Add Rows to the end of the file, so runs on different maps or targets collect in one place
+	*/
+	static bool SaveBenchmarkResults( const TCHAR* BenchmarkName, const FString& Filename, const FString& Header, const FString& Rows, bool bAppend );
+
+	/* the benchmark is done; quit, unless it ran in the editor, with a failing exit code if it couldn't run */
+	static void FinishBenchmarkRun( bool bSucceeded = true );
+};
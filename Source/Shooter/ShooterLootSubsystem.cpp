@@ -0,0 +1,255 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterLootSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/GameModeBase.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Paths.h"
+#include "Shooter.h"
+#include "ShooterLevelSubsystem.h"
+#include "ShooterStats.h"
+#include "Weapon.h"
+
+DECLARE_CYCLE_STAT( TEXT( "Loot Spawner" ), STAT_LootSpawner, STATGROUP_Shooter );
+DECLARE_DWORD_COUNTER_STAT( TEXT( "Loot Spawned Per Frame" ), STAT_LootSpawnedPerFrame, STATGROUP_Shooter );
+DECLARE_DWORD_COUNTER_STAT( TEXT( "Loot Waiting (Over Budget)" ), STAT_LootWaiting, STATGROUP_Shooter );
+
+static TAutoConsoleVariable<float> CVarLootFrameBudgetMs(
+	TEXT( "shooter.Loot.FrameBudgetMs" ),
+	2.f,
+	TEXT( "Time each frame may spend spawning queued loot; at least one item spawns a frame. 0 spawns everything at once" ) );
+
+namespace
+{
+	const int32 NumRarities { static_cast<int32>( EItemRarity::EIR_Max ) };
+	static_assert( NumRarities == 5, "FShooterLootTable needs a weight for every rarity" );
+
+	const float BenchmarkSpacing { 200.f };
+}
+
+void UShooterLootSubsystem::OnWorldBeginPlay( UWorld& InWorld )
+{
+	Super::OnWorldBeginPlay( InWorld );
+
+	int32 BenchmarkItems { 0 };
+	if ( InWorld.IsGameWorld( ) && FParse::Value( FCommandLine::Get( ), TEXT( "LootBenchmark=" ), BenchmarkItems ) && BenchmarkItems > 0 )
+	{
+		QueueBenchmark( BenchmarkItems );
+	}
+}
+
+void UShooterLootSubsystem::QueueLoot( const TArray<FShooterLootSpawn>& Plan, int32 Seed )
+{
+	if ( GetWorld( )->GetNetMode( ) == NM_Client )
+	{
+		UE_LOG( LogShooter, Warning, TEXT( "QueueLoot: loot is spawned by the server" ) );
+		return;
+	}
+
+	TArray<EItemRarity> Rarities;
+	RollRarities( Plan, Seed != 0 ? Seed : FMath::Rand( ), Rarities );
+
+	if ( !IsSpawning( ) )
+	{
+		Pending.Reset( );
+		NextPending = 0;
+		QueueStartSeconds = FPlatformTime::Seconds( );
+		SpawnMs = 0.0;
+		MaxFrameMs = 0.0;
+		SpawnFrames = 0;
+		FMemory::Memzero( RarityCounts );
+	}
+
+	Pending.Reserve( Pending.Num( ) + Plan.Num( ) );
+	for ( int32 Index = 0; Index < Plan.Num( ); Index++ )
+	{
+		const FShooterLootSpawn& Spawn = Plan[Index];
+		if ( Spawn.ItemClass )
+		{
+			Pending.Add( { Spawn.ItemClass, Spawn.Transform, Rarities[Index], Spawn.ItemCount } );
+			RarityCounts[static_cast<int32>( Rarities[Index] )]++;
+		}
+	}
+}
+
+void UShooterLootSubsystem::RollRarities( const TArray<FShooterLootSpawn>& Plan, int32 Seed, TArray<EItemRarity>& OutRarities ) const
+{
+	// running totals of each table's weights, so a roll is one draw and a scan of five floats
+	TArray<TStaticArray<float, NumRarities>, TInlineAllocator<8>> Cumulative;
+	TMap<FName, int32> TableIndices;
+	for ( const FShooterLootTable& Table : RarityTables )
+	{
+		const float Weights[NumRarities] { Table.Damaged, Table.Common, Table.Uncommon, Table.Rare, Table.Legendary };
+		TStaticArray<float, NumRarities>& Totals = Cumulative.AddDefaulted_GetRef( );
+		float Total { 0.f };
+		for ( int32 Rarity = 0; Rarity < NumRarities; Rarity++ )
+		{
+			Total += FMath::Max( Weights[Rarity], 0.f );
+			Totals[Rarity] = Total;
+		}
+		TableIndices.Add( Table.Name, Cumulative.Num( ) - 1 );
+	}
+
+	FRandomStream Stream { Seed };
+	OutRarities.SetNumUninitialized( Plan.Num( ) );
+
+	// plans tend to come in runs of the same table; only look a table up when it changes
+	FName LastTable { NAME_None };
+	const TStaticArray<float, NumRarities>* Totals = nullptr;
+	for ( int32 Index = 0; Index < Plan.Num( ); Index++ )
+	{
+		const FName TableName { Plan[Index].RarityTable };
+		if ( TableName != LastTable )
+		{
+			const int32* TableIndex = TableIndices.Find( TableName );
+			Totals = TableIndex && Cumulative[*TableIndex][NumRarities - 1] > 0.f ? &Cumulative[*TableIndex] : nullptr;
+			if ( TableIndex == nullptr && !TableName.IsNone( ) )
+			{
+				UE_LOG( LogShooter, Warning, TEXT( "QueueLoot: no rarity table %s, keeping the class rarity" ), *TableName.ToString( ) );
+			}
+			LastTable = TableName;
+		}
+
+		EItemRarity Rarity { EItemRarity::EIR_Max };
+		if ( Totals )
+		{
+			const float Roll { Stream.FRand( ) * ( *Totals )[NumRarities - 1] };
+			int32 Picked { 0 };
+			while ( Picked < NumRarities - 1 && Roll >= ( *Totals )[Picked] )
+			{
+				Picked++;
+			}
+			Rarity = static_cast<EItemRarity>( Picked );
+		}
+		OutRarities[Index] = Rarity;
+	}
+}
+
+float UShooterLootSubsystem::GetProgress( ) const
+{
+	return Pending.Num( ) > 0 ? static_cast<float>( NextPending ) / Pending.Num( ) : 1.f;
+}
+
+bool UShooterLootSubsystem::IsTickable( ) const
+{
+	return !IsTemplate( ) && IsSpawning( );
+}
+
+TStatId UShooterLootSubsystem::GetStatId( ) const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT( UShooterLootSubsystem, STATGROUP_Tickables );
+}
+
+void UShooterLootSubsystem::Tick( float DeltaTime )
+{
+	SCOPE_CYCLE_COUNTER( STAT_LootSpawner );
+
+	const double BudgetSeconds { CVarLootFrameBudgetMs.GetValueOnGameThread( ) / 1000.0 };
+	const double StartSeconds { FPlatformTime::Seconds( ) };
+	const int32 FirstSpawned { NextPending };
+
+	// an item's spawn can't be split, so the budget is checked between items
+	do
+	{
+		SpawnLoot( Pending[NextPending++] );
+	}
+	while ( IsSpawning( ) && ( BudgetSeconds <= 0.0 || FPlatformTime::Seconds( ) - StartSeconds < BudgetSeconds ) );
+
+	const double FrameMs { ( FPlatformTime::Seconds( ) - StartSeconds ) * 1000.0 };
+	SpawnMs += FrameMs;
+	MaxFrameMs = FMath::Max( MaxFrameMs, FrameMs );
+	SpawnFrames++;
+
+	SET_DWORD_STAT( STAT_LootSpawnedPerFrame, NextPending - FirstSpawned );
+	SET_DWORD_STAT( STAT_LootWaiting, Pending.Num( ) - NextPending );
+
+	OnProgress.Broadcast( NextPending, Pending.Num( ) );
+	if ( !IsSpawning( ) )
+	{
+		FinishSpawning( );
+	}
+}
+
+void UShooterLootSubsystem::SpawnLoot( const FPendingLoot& Loot )
+{
+	AItem* Item = GetWorld( )->SpawnActorDeferred<AItem>( Loot.ItemClass, Loot.Transform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn );
+	if ( Item )
+	{
+		Item->SetSpawnProperties(
+			Loot.Rarity != EItemRarity::EIR_Max ? Loot.Rarity : Item->GetItemRarity( ),
+			Loot.ItemCount > 0 ? Loot.ItemCount : Item->GetItemCount( ) );
+		Item->FinishSpawning( Loot.Transform );
+	}
+}
+
+void UShooterLootSubsystem::FinishSpawning( )
+{
+	const int32 NumSpawned { Pending.Num( ) };
+	const double TotalSeconds { FPlatformTime::Seconds( ) - QueueStartSeconds };
+	UE_LOG( LogShooter, Log, TEXT( "Spawned %d items in %.2f s over %d frames: %.1f ms spawning, %.2f ms worst frame. "
+		"Damaged %d, Common %d, Uncommon %d, Rare %d, Legendary %d, class rarity %d" ),
+		NumSpawned, TotalSeconds, SpawnFrames, SpawnMs, MaxFrameMs,
+		RarityCounts[0], RarityCounts[1], RarityCounts[2], RarityCounts[3], RarityCounts[4], RarityCounts[NumRarities] );
+
+	if ( bBenchmarking )
+	{
+		bBenchmarking = false;
+
+		const FString Filename { FPaths::ProjectSavedDir( ) / TEXT( "LootBench" ) / TEXT( "Spawn.csv" ) };
+		const FString Row { FString::Printf( TEXT( "%s,%d,%.2f,%d,%.2f,%.1f,%.2f\n" ), *UWorld::RemovePIEPrefix( GetWorld( )->GetMapName( ) ),
+			NumSpawned, CVarLootFrameBudgetMs.GetValueOnGameThread( ), SpawnFrames, TotalSeconds, SpawnMs, MaxFrameMs ) };
+		UE_LOG( LogShooter, Log, TEXT( "LootBenchmark: %s" ), *Row );
+		UShooterLevelSubsystem::SaveBenchmarkResults( TEXT( "LootBenchmark" ), Filename, TEXT( "Map,Items,BudgetMs,Frames,TotalSec,SpawnMs,MaxFrameMs\n" ), Row, true );
+		UShooterLevelSubsystem::FinishBenchmarkRun( );
+	}
+
+	Pending.Reset( );
+	NextPending = 0;
+	OnFinished.Broadcast( NumSpawned );
+}
+
+void UShooterLootSubsystem::QueueBenchmark( int32 NumItems )
+{
+	const AGameModeBase* GameMode = GetWorld( )->GetAuthGameMode( );
+	const AActor* PlayerStart = GameMode ? GameMode->FindPlayerStart( nullptr ) : nullptr;
+	const FVector Origin { PlayerStart ? PlayerStart->GetActorLocation( ) : FVector::ZeroVector };
+
+	const int32 GridSide { FMath::CeilToInt( FMath::Sqrt( static_cast<float>( NumItems ) ) ) };
+	const FVector Corner { Origin - FVector( GridSide * BenchmarkSpacing * 0.5f, GridSide * BenchmarkSpacing * 0.5f, 0.f ) };
+
+	// the Blueprints are what a real drop spawns, meshes, widgets and all
+	TArray<UClass*> ItemClasses;
+	for ( const TSoftClassPtr<AItem>& BenchmarkClass : BenchmarkClasses )
+	{
+		if ( UClass* ItemClass = BenchmarkClass.LoadSynchronous( ) )
+		{
+			ItemClasses.Add( ItemClass );
+		}
+		else
+		{
+			UE_LOG( LogShooter, Warning, TEXT( "LootBenchmark: couldn't load %s" ), *BenchmarkClass.ToString( ) );
+		}
+	}
+	if ( ItemClasses.Num( ) == 0 )
+	{
+		UE_LOG( LogShooter, Warning, TEXT( "LootBenchmark: no BenchmarkClasses, spawning bare native items" ) );
+		ItemClasses.Add( AWeapon::StaticClass( ) );
+		ItemClasses.Add( AItem::StaticClass( ) );
+	}
+
+	TArray<FShooterLootSpawn> Plan;
+	Plan.SetNum( NumItems );
+	for ( int32 Index = 0; Index < NumItems; Index++ )
+	{
+		FShooterLootSpawn& Spawn = Plan[Index];
+		Spawn.ItemClass = ItemClasses[Index % ItemClasses.Num( )];
+		Spawn.Transform.SetLocation( Corner + FVector( ( Index % GridSide ) * BenchmarkSpacing, ( Index / GridSide ) * BenchmarkSpacing, 0.f ) );
+		Spawn.RarityTable = Spawn.ItemClass->IsChildOf<AWeapon>( ) ? TEXT( "Weapon" ) : TEXT( "Default" );
+	}
+
+	bBenchmarking = true;
+	QueueLoot( Plan, 1 );
+	UE_LOG( LogShooter, Log, TEXT( "LootBenchmark: spawning %d items at %.2f ms a frame" ), NumItems, CVarLootFrameBudgetMs.GetValueOnGameThread( ) );
+}
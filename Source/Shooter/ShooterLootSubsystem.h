@@ -0,0 +1,142 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "Item.h"
+#include "ShooterLootSubsystem.generated.h"
+
+/* relative chance of each rarity; weights don't need to add up to anything */
+USTRUCT( BlueprintType )
+struct FShooterLootTable
+{
+	GENERATED_BODY()
+
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Loot )
+	FName Name;
+
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Loot )
+	float Damaged { 0.f };
+
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Loot )
+	float Common { 0.f };
+
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Loot )
+	float Uncommon { 0.f };
+
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Loot )
+	float Rare { 0.f };
+
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Loot )
+	float Legendary { 0.f };
+};
+
+/* one pickup in a spawn plan */
+USTRUCT( BlueprintType )
+struct FShooterLootSpawn
+{
+	GENERATED_BODY()
+
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Loot )
+	TSubclassOf<AItem> ItemClass;
+
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Loot )
+	FTransform Transform;
+
+	/* table to roll rarity from; None keeps the class's rarity */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Loot )
+	FName RarityTable;
+
+	/* 0 keeps the class's count */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Loot )
+	int32 ItemCount { 0 };
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams( FOnShooterLootProgress, int32, NumSpawned, int32, NumQueued );
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam( FOnShooterLootFinished, int32, NumSpawned );
+
+/**
+ * Spawns large numbers of pickups without stalling a frame.
+ * A queued plan has its rarities rolled in one pass from the weighted tables in RarityTables, then
+ * its items are spawned deferred, with rarity and count set before they begin play, for as long as
+ * each frame's shooter.Loot.FrameBudgetMs allows.
+ *
+ * -LootBenchmark=<items> queues a grid of BenchmarkClasses around the player start, appends how long
+ * the spawn took to Saved/LootBench/Spawn.csv and exits. Set shooter.Loot.FrameBudgetMs 0 to spawn in one frame.
+ */
+UCLASS( Config = Game )
+class SHOOTER_API UShooterLootSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay( UWorld& InWorld ) override;
+
+	/**
+	* Roll Plan's rarities and queue its items behind anything already queued. Server only
+	* @param Seed  Seeds the rarity rolls, so a plan can be rolled the same way again. 0 picks a random seed
+	*/
+	UFUNCTION( BlueprintCallable, Category = Loot )
+	void QueueLoot( const TArray<FShooterLootSpawn>& Plan, int32 Seed = 0 );
+
+	/* fraction of the queued items spawned so far; 1 when nothing is queued */
+	UFUNCTION( BlueprintPure, Category = Loot )
+	float GetProgress( ) const;
+
+	FORCEINLINE bool IsSpawning( ) const { return NextPending < Pending.Num( ); }
+
+	/* after each frame that spawned items */
+	UPROPERTY( BlueprintAssignable, Category = Loot )
+	FOnShooterLootProgress OnProgress;
+
+	/* once everything queued has spawned */
+	UPROPERTY( BlueprintAssignable, Category = Loot )
+	FOnShooterLootFinished OnFinished;
+
+	// FTickableGameObject
+	virtual void Tick( float DeltaTime ) override;
+	virtual bool IsTickable( ) const override;
+	virtual TStatId GetStatId( ) const override;
+	virtual UWorld* GetTickableGameObjectWorld( ) const override { return GetWorld( ); }
+
+private:
+	struct FPendingLoot
+	{
+		TSubclassOf<AItem> ItemClass;
+		FTransform Transform;
+		/* EIR_Max keeps the class's rarity */
+		EItemRarity Rarity;
+		int32 ItemCount;
+	};
+
+	/* pick a rarity for each of Plan's items, in Plan's order */
+	void RollRarities( const TArray<FShooterLootSpawn>& Plan, int32 Seed, TArray<EItemRarity>& OutRarities ) const;
+
+	void SpawnLoot( const FPendingLoot& Loot );
+
+	void FinishSpawning( );
+
+	void QueueBenchmark( int32 NumItems );
+
+	UPROPERTY( Config )
+	TArray<FShooterLootTable> RarityTables;
+
+	/* pickups the benchmark spawns, in turn; weapons roll from the "Weapon" table, the rest from "Default" */
+	UPROPERTY( Config )
+	TArray<TSoftClassPtr<AItem>> BenchmarkClasses;
+
+	/* queued items; NextPending onwards haven't spawned yet */
+	TArray<FPendingLoot> Pending;
+	int32 NextPending { 0 };
+
+	/* for the finish report, since the first item was queued */
+	double QueueStartSeconds { 0.0 };
+	double SpawnMs { 0.0 };
+	double MaxFrameMs { 0.0 };
+	int32 SpawnFrames { 0 };
+	int32 RarityCounts[static_cast<int32>( EItemRarity::EIR_Max ) + 1] { };
+
+	bool bBenchmarking { false };
+};
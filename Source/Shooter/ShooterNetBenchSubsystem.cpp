@@ -0,0 +1,203 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterNetBenchSubsystem.h"
+#include "Engine/GameInstance.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "GameFramework/GameModeBase.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Paths.h"
+#include "Item.h"
+#include "ShooterReplicationGraph.h"
+#include "Shooter.h"
+
+namespace
+{
+	const double ClientJoinTimeoutSeconds { 120.0 };
+	/* newly spawned items all send their first update before going dormant; don't time that */
+	const double SettleSeconds { 3.0 };
+	const double MeasureSeconds { 10.0 };
+	const float ItemSpacing { 400.f };
+}
+
+void UShooterNetBenchSubsystem::Initialize( FSubsystemCollectionBase& Collection )
+{
+	Super::Initialize( Collection );
+
+	FParse::Value( FCommandLine::Get( ), TEXT( "NetItemBenchmark=" ), MaxItems );
+	FParse::Value( FCommandLine::Get( ), TEXT( "NetBenchClients=" ), NumClients );
+	FParse::Value( FCommandLine::Get( ), TEXT( "NetBenchSteps=" ), NumSteps );
+	NumSteps = FMath::Max( NumSteps, 1 );
+}
+
+void UShooterNetBenchSubsystem::Deinitialize( )
+{
+	for ( FProcHandle& Client : ClientProcesses )
+	{
+		if ( FPlatformProcess::IsProcRunning( Client ) )
+		{
+			FPlatformProcess::TerminateProc( Client );
+		}
+		FPlatformProcess::CloseProc( Client );
+	}
+	ClientProcesses.Reset( );
+
+	Super::Deinitialize( );
+}
+
+void UShooterNetBenchSubsystem::OnLevelStarted( UWorld* World )
+{
+	if ( MaxItems <= 0 || Phase != EBenchPhase::Idle )
+	{
+		return;
+	}
+	if ( World->GetNetMode( ) != NM_ListenServer && World->GetNetMode( ) != NM_DedicatedServer )
+	{
+		UE_LOG( LogShooter, Error, TEXT( "NetItemBenchmark needs a server, e.g. Factory?listen" ) );
+		return;
+	}
+	if ( GetReplicationGraph( ) == nullptr )
+	{
+		UE_LOG( LogShooter, Warning, TEXT( "NetItemBenchmark: the net driver isn't using ShooterReplicationGraph, times will read 0" ) );
+	}
+
+	const AGameModeBase* GameMode = World->GetAuthGameMode( );
+	const AActor* PlayerStart = GameMode ? GameMode->FindPlayerStart( nullptr ) : nullptr;
+	GridOrigin = PlayerStart ? PlayerStart->GetActorLocation( ) : FVector::ZeroVector;
+
+	const FString ClientParams { FString::Printf( TEXT( "\"%s\" 127.0.0.1:%d -game -nullrhi -nosound -unattended" ),
+		*FPaths::ConvertRelativePathToFull( FPaths::GetProjectFilePath( ) ), World->URL.Port ) };
+	for ( int32 Client = 0; Client < NumClients; Client++ )
+	{
+		const FString Params { ClientParams + FString::Printf( TEXT( " -log=NetBenchClient%d.log" ), Client ) };
+		FProcHandle Handle { FPlatformProcess::CreateProc( FPlatformProcess::ExecutablePath( ), *Params, true, true, true, nullptr, 0, nullptr, nullptr ) };
+		if ( Handle.IsValid( ) )
+		{
+			ClientProcesses.Add( Handle );
+		}
+	}
+
+	Results.Reset( );
+	Phase = EBenchPhase::WaitingForClients;
+	PhaseStartSeconds = FPlatformTime::Seconds( );
+	UE_LOG( LogShooter, Log, TEXT( "NetItemBenchmark: launched %d clients, up to %d items in %d steps" ), ClientProcesses.Num( ), MaxItems, NumSteps );
+}
+
+bool UShooterNetBenchSubsystem::IsTickable( ) const
+{
+	return !IsTemplate( ) && Phase != EBenchPhase::Idle;
+}
+
+TStatId UShooterNetBenchSubsystem::GetStatId( ) const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT( UShooterNetBenchSubsystem, STATGROUP_Tickables );
+}
+
+UWorld* UShooterNetBenchSubsystem::GetTickableGameObjectWorld( ) const
+{
+	return GetGameInstance( )->GetWorld( );
+}
+
+UShooterReplicationGraph* UShooterNetBenchSubsystem::GetReplicationGraph( ) const
+{
+	const UWorld* World = GetGameInstance( )->GetWorld( );
+	const UNetDriver* NetDriver = World ? World->GetNetDriver( ) : nullptr;
+	return NetDriver ? NetDriver->GetReplicationDriver<UShooterReplicationGraph>( ) : nullptr;
+}
+
+void UShooterNetBenchSubsystem::Tick( float DeltaTime )
+{
+	const double Now { FPlatformTime::Seconds( ) };
+	const double PhaseSeconds { Now - PhaseStartSeconds };
+	const UWorld* World = GetGameInstance( )->GetWorld( );
+	const UNetDriver* NetDriver = World ? World->GetNetDriver( ) : nullptr;
+	const int32 ConnectedClients { NetDriver ? NetDriver->ClientConnections.Num( ) : 0 };
+
+	switch ( Phase )
+	{
+	case EBenchPhase::WaitingForClients:
+		if ( ConnectedClients >= NumClients || PhaseSeconds > ClientJoinTimeoutSeconds )
+		{
+			if ( ConnectedClients < NumClients )
+			{
+				UE_LOG( LogShooter, Warning, TEXT( "NetItemBenchmark: only %d of %d clients joined" ), ConnectedClients, NumClients );
+			}
+			CurrentStep = 0;
+			SpawnItemsUpTo( 0 );
+			Phase = EBenchPhase::Settling;
+			PhaseStartSeconds = Now;
+		}
+		break;
+
+	case EBenchPhase::Settling:
+		if ( PhaseSeconds >= SettleSeconds )
+		{
+			if ( UShooterReplicationGraph* Graph = GetReplicationGraph( ) )
+			{
+				double TotalMs, MaxMs;
+				int32 Frames;
+				Graph->ConsumeReplicateTimes( TotalMs, MaxMs, Frames );
+			}
+			Phase = EBenchPhase::Measuring;
+			PhaseStartSeconds = Now;
+		}
+		break;
+
+	case EBenchPhase::Measuring:
+		if ( PhaseSeconds >= MeasureSeconds )
+		{
+			double TotalMs { 0.0 };
+			double MaxMs { 0.0 };
+			int32 Frames { 0 };
+			if ( UShooterReplicationGraph* Graph = GetReplicationGraph( ) )
+			{
+				Graph->ConsumeReplicateTimes( TotalMs, MaxMs, Frames );
+			}
+			const double AvgMs { TotalMs / FMath::Max( Frames, 1 ) };
+			const FString Row { FString::Printf( TEXT( "%d,%d,%d,%.3f,%.3f,%.4f" ),
+				NumSpawnedItems, ConnectedClients, Frames, AvgMs, MaxMs, AvgMs / FMath::Max( ConnectedClients, 1 ) ) };
+			UE_LOG( LogShooter, Log, TEXT( "NetItemBenchmark: %s" ), *Row );
+			Results += Row + TEXT( "\n" );
+
+			if ( ++CurrentStep > NumSteps )
+			{
+				FinishBenchmark( );
+				break;
+			}
+			SpawnItemsUpTo( FMath::DivideAndRoundUp( MaxItems * CurrentStep, NumSteps ) );
+			Phase = EBenchPhase::Settling;
+			PhaseStartSeconds = Now;
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+void UShooterNetBenchSubsystem::SpawnItemsUpTo( int32 Count )
+{
+	UWorld* World = GetGameInstance( )->GetWorld( );
+	const int32 GridSide { FMath::CeilToInt( FMath::Sqrt( static_cast<float>( MaxItems ) ) ) };
+	const FVector Corner { GridOrigin - FVector( GridSide * ItemSpacing * 0.5f, GridSide * ItemSpacing * 0.5f, 0.f ) };
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	// fill the grid in the same order every step, so each step adds to the last one's items
+	for ( ; NumSpawnedItems < Count; NumSpawnedItems++ )
+	{
+		const FVector Location { Corner + FVector( ( NumSpawnedItems % GridSide ) * ItemSpacing, ( NumSpawnedItems / GridSide ) * ItemSpacing, 0.f ) };
+		World->SpawnActor<AItem>( AItem::StaticClass( ), Location, FRotator::ZeroRotator, SpawnParams );
+	}
+}
+
+void UShooterNetBenchSubsystem::FinishBenchmark( )
+{
+	const FString Filename { FPaths::ProjectSavedDir( ) / TEXT( "NetBench" ) / TEXT( "ItemRelevancy.csv" ) };
+	SaveBenchmarkResults( TEXT( "NetItemBenchmark" ), Filename, TEXT( "Items,Clients,Frames,AvgReplicateMs,MaxReplicateMs,AvgReplicateMsPerClient\n" ), Results, false );
+
+	Phase = EBenchPhase::Idle;
+	FinishBenchmarkRun( );
+}
@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+#include "ShooterLevelSubsystem.h"
+#include "ShooterNetBenchSubsystem.generated.h"
+
+/**
+ * Local item relevancy benchmark. Run as a listen server, e.g.
+ *
+ * Factory?listen -NetItemBenchmark=20000 -NetBenchClients=4 -nullrhi
+ *
+ * Launches the clients as headless local processes and waits for them to join. It then raises the
+ * world's item count in steps up to the requested total and times the server's ServerReplicateActors
+ * at each step. Writes Saved/NetBench/ItemRelevancy.csv and exits.
+ */
+UCLASS()
+class SHOOTER_API UShooterNetBenchSubsystem : public UShooterLevelSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize( FSubsystemCollectionBase& Collection ) override;
+	virtual void Deinitialize( ) override;
+
+	/* launch the clients once the server's level is up; called by the game mode */
+	virtual void OnLevelStarted( UWorld* World ) override;
+
+	// FTickableGameObject
+	virtual void Tick( float DeltaTime ) override;
+	virtual bool IsTickable( ) const override;
+	virtual TStatId GetStatId( ) const override;
+	virtual UWorld* GetTickableGameObjectWorld( ) const override;
+
+private:
+	enum class EBenchPhase : uint8
+	{
+		Idle,
+		WaitingForClients,
+		Settling,
+		Measuring
+	};
+
+	/* spawn items on a grid around the player start until there are Count */
+	void SpawnItemsUpTo( int32 Count );
+
+	void FinishBenchmark( );
+
+	class UShooterReplicationGraph* GetReplicationGraph( ) const;
+
+	EBenchPhase Phase { EBenchPhase::Idle };
+	double PhaseStartSeconds { 0.0 };
+
+	int32 MaxItems { 0 };
+	int32 NumClients { 4 };
+	int32 NumSteps { 5 };
+	int32 CurrentStep { 0 };
+
+	FVector GridOrigin { FVector::ZeroVector };
+	int32 NumSpawnedItems { 0 };
+
+	TArray<FProcHandle> ClientProcesses;
+
+	FString Results;
+};
@@ -0,0 +1,369 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterPerfAuditCommandlet.h"
+#include "Shooter.h"
+
+#if WITH_EDITOR
+#include "AssetRegistryModule.h"
+#include "Components/SceneCaptureComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Components/WidgetComponent.h"
+#include "Dom/JsonObject.h"
+#include "EdGraph/EdGraph.h"
+#include "Engine/Blueprint.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "Engine/Level.h"
+#include "Engine/SCS_Node.h"
+#include "Engine/SimpleConstructionScript.h"
+#include "Engine/World.h"
+#include "K2Node_CallFunction.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonWriter.h"
+
+namespace
+{
+	enum class EPerfHazard : uint8
+	{
+		EPH_IdleTick,
+		EPH_SkeletalMeshStaticProp,
+		EPH_PerActorWidget,
+		EPH_EveryFrameCapture,
+		EPH_BlueprintComponentTick,
+		EPH_UnpooledParticleSpawn,
+
+		EPH_Max
+	};
+
+	const TCHAR* const HazardNames[] {
+		TEXT( "IdleTick" ),
+		TEXT( "SkeletalMeshStaticProp" ),
+		TEXT( "PerActorWidget" ),
+		TEXT( "EveryFrameCapture" ),
+		TEXT( "BlueprintComponentTick" ),
+		TEXT( "UnpooledParticleSpawn" ) };
+
+	// rough relative per-frame cost of one occurrence, used to rank the report
+	const float HazardWeights[] { 3.f, 3.f, 4.f, 10.f, 5.f, 2.f };
+
+	static_assert( UE_ARRAY_COUNT( HazardNames ) == static_cast<int32>( EPerfHazard::EPH_Max ), "Name every hazard" );
+	static_assert( UE_ARRAY_COUNT( HazardWeights ) == static_cast<int32>( EPerfHazard::EPH_Max ), "Weigh every hazard" );
+
+	struct FPerfFinding
+	{
+		EPerfHazard Hazard;
+		FString Asset;
+		FString Object;
+		FString Detail;
+		int32 Count;
+
+		float GetScore( ) const { return HazardWeights[static_cast<int32>( Hazard )] * Count; }
+	};
+
+	bool IsTickingByDefault( const FTickFunction& TickFunction )
+	{
+		return TickFunction.bCanEverTick && TickFunction.bStartWithTickEnabled;
+	}
+
+	bool HasBlueprintTick( const UClass* Class, FName ReceiveTickName )
+	{
+		return Class->IsFunctionImplementedInScript( ReceiveTickName );
+	}
+
+	class FPerfAudit
+	{
+	public:
+		void AuditActor( const AActor* Actor, const FString& Asset )
+		{
+			const UClass* Class = Actor->GetClass( );
+			if ( IsTickingByDefault( Actor->PrimaryActorTick ) && !HasBlueprintTick( Class, GET_FUNCTION_NAME_CHECKED( AActor, ReceiveTick ) ) )
+			{
+				// native Tick bodies can't be inspected; list the class so it can be checked by hand
+				Add( EPerfHazard::EPH_IdleTick, Asset, Class->GetName( ),
+					FString::Printf( TEXT( "ticks with no Blueprint Tick; check %s::Tick" ), *GetNativeClass( Class )->GetName( ) ) );
+			}
+			for ( const UActorComponent* Component : Actor->GetComponents( ) )
+			{
+				if ( Component )
+				{
+					AuditComponent( Component, Asset, Class->GetName( ) );
+				}
+			}
+		}
+
+		void AuditComponent( const UActorComponent* Component, const FString& Asset, const FString& OwnerName )
+		{
+			const FString Object { OwnerName / Component->GetName( ) };
+			const UClass* Class = Component->GetClass( );
+
+			if ( Cast<UWidgetComponent>( Component ) )
+			{
+				Add( EPerfHazard::EPH_PerActorWidget, Asset, Object, TEXT( "widget component on every instance" ) );
+			}
+			if ( const USceneCaptureComponent* Capture = Cast<USceneCaptureComponent>( Component ) )
+			{
+				if ( Capture->bCaptureEveryFrame )
+				{
+					Add( EPerfHazard::EPH_EveryFrameCapture, Asset, Object, TEXT( "bCaptureEveryFrame" ) );
+				}
+			}
+			if ( const USkeletalMeshComponent* SkeletalMesh = Cast<USkeletalMeshComponent>( Component ) )
+			{
+				const bool bNoAnimation { SkeletalMesh->GetAnimationMode( ) == EAnimationMode::AnimationBlueprint
+					? SkeletalMesh->AnimClass == nullptr
+					: SkeletalMesh->AnimationData.AnimToPlay == nullptr };
+				if ( SkeletalMesh->SkeletalMesh && bNoAnimation && !SkeletalMesh->BodyInstance.bSimulatePhysics )
+				{
+					Add( EPerfHazard::EPH_SkeletalMeshStaticProp, Asset, Object,
+						FString::Printf( TEXT( "%s has no animation or physics" ), *SkeletalMesh->SkeletalMesh->GetName( ) ) );
+				}
+			}
+			if ( Cast<UBlueprintGeneratedClass>( Class ) && IsTickingByDefault( Component->PrimaryComponentTick ) )
+			{
+				const bool bScriptTick { HasBlueprintTick( Class, GET_FUNCTION_NAME_CHECKED( UActorComponent, ReceiveTick ) ) };
+				Add( EPerfHazard::EPH_BlueprintComponentTick, Asset, Object,
+					bScriptTick ? TEXT( "Blueprint Tick runs every frame" ) : TEXT( "tick enabled with no Blueprint Tick" ) );
+			}
+		}
+
+		void AuditBlueprint( UBlueprint* Blueprint, const FString& Asset )
+		{
+			const UClass* GeneratedClass = Blueprint->GeneratedClass;
+			const UObject* Defaults = GeneratedClass ? GeneratedClass->GetDefaultObject( ) : nullptr;
+			if ( const AActor* ActorDefaults = Cast<AActor>( Defaults ) )
+			{
+				AuditActor( ActorDefaults, Asset );
+			}
+			else if ( const UActorComponent* ComponentDefaults = Cast<UActorComponent>( Defaults ) )
+			{
+				AuditComponent( ComponentDefaults, Asset, GeneratedClass->GetName( ) );
+			}
+
+			// components added in the Blueprint editor aren't on the CDO
+			if ( Blueprint->SimpleConstructionScript && GeneratedClass )
+			{
+				for ( const USCS_Node* Node : Blueprint->SimpleConstructionScript->GetAllNodes( ) )
+				{
+					if ( Node && Node->ComponentTemplate )
+					{
+						AuditComponent( Node->ComponentTemplate, Asset, GeneratedClass->GetName( ) );
+					}
+				}
+			}
+
+			AuditGraphs( Blueprint, Asset );
+		}
+
+		void AuditGraphs( UBlueprint* Blueprint, const FString& Asset )
+		{
+			TArray<UEdGraph*> Graphs;
+			Blueprint->GetAllGraphs( Graphs );
+			for ( const UEdGraph* Graph : Graphs )
+			{
+				TArray<UK2Node_CallFunction*> CallNodes;
+				Graph->GetNodesOfClass( CallNodes );
+				for ( const UK2Node_CallFunction* CallNode : CallNodes )
+				{
+					const UFunction* Function = CallNode->GetTargetFunction( );
+					if ( Function == nullptr || Function->GetOwnerClass( ) != UGameplayStatics::StaticClass( )
+						|| !Function->GetName( ).StartsWith( TEXT( "SpawnEmitter" ) ) )
+					{
+						continue;
+					}
+					const UEdGraphPin* PoolingPin = CallNode->FindPin( TEXT( "PoolingMethod" ) );
+					const bool bPooled { PoolingPin && ( PoolingPin->LinkedTo.Num( ) > 0
+						|| ( !PoolingPin->DefaultValue.IsEmpty( ) && PoolingPin->DefaultValue != TEXT( "None" ) ) ) };
+					if ( !bPooled )
+					{
+						Add( EPerfHazard::EPH_UnpooledParticleSpawn, Asset, Graph->GetName( ) / Function->GetName( ), TEXT( "PoolingMethod is None" ) );
+					}
+				}
+			}
+		}
+
+		/* highest score first; ties in a fixed order so reports diff cleanly between builds */
+		void Sort( )
+		{
+			Findings.Sort( []( const FPerfFinding& A, const FPerfFinding& B )
+			{
+				if ( A.GetScore( ) != B.GetScore( ) )
+				{
+					return A.GetScore( ) > B.GetScore( );
+				}
+				if ( A.Hazard != B.Hazard )
+				{
+					return A.Hazard < B.Hazard;
+				}
+				if ( A.Asset != B.Asset )
+				{
+					return A.Asset < B.Asset;
+				}
+				return A.Object < B.Object;
+			} );
+		}
+
+		FString ToCsv( ) const
+		{
+			FString Csv { TEXT( "Rank,Score,Hazard,Count,Asset,Object,Detail\n" ) };
+			for ( int32 Rank = 0; Rank < Findings.Num( ); Rank++ )
+			{
+				const FPerfFinding& Finding = Findings[Rank];
+				Csv += FString::Printf( TEXT( "%d,%.1f,%s,%d,\"%s\",\"%s\",\"%s\"\n" ),
+					Rank + 1, Finding.GetScore( ), HazardNames[static_cast<int32>( Finding.Hazard )], Finding.Count,
+					*Finding.Asset.Replace( TEXT( "\"" ), TEXT( "\"\"" ) ),
+					*Finding.Object.Replace( TEXT( "\"" ), TEXT( "\"\"" ) ),
+					*Finding.Detail.Replace( TEXT( "\"" ), TEXT( "\"\"" ) ) );
+			}
+			return Csv;
+		}
+
+		FString ToJson( ) const
+		{
+			FString Json;
+			TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create( &Json );
+			Writer->WriteArrayStart( );
+			for ( int32 Rank = 0; Rank < Findings.Num( ); Rank++ )
+			{
+				const FPerfFinding& Finding = Findings[Rank];
+				Writer->WriteObjectStart( );
+				Writer->WriteValue( TEXT( "rank" ), Rank + 1 );
+				Writer->WriteValue( TEXT( "score" ), Finding.GetScore( ) );
+				Writer->WriteValue( TEXT( "hazard" ), HazardNames[static_cast<int32>( Finding.Hazard )] );
+				Writer->WriteValue( TEXT( "count" ), Finding.Count );
+				Writer->WriteValue( TEXT( "asset" ), Finding.Asset );
+				Writer->WriteValue( TEXT( "object" ), Finding.Object );
+				Writer->WriteValue( TEXT( "detail" ), Finding.Detail );
+				Writer->WriteObjectEnd( );
+			}
+			Writer->WriteArrayEnd( );
+			Writer->Close( );
+			return Json;
+		}
+
+		const TArray<FPerfFinding>& GetFindings( ) const { return Findings; }
+
+	private:
+		/* repeats of the same hazard on the same object in the same asset are counted, not listed */
+		void Add( EPerfHazard Hazard, const FString& Asset, const FString& Object, const FString& Detail )
+		{
+			const FString Key { FString::Printf( TEXT( "%d|%s|%s" ), static_cast<int32>( Hazard ), *Asset, *Object ) };
+			if ( const int32* Existing = FindingIndex.Find( Key ) )
+			{
+				Findings[*Existing].Count++;
+				return;
+			}
+			FindingIndex.Add( Key, Findings.Num( ) );
+			Findings.Add( { Hazard, Asset, Object, Detail, 1 } );
+		}
+
+		static const UClass* GetNativeClass( const UClass* Class )
+		{
+			while ( Class && !Class->HasAnyClassFlags( CLASS_Native ) )
+			{
+				Class = Class->GetSuperClass( );
+			}
+			return Class;
+		}
+
+		TArray<FPerfFinding> Findings;
+		TMap<FString, int32> FindingIndex;
+	};
+}
+#endif // WITH_EDITOR
+
+UShooterPerfAuditCommandlet::UShooterPerfAuditCommandlet( )
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UShooterPerfAuditCommandlet::Main( const FString& Params )
+{
+#if WITH_EDITOR
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> ParamValues;
+	ParseCommandLine( *Params, Tokens, Switches, ParamValues );
+
+	const bool bJson { Switches.Contains( TEXT( "Json" ) ) };
+	const FString Root { ParamValues.Contains( TEXT( "Root" ) ) ? ParamValues[TEXT( "Root" )] : FString( TEXT( "/Game" ) ) };
+	const FString OutFile { ParamValues.Contains( TEXT( "Out" ) )
+		? ParamValues[TEXT( "Out" )]
+		: FPaths::ProjectSavedDir( ) / TEXT( "PerfAudit" ) / ( bJson ? TEXT( "PerfAudit.json" ) : TEXT( "PerfAudit.csv" ) ) };
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>( TEXT( "AssetRegistry" ) ).Get( );
+	AssetRegistry.SearchAllAssets( true );
+
+	FARFilter Filter;
+	Filter.PackagePaths.Add( FName( *Root ) );
+	Filter.bRecursivePaths = true;
+	Filter.ClassNames.Add( UBlueprint::StaticClass( )->GetFName( ) );
+	Filter.ClassNames.Add( UWorld::StaticClass( )->GetFName( ) );
+	Filter.bRecursiveClasses = true;
+
+	TArray<FAssetData> Assets;
+	AssetRegistry.GetAssets( Filter, Assets );
+	// same order every run, whatever order the registry found them in
+	Assets.Sort( []( const FAssetData& A, const FAssetData& B ) { return A.ObjectPath.LexicalLess( B.ObjectPath ); } );
+	UE_LOG( LogShooter, Display, TEXT( "Auditing %d maps and Blueprints under %s" ), Assets.Num( ), *Root );
+
+	FPerfAudit Audit;
+	int32 NumLoaded { 0 };
+	for ( const FAssetData& AssetData : Assets )
+	{
+		const FString AssetPath { AssetData.PackageName.ToString( ) };
+		UObject* Asset = AssetData.GetAsset( );
+		if ( UBlueprint* Blueprint = Cast<UBlueprint>( Asset ) )
+		{
+			Audit.AuditBlueprint( Blueprint, AssetPath );
+		}
+		else if ( UWorld* World = Cast<UWorld>( Asset ) )
+		{
+			if ( ULevel* Level = World->PersistentLevel )
+			{
+				for ( const AActor* Actor : Level->Actors )
+				{
+					if ( Actor )
+					{
+						Audit.AuditActor( Actor, AssetPath );
+					}
+				}
+				if ( UBlueprint* LevelScript = Level->GetLevelScriptBlueprint( true ) )
+				{
+					Audit.AuditGraphs( LevelScript, AssetPath );
+				}
+			}
+		}
+
+		// keep memory flat on big projects
+		if ( ++NumLoaded % 32 == 0 )
+		{
+			CollectGarbage( RF_NoFlags );
+		}
+	}
+
+	Audit.Sort( );
+	const FString Report { bJson ? Audit.ToJson( ) : Audit.ToCsv( ) };
+	if ( !FFileHelper::SaveStringToFile( Report, *OutFile ) )
+	{
+		UE_LOG( LogShooter, Error, TEXT( "Couldn't write perf audit to %s" ), *OutFile );
+		return 1;
+	}
+
+	const TArray<FPerfFinding>& Findings = Audit.GetFindings( );
+	for ( int32 Rank = 0; Rank < FMath::Min( Findings.Num( ), 10 ); Rank++ )
+	{
+		UE_LOG( LogShooter, Display, TEXT( "%2d. %-24s x%-4d %s %s" ), Rank + 1,
+			HazardNames[static_cast<int32>( Findings[Rank].Hazard )], Findings[Rank].Count, *Findings[Rank].Asset, *Findings[Rank].Object );
+	}
+	UE_LOG( LogShooter, Display, TEXT( "Wrote %d findings to %s" ), Findings.Num( ), *OutFile );
+	return 0;
+#else
+	UE_LOG( LogShooter, Error, TEXT( "ShooterPerfAudit needs an editor build" ) );
+	return 1;
+#endif // WITH_EDITOR
+}
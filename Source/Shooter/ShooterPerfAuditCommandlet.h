@@ -0,0 +1,25 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ShooterPerfAuditCommandlet.generated.h"
+
+/**
+ * Loads every map and Blueprint under a content root and writes a ranked list of perf hazards:
+ * idle ticking, skeletal meshes used as static props, per-actor widget components, every-frame
+ * scene captures, ticking Blueprint components and unpooled particle spawns.
+ *
+ * UE4Editor-Cmd Shooter.uproject -run=ShooterPerfAudit [-Root=/Game] [-Out=<file>] [-Json]
+ */
+UCLASS()
+class UShooterPerfAuditCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UShooterPerfAuditCommandlet( );
+
+	virtual int32 Main( const FString& Params ) override;
+};
@@ -0,0 +1,327 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterPerfCaptureGameMode.h"
+#include "Engine/World.h"
+#include "Kismet/GameplayStatics.h"
+#include "LevelSequence.h"
+#include "LevelSequenceActor.h"
+#include "LevelSequencePlayer.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "MovieScene.h"
+#include "MovieSceneSection.h"
+#include "MovieSceneTrack.h"
+#include "RenderCore.h"
+#include "TimerManager.h"
+#include "Engine/Engine.h"
+#include "ShooterAnimInstance.h"
+#include "ShooterLevelSubsystem.h"
+#include "Shooter.h"
+#if STATS
+#include "Stats/StatsData.h"
+#endif
+
+namespace
+{
+	enum EPerfMarker
+	{
+		EPMK_FrameStart,
+		EPMK_PhysicsStart,
+		EPMK_PhysicsEnd,
+		EPMK_FrameEnd
+	};
+
+	const TCHAR* const MetricNames[] { TEXT( "GameThread" ), TEXT( "Tick" ), TEXT( "Physics" ), TEXT( "Anim" ) };
+
+	/* every skeletal mesh's animation work this frame: game thread update plus pose evaluation, wherever it ran */
+	float GetAnimCostMs( )
+	{
+#if STATS
+		static const FName AnimGameThreadName { TEXT( "STAT_AnimGameThreadTime" ) };
+		static const FName AnimEvaluationName { TEXT( "STAT_PerformAnimEvaluation" ) };
+
+		const FGameThreadStatsData* StatsData = FLatestGameThreadStatsData::Get( ).Latest;
+		if ( StatsData )
+		{
+			float CostMs { 0.f };
+			for ( const FActiveStatGroupInfo& Group : StatsData->ActiveStatGroups )
+			{
+				for ( const FComplexStatMessage& Stat : Group.FlatAggregate )
+				{
+					const FName StatName { Stat.GetShortName( ) };
+					if ( StatName == AnimGameThreadName || StatName == AnimEvaluationName )
+					{
+						CostMs += static_cast<float>( FPlatformTime::ToMilliseconds64( Stat.GetValue_Duration( EComplexStatField::IncAve ) ) );
+					}
+				}
+			}
+			return CostMs;
+		}
+#endif
+		// no stats in this build; only the shooter anim instances time themselves
+		return UShooterAnimInstance::GetFrameUpdateCostMs( );
+	}
+
+#if STATS
+	/* "stat Anim" toggles, so look before sending it */
+	bool IsAnimStatGroupShown( )
+	{
+		static const FName AnimGroupName { TEXT( "STATGROUP_Anim" ) };
+
+		const FGameThreadStatsData* StatsData = FLatestGameThreadStatsData::Get( ).Latest;
+		return StatsData && StatsData->GroupNames.Contains( AnimGroupName );
+	}
+#endif
+
+	/* nearest-rank percentile of already sorted samples */
+	float GetPercentile( const TArray<float>& Sorted, float Percentile )
+	{
+		const int32 Rank { FMath::CeilToInt( Percentile * Sorted.Num( ) ) - 1 };
+		return Sorted[FMath::Clamp( Rank, 0, Sorted.Num( ) - 1 )];
+	}
+}
+
+void FShooterPerfMarkerTickFunction::ExecuteTick( float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent )
+{
+	if ( Target && !Target->IsPendingKill( ) )
+	{
+		Target->MarkTickGroup( Marker );
+	}
+}
+
+FString FShooterPerfMarkerTickFunction::DiagnosticMessage( )
+{
+	return FString::Printf( TEXT( "FShooterPerfMarkerTickFunction[%d]" ), Marker );
+}
+
+AShooterPerfCaptureGameMode::AShooterPerfCaptureGameMode( ) :
+	WarmupSeconds( 3.f ),
+	bCapturing( false ),
+	bShowedAnimStats( false )
+{
+	DefaultSequence = TSoftObjectPtr<ULevelSequence>( FSoftObjectPath( TEXT( "/Game/Sequences/FlythroughSequence01.FlythroughSequence01" ) ) );
+
+	// the sequence owns the camera; nobody needs a character
+	bStartPlayersAsSpectators = true;
+
+	const ETickingGroup MarkerGroups[] { TG_PrePhysics, TG_StartPhysics, TG_PostPhysics, TG_PostUpdateWork };
+	for ( int32 Marker = 0; Marker < UE_ARRAY_COUNT( MarkerTicks ); Marker++ )
+	{
+		MarkerTicks[Marker].Marker = Marker;
+		MarkerTicks[Marker].TickGroup = MarkerGroups[Marker];
+		MarkerTicks[Marker].EndTickGroup = MarkerGroups[Marker];
+		MarkerTicks[Marker].bCanEverTick = true;
+		MarkerTicks[Marker].bStartWithTickEnabled = true;
+		// start markers want to run before the rest of their group, the end marker after it
+		MarkerTicks[Marker].bHighPriority = Marker != EPMK_FrameEnd;
+		MarkerCycles[Marker] = 0;
+	}
+}
+
+void AShooterPerfCaptureGameMode::InitGame( const FString& MapName, const FString& Options, FString& ErrorMessage )
+{
+	Super::InitGame( MapName, Options, ErrorMessage );
+
+	RequestedSequence = UGameplayStatics::ParseOption( Options, TEXT( "Sequence" ) );
+	FParse::Value( FCommandLine::Get( ), TEXT( "PerfSequence=" ), RequestedSequence );
+}
+
+void AShooterPerfCaptureGameMode::StartPlay( )
+{
+	Super::StartPlay( );
+
+	for ( FShooterPerfMarkerTickFunction& MarkerTick : MarkerTicks )
+	{
+		MarkerTick.Target = this;
+		MarkerTick.RegisterTickFunction( GetWorld( )->PersistentLevel );
+	}
+
+	Sequence = RequestedSequence.IsEmpty( )
+		? DefaultSequence.LoadSynchronous( )
+		: LoadObject<ULevelSequence>( nullptr, *FString::Printf( TEXT( "/Game/Sequences/%s.%s" ), *RequestedSequence, *RequestedSequence ) );
+	if ( Sequence == nullptr || Sequence->GetMovieScene( ) == nullptr )
+	{
+		UE_LOG( LogShooter, Error, TEXT( "Perf capture couldn't load sequence '%s'" ), *RequestedSequence );
+		UShooterLevelSubsystem::FinishBenchmarkRun( false );
+		return;
+	}
+
+	FTimerHandle WarmupTimer;
+	GetWorldTimerManager( ).SetTimer( WarmupTimer, this, &AShooterPerfCaptureGameMode::StartSequence, FMath::Max( WarmupSeconds, 0.01f ) );
+}
+
+void AShooterPerfCaptureGameMode::EndPlay( const EEndPlayReason::Type EndPlayReason )
+{
+	for ( FShooterPerfMarkerTickFunction& MarkerTick : MarkerTicks )
+	{
+		MarkerTick.UnRegisterTickFunction( );
+	}
+
+	Super::EndPlay( EndPlayReason );
+}
+
+void AShooterPerfCaptureGameMode::StartSequence( )
+{
+	BuildSections( );
+
+	ALevelSequenceActor* SequenceActor { nullptr };
+	SequencePlayer = ULevelSequencePlayer::CreateLevelSequencePlayer( GetWorld( ), Sequence, FMovieSceneSequencePlaybackSettings( ), SequenceActor );
+	if ( SequencePlayer == nullptr )
+	{
+		UE_LOG( LogShooter, Error, TEXT( "Perf capture couldn't create a player for %s" ), *Sequence->GetName( ) );
+		UShooterLevelSubsystem::FinishBenchmarkRun( false );
+		return;
+	}
+
+#if STATS
+	// the anim stat group only reaches the game thread while it's shown
+	bShowedAnimStats = !IsAnimStatGroupShown( );
+	if ( bShowedAnimStats )
+	{
+		GEngine->Exec( GetWorld( ), TEXT( "stat Anim" ) );
+	}
+#endif
+
+	SequencePlayer->OnFinished.AddDynamic( this, &AShooterPerfCaptureGameMode::OnSequenceFinished );
+	SequencePlayer->Play( );
+	bCapturing = true;
+
+	UE_LOG( LogShooter, Log, TEXT( "Perf capture: playing %s in %d sections" ), *Sequence->GetName( ), Sections.Num( ) );
+}
+
+void AShooterPerfCaptureGameMode::OnSequenceFinished( )
+{
+	bCapturing = false;
+	WriteSummary( );
+
+#if STATS
+	if ( bShowedAnimStats )
+	{
+		GEngine->Exec( GetWorld( ), TEXT( "stat Anim" ) );
+		bShowedAnimStats = false;
+	}
+#endif
+
+	UShooterLevelSubsystem::FinishBenchmarkRun( );
+}
+
+void AShooterPerfCaptureGameMode::BuildSections( )
+{
+	Sections.Reset( );
+
+	const UMovieScene* MovieScene = Sequence->GetMovieScene( );
+	const FFrameNumber PlaybackStart { MovieScene->GetPlaybackRange( ).GetLowerBoundValue( ) };
+
+	for ( const FMovieSceneMarkedFrame& MarkedFrame : MovieScene->GetMarkedFrames( ) )
+	{
+		Sections.Add( { MarkedFrame.Label.IsEmpty( ) ? FString::Printf( TEXT( "Mark%d" ), Sections.Num( ) ) : MarkedFrame.Label, MarkedFrame.FrameNumber } );
+	}
+
+	if ( Sections.Num( ) == 0 )
+	{
+		if ( const UMovieSceneTrack* CameraCuts = MovieScene->GetCameraCutTrack( ) )
+		{
+			for ( const UMovieSceneSection* Cut : CameraCuts->GetAllSections( ) )
+			{
+				if ( Cut->HasStartFrame( ) )
+				{
+					Sections.Add( { FString::Printf( TEXT( "Cut%d" ), Sections.Num( ) ), Cut->GetInclusiveStartFrame( ) } );
+				}
+			}
+		}
+	}
+
+	Sections.Sort( []( const FCaptureSection& A, const FCaptureSection& B ) { return A.Start < B.Start; } );
+
+	// frames before the first mark still count
+	if ( Sections.Num( ) == 0 || Sections[0].Start > PlaybackStart )
+	{
+		Sections.Insert( { Sections.Num( ) == 0 ? FString( TEXT( "All" ) ) : FString( TEXT( "Start" ) ), PlaybackStart }, 0 );
+	}
+}
+
+AShooterPerfCaptureGameMode::FCaptureSection* AShooterPerfCaptureGameMode::GetCurrentSection( )
+{
+	const FFrameRate TickResolution { Sequence->GetMovieScene( )->GetTickResolution( ) };
+	const FFrameNumber CurrentFrame { SequencePlayer->GetCurrentTime( ).ConvertTo( TickResolution ).FloorToFrame( ) };
+
+	// sections are sorted and the first one starts at the playback start
+	for ( int32 Index = Sections.Num( ) - 1; Index > 0; Index-- )
+	{
+		if ( Sections[Index].Start <= CurrentFrame )
+		{
+			return &Sections[Index];
+		}
+	}
+	return Sections.Num( ) > 0 ? &Sections[0] : nullptr;
+}
+
+void AShooterPerfCaptureGameMode::MarkTickGroup( int32 Marker )
+{
+	MarkerCycles[Marker] = FPlatformTime::Cycles64( );
+
+	if ( Marker == EPMK_FrameEnd && bCapturing )
+	{
+		RecordFrame( );
+	}
+}
+
+void AShooterPerfCaptureGameMode::RecordFrame( )
+{
+	FCaptureSection* Section = GetCurrentSection( );
+	if ( Section == nullptr || !SequencePlayer->IsPlaying( ) )
+	{
+		return;
+	}
+
+	const uint64 TickCycles { ( MarkerCycles[EPMK_PhysicsStart] - MarkerCycles[EPMK_FrameStart] ) + ( MarkerCycles[EPMK_FrameEnd] - MarkerCycles[EPMK_PhysicsEnd] ) };
+	const uint64 PhysicsCycles { MarkerCycles[EPMK_PhysicsEnd] - MarkerCycles[EPMK_PhysicsStart] };
+
+	// GGameThreadTime is the previous frame's, which is fine for a distribution
+	Section->Samples[EPM_GameThread].Add( FPlatformTime::ToMilliseconds( GGameThreadTime ) );
+	Section->Samples[EPM_Tick].Add( static_cast<float>( FPlatformTime::ToMilliseconds64( TickCycles ) ) );
+	Section->Samples[EPM_Physics].Add( static_cast<float>( FPlatformTime::ToMilliseconds64( PhysicsCycles ) ) );
+	Section->Samples[EPM_Anim].Add( GetAnimCostMs( ) );
+}
+
+void AShooterPerfCaptureGameMode::WriteSummary( ) const
+{
+	FString Csv { TEXT( "Section,Frames,Metric,AvgMs,P50Ms,P90Ms,P99Ms,MaxMs\n" ) };
+	for ( const FCaptureSection& Section : Sections )
+	{
+		for ( int32 Metric = 0; Metric < EPM_Max; Metric++ )
+		{
+			TArray<float> Sorted { Section.Samples[Metric] };
+			if ( Sorted.Num( ) == 0 )
+			{
+				continue;
+			}
+			Sorted.Sort( );
+
+			float Total { 0.f };
+			for ( const float Sample : Sorted )
+			{
+				Total += Sample;
+			}
+
+			const FString Row { FString::Printf( TEXT( "%s,%d,%s,%.3f,%.3f,%.3f,%.3f,%.3f" ),
+				*Section.Label, Sorted.Num( ), MetricNames[Metric], Total / Sorted.Num( ),
+				GetPercentile( Sorted, 0.5f ), GetPercentile( Sorted, 0.9f ), GetPercentile( Sorted, 0.99f ), Sorted.Last( ) ) };
+			UE_LOG( LogShooter, Log, TEXT( "Perf capture: %s" ), *Row );
+			Csv += Row + TEXT( "\n" );
+		}
+	}
+
+	const FString Filename { FPaths::ProjectSavedDir( ) / TEXT( "PerfCapture" )
+		/ FString::Printf( TEXT( "%s_%s.csv" ), *UWorld::RemovePIEPrefix( GetWorld( )->GetMapName( ) ), *Sequence->GetName( ) ) };
+	if ( FFileHelper::SaveStringToFile( Csv, *Filename ) )
+	{
+		UE_LOG( LogShooter, Log, TEXT( "Perf capture written to %s" ), *Filename );
+	}
+	else
+	{
+		UE_LOG( LogShooter, Warning, TEXT( "Perf capture couldn't write %s" ), *Filename );
+	}
+}
@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ShooterGameModeBase.h"
+#include "Engine/EngineBaseTypes.h"
+#include "ShooterPerfCaptureGameMode.generated.h"
+
+/* timestamps the game thread as it reaches one tick group during a perf capture */
+struct FShooterPerfMarkerTickFunction : public FTickFunction
+{
+	class AShooterPerfCaptureGameMode* Target { nullptr };
+	int32 Marker { 0 };
+
+	virtual void ExecuteTick( float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent ) override;
+	virtual FString DiagnosticMessage( ) override;
+};
+
+/**
+ * Plays a flythrough level sequence and buckets game thread, tick, physics and animation times
+ * by the section of the sequence being played, then writes a per-section percentile summary
+ * to Saved/PerfCapture and exits. Works under -nullrhi for CPU-only numbers, e.g.
+ *
+ * Factory?game=PerfCapture -PerfSequence=FlythroughSequence02 -nullrhi
+ *
+ * Sections come from the sequence's marked frames, else its camera cuts, else the whole sequence.
+ * Animation time is read from the Anim stat group, which is shown while the sequence plays.
+ */
+UCLASS()
+class SHOOTER_API AShooterPerfCaptureGameMode : public AShooterGameModeBase
+{
+	GENERATED_BODY()
+
+public:
+	AShooterPerfCaptureGameMode( );
+
+	virtual void InitGame( const FString& MapName, const FString& Options, FString& ErrorMessage ) override;
+
+	virtual void StartPlay( ) override;
+
+	virtual void EndPlay( const EEndPlayReason::Type EndPlayReason ) override;
+
+	/* called by the marker tick functions as the game thread reaches each tick group */
+	void MarkTickGroup( int32 Marker );
+
+private:
+	enum EPerfMetric
+	{
+		EPM_GameThread,
+		EPM_Tick,
+		EPM_Physics,
+		EPM_Anim,
+
+		EPM_Max
+	};
+
+	struct FCaptureSection
+	{
+		FString Label;
+		/* first frame of the section in the sequence's tick resolution */
+		FFrameNumber Start;
+		TArray<float> Samples[EPM_Max];
+	};
+
+	void StartSequence( );
+
+	UFUNCTION( )
+	void OnSequenceFinished( );
+
+	/* split the playback range into sections */
+	void BuildSections( );
+
+	/* section containing the sequence's current time */
+	FCaptureSection* GetCurrentSection( );
+
+	void RecordFrame( );
+
+	void WriteSummary( ) const;
+
+	/* sequence played when none is given on the URL or command line */
+	UPROPERTY( EditDefaultsOnly, Category = PerfCapture, meta = ( AllowPrivateAccess = "true" ) )
+	TSoftObjectPtr<class ULevelSequence> DefaultSequence;
+
+	/* time given to streaming and shader warm up before the sequence starts */
+	UPROPERTY( EditDefaultsOnly, Category = PerfCapture, meta = ( AllowPrivateAccess = "true" ) )
+	float WarmupSeconds;
+
+	UPROPERTY( Transient )
+	class ULevelSequence* Sequence;
+
+	UPROPERTY( Transient )
+	class ULevelSequencePlayer* SequencePlayer;
+
+	/* sequence asset name from "?Sequence=" or "-PerfSequence=", looked for in /Game/Sequences */
+	FString RequestedSequence;
+
+	TArray<FCaptureSection> Sections;
+
+	/* tick group boundaries: frame start, physics start, physics end, frame end */
+	FShooterPerfMarkerTickFunction MarkerTicks[4];
+	uint64 MarkerCycles[4];
+
+	bool bCapturing;
+
+	/* the anim stat group was hidden and shown for the capture, so hide it again afterwards */
+	bool bShowedAnimStats;
+};
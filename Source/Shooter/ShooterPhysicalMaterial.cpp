@@ -0,0 +1,11 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterPhysicalMaterial.h"
+
+UShooterPhysicalMaterial::UShooterPhysicalMaterial( ) :
+	PenetrationThickness( 0.f ),
+	RicochetMaxAngle( 0.f ),
+	RicochetDistanceScale( 0.5f )
+{
+}
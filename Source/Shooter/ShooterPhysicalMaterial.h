@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PhysicalMaterials/PhysicalMaterial.h"
+#include "ShooterPhysicalMaterial.generated.h"
+
+/**
+ * Physical material with the ballistic properties used by the shot trace
+ */
+UCLASS()
+class SHOOTER_API UShooterPhysicalMaterial : public UPhysicalMaterial
+{
+	GENERATED_BODY()
+
+public:
+	UShooterPhysicalMaterial( );
+
+	/* thickest wall (cm) of this material a bullet can pass through. 0 means impenetrable */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = Ballistics, meta = ( ClampMin = "0.0", UIMin = "0.0" ) )
+	float PenetrationThickness;
+
+	/* bullets hitting at a shallower angle (degrees from the surface) than this ricochet. 0 means never */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = Ballistics, meta = ( ClampMin = "0.0", ClampMax = "90.0", UIMin = "0.0", UIMax = "90.0" ) )
+	float RicochetMaxAngle;
+
+	/* fraction of the remaining trace distance kept after a ricochet */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = Ballistics, meta = ( ClampMin = "0.0", ClampMax = "1.0", UIMin = "0.0", UIMax = "1.0" ) )
+	float RicochetDistanceScale;
+};
@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterPlayAnimationComponent.h"
+#include "Animation/AnimSequenceBase.h"
+#include "Components/SkeletalMeshComponent.h"
+
+UShooterPlayAnimationComponent::UShooterPlayAnimationComponent( ) :
+	Animation( nullptr ),
+	bUseAnimationLength( true ),
+	Mesh( nullptr )
+{
+}
+
+void UShooterPlayAnimationComponent::BeginPlay( )
+{
+	if ( MeshComponentName == NAME_None )
+	{
+		Mesh = GetOwner( ) ? GetOwner( )->FindComponentByClass<USkeletalMeshComponent>( ) : nullptr;
+	}
+	else
+	{
+		Mesh = FindOwnerComponent<USkeletalMeshComponent>( MeshComponentName );
+	}
+
+	if ( Mesh && Animation )
+	{
+		if ( bUseAnimationLength )
+		{
+			Duration = Animation->GetPlayLength( );
+		}
+		// we set the position ourselves, so the single node player never advances on its own
+		Mesh->SetAnimationMode( EAnimationMode::AnimationSingleNode );
+		Mesh->SetAnimation( Animation );
+		Mesh->Stop( );
+	}
+
+	Super::BeginPlay( );
+}
+
+void UShooterPlayAnimationComponent::ApplyActionAlpha( float Alpha )
+{
+	if ( Mesh && Animation )
+	{
+		Mesh->SetPosition( Alpha * Animation->GetPlayLength( ), false );
+	}
+
+	Super::ApplyActionAlpha( Alpha );
+}
@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ShooterActionComponent.h"
+#include "ShooterPlayAnimationComponent.generated.h"
+
+class UAnimSequenceBase;
+class USkeletalMeshComponent;
+
+/**
+ * Scrubs a single animation on one of the owner's skeletal meshes forwards or backwards.
+ * The mesh is posed directly from the timeline, so it needs no anim instance and doesn't
+ * update its animation while the action is idle.
+ */
+UCLASS( Blueprintable, ClassGroup = ( Custom ), meta = ( BlueprintSpawnableComponent ) )
+class SHOOTER_API UShooterPlayAnimationComponent : public UShooterActionComponent
+{
+	GENERATED_BODY()
+
+public:
+	UShooterPlayAnimationComponent( );
+
+protected:
+	virtual void BeginPlay( ) override;
+	virtual void ApplyActionAlpha( float Alpha ) override;
+
+private:
+	/* owner skeletal mesh to animate; leave empty for the first one found */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Animation, meta = ( AllowPrivateAccess = "true" ) )
+	FName MeshComponentName;
+
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Animation, meta = ( AllowPrivateAccess = "true" ) )
+	UAnimSequenceBase* Animation;
+
+	/* use the animation's own length as Duration */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Animation, meta = ( AllowPrivateAccess = "true" ) )
+	bool bUseAnimationLength;
+
+	UPROPERTY( Transient )
+	USkeletalMeshComponent* Mesh;
+};
@@ -0,0 +1,139 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterPreloadManifestCommandlet.h"
+#include "Shooter.h"
+#include "ShooterPreloadSubsystem.h"
+
+#if WITH_EDITOR
+#include "AssetRegistryModule.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+
+namespace
+{
+	/* Roots and every /Game package they hard-depend on, breadth first, skipping anything already in Visited */
+	void GatherHardDependencies( const IAssetRegistry& AssetRegistry, const TArray<FName>& Roots, TSet<FName>& Visited, TArray<FName>& OutPackages )
+	{
+		TArray<FName> Queue( Roots );
+		for ( int32 Next = 0; Next < Queue.Num( ); Next++ )
+		{
+			const FName Package { Queue[Next] };
+			bool bAlreadyVisited { false };
+			Visited.Add( Package, &bAlreadyVisited );
+			// engine and script packages are loaded long before the game instance is up
+			if ( bAlreadyVisited || !Package.ToString( ).StartsWith( TEXT( "/Game/" ) ) )
+			{
+				continue;
+			}
+			OutPackages.Add( Package );
+
+			TArray<FName> Dependencies;
+			AssetRegistry.GetDependencies( Package, Dependencies, UE::AssetRegistry::EDependencyCategory::Package, UE::AssetRegistry::EDependencyQuery::Hard );
+			Queue.Append( Dependencies );
+		}
+	}
+
+	TArray<FName> ToPackageNames( const TArray<FString>& Paths )
+	{
+		TArray<FName> PackageNames;
+		for ( const FString& Path : Paths )
+		{
+			PackageNames.Add( FName( *FPackageName::ObjectPathToPackageName( Path ) ) );
+		}
+		return PackageNames;
+	}
+
+	/* the object to request for Package: its main asset, or the first one in it */
+	FString GetPackageObjectPath( const IAssetRegistry& AssetRegistry, FName Package )
+	{
+		TArray<FAssetData> Assets;
+		AssetRegistry.GetAssetsByPackageName( Package, Assets );
+		if ( Assets.Num( ) == 0 )
+		{
+			return FString( );
+		}
+		const FName MainAssetName { *FPackageName::GetShortName( Package ) };
+		const FAssetData* MainAsset = Assets.FindByPredicate( [&MainAssetName]( const FAssetData& Asset ) { return Asset.AssetName == MainAssetName; } );
+		return ( MainAsset ? *MainAsset : Assets[0] ).ObjectPath.ToString( );
+	}
+}
+#endif // WITH_EDITOR
+
+UShooterPreloadManifestCommandlet::UShooterPreloadManifestCommandlet( )
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UShooterPreloadManifestCommandlet::Main( const FString& Params )
+{
+#if WITH_EDITOR
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> ParamValues;
+	ParseCommandLine( *Params, Tokens, Switches, ParamValues );
+
+	FString Map;
+	if ( ParamValues.Contains( TEXT( "Map" ) ) )
+	{
+		Map = ParamValues[TEXT( "Map" )];
+	}
+	else
+	{
+		GConfig->GetString( TEXT( "/Script/EngineSettings.GameMapsSettings" ), TEXT( "GameDefaultMap" ), Map, GEngineIni );
+	}
+	const FString OutFile { ParamValues.Contains( TEXT( "Out" ) ) ? ParamValues[TEXT( "Out" )] : UShooterPreloadSubsystem::GetManifestPath( ) };
+	const FName MapPackage { *FPackageName::ObjectPathToPackageName( Map ) };
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>( TEXT( "AssetRegistry" ) ).Get( );
+	AssetRegistry.SearchAllAssets( true );
+
+	if ( !AssetRegistry.GetAssetPackageData( MapPackage ) )
+	{
+		UE_LOG( LogShooter, Error, TEXT( "No map package %s" ), *MapPackage.ToString( ) );
+		return 1;
+	}
+
+	const UShooterPreloadSubsystem* Preload = GetDefault<UShooterPreloadSubsystem>( );
+
+	// the map package itself is left to the engine's map load; only what it needs is preloaded
+	TSet<FName> Visited { MapPackage };
+	TArray<FName> TierPackages[static_cast<int32>( EShooterPreloadTier::EPT_Max )];
+	GatherHardDependencies( AssetRegistry, ToPackageNames( Preload->PlayerRoots ), Visited, TierPackages[static_cast<int32>( EShooterPreloadTier::EPT_Player )] );
+	GatherHardDependencies( AssetRegistry, ToPackageNames( Preload->WeaponRoots ), Visited, TierPackages[static_cast<int32>( EShooterPreloadTier::EPT_Weapon )] );
+
+	TArray<FName> MapDependencies;
+	AssetRegistry.GetDependencies( MapPackage, MapDependencies, UE::AssetRegistry::EDependencyCategory::Package, UE::AssetRegistry::EDependencyQuery::Hard );
+	GatherHardDependencies( AssetRegistry, MapDependencies, Visited, TierPackages[static_cast<int32>( EShooterPreloadTier::EPT_Room )] );
+
+	FString Manifest { TEXT( "Tier,ObjectPath\n" ) };
+	for ( int32 Tier = 0; Tier < static_cast<int32>( EShooterPreloadTier::EPT_Max ); Tier++ )
+	{
+		const TCHAR* TierName = UShooterPreloadSubsystem::GetTierName( static_cast<EShooterPreloadTier>( Tier ) );
+		for ( const FName Package : TierPackages[Tier] )
+		{
+			const FString ObjectPath { GetPackageObjectPath( AssetRegistry, Package ) };
+			if ( !ObjectPath.IsEmpty( ) )
+			{
+				Manifest += FString::Printf( TEXT( "%s,%s\n" ), TierName, *ObjectPath );
+			}
+		}
+		UE_LOG( LogShooter, Display, TEXT( "%s tier: %d packages" ), TierName, TierPackages[Tier].Num( ) );
+	}
+
+	if ( !FFileHelper::SaveStringToFile( Manifest, *OutFile ) )
+	{
+		UE_LOG( LogShooter, Error, TEXT( "Couldn't write %s" ), *OutFile );
+		return 1;
+	}
+	UE_LOG( LogShooter, Display, TEXT( "Preload manifest for %s written to %s" ), *MapPackage.ToString( ), *OutFile );
+	return 0;
+#else
+	UE_LOG( LogShooter, Error, TEXT( "ShooterPreloadManifest needs an editor build" ) );
+	return 1;
+#endif // WITH_EDITOR
+}
@@ -0,0 +1,25 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ShooterPreloadManifestCommandlet.generated.h"
+
+/**
+ * Writes the startup preload manifest read by UShooterPreloadSubsystem from the asset registry's
+ * hard package dependencies: the Player tier from PlayerRoots, the Weapon tier from WeaponRoots and
+ * the Room tier from the map, each package in the first tier that needs it.
+ *
+ * UE4Editor-Cmd Shooter.uproject -run=ShooterPreloadManifest [-Map=/Game/_Game/Maps/Factory] [-Out=<file>]
+ */
+UCLASS()
+class UShooterPreloadManifestCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UShooterPreloadManifestCommandlet( );
+
+	virtual int32 Main( const FString& Params ) override;
+};
@@ -0,0 +1,224 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterPreloadSubsystem.h"
+#include "Engine/GameInstance.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectGlobals.h"
+#include "Shooter.h"
+
+namespace
+{
+	const TCHAR* const TierNames[] { TEXT( "Player" ), TEXT( "Weapon" ), TEXT( "Room" ) };
+	static_assert( UE_ARRAY_COUNT( TierNames ) == static_cast<int32>( EShooterPreloadTier::EPT_Max ), "Name every tier" );
+
+	/* player content first, room content once nothing more urgent is queued */
+	const TAsyncLoadPriority TierPriorities[] {
+		FStreamableManager::AsyncLoadHighPriority,
+		FStreamableManager::AsyncLoadHighPriority / 2,
+		FStreamableManager::DefaultAsyncLoadPriority };
+	static_assert( UE_ARRAY_COUNT( TierPriorities ) == static_cast<int32>( EShooterPreloadTier::EPT_Max ), "Prioritise every tier" );
+}
+
+const TCHAR* UShooterPreloadSubsystem::GetTierName( EShooterPreloadTier Tier )
+{
+	return Tier < EShooterPreloadTier::EPT_Max ? TierNames[static_cast<int32>( Tier )] : TEXT( "Unknown" );
+}
+
+FString UShooterPreloadSubsystem::GetManifestPath( )
+{
+	return FPaths::ProjectContentDir( ) / GetDefault<UShooterPreloadSubsystem>( )->ManifestFile;
+}
+
+void UShooterPreloadSubsystem::Initialize( FSubsystemCollectionBase& Collection )
+{
+	Super::Initialize( Collection );
+
+	// PIE startup says nothing about a cooked boot
+	if ( GIsEditor )
+	{
+		bInteractive = true;
+		return;
+	}
+
+	Mark( TEXT( "GameInstanceInit" ) );
+
+	PreLoadMapHandle = FCoreUObjectDelegates::PreLoadMap.AddUObject( this, &UShooterPreloadSubsystem::OnPreLoadMap );
+	PostLoadMapHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject( this, &UShooterPreloadSubsystem::OnPostLoadMap );
+
+	if ( !FParse::Param( FCommandLine::Get( ), TEXT( "NoStartupPreload" ) ) )
+	{
+		StartPreload( );
+	}
+}
+
+void UShooterPreloadSubsystem::Deinitialize( )
+{
+	FCoreUObjectDelegates::PreLoadMap.Remove( PreLoadMapHandle );
+	FCoreUObjectDelegates::PostLoadMapWithWorld.Remove( PostLoadMapHandle );
+
+	for ( TSharedPtr<FStreamableHandle>& Handle : TierHandles )
+	{
+		if ( Handle.IsValid( ) )
+		{
+			Handle->CancelHandle( );
+			Handle.Reset( );
+		}
+	}
+
+	Super::Deinitialize( );
+}
+
+void UShooterPreloadSubsystem::StartPreload( )
+{
+	TArray<FString> Lines;
+	if ( !FFileHelper::LoadFileToStringArray( Lines, *GetManifestPath( ) ) )
+	{
+		UE_LOG( LogShooter, Warning, TEXT( "No startup preload manifest at %s; run the ShooterPreloadManifest commandlet" ), *GetManifestPath( ) );
+		return;
+	}
+
+	// Tier,ObjectPath per line after the header
+	TArray<FSoftObjectPath> TierAssets[static_cast<int32>( EShooterPreloadTier::EPT_Max )];
+	for ( int32 Line = 1; Line < Lines.Num( ); Line++ )
+	{
+		FString TierName, ObjectPath;
+		if ( !Lines[Line].Split( TEXT( "," ), &TierName, &ObjectPath ) )
+		{
+			continue;
+		}
+		for ( int32 Tier = 0; Tier < static_cast<int32>( EShooterPreloadTier::EPT_Max ); Tier++ )
+		{
+			if ( TierName == TierNames[Tier] )
+			{
+				TierAssets[Tier].Emplace( ObjectPath );
+				break;
+			}
+		}
+	}
+
+	for ( int32 Tier = 0; Tier < static_cast<int32>( EShooterPreloadTier::EPT_Max ); Tier++ )
+	{
+		if ( TierAssets[Tier].Num( ) == 0 )
+		{
+			continue;
+		}
+
+		const FString TierName { TierNames[Tier] };
+		const int32 NumAssets { TierAssets[Tier].Num( ) };
+		TierHandles[Tier] = StreamableManager.RequestAsyncLoad(
+			MoveTemp( TierAssets[Tier] ),
+			FStreamableDelegate::CreateWeakLambda( this, [this, TierName, NumAssets]( )
+			{
+				Mark( FString::Printf( TEXT( "Preload%sLoaded (%d assets)" ), *TierName, NumAssets ) );
+			} ),
+			TierPriorities[Tier],
+			false,
+			false,
+			FString::Printf( TEXT( "StartupPreload%s" ), *TierName ) );
+	}
+
+	bPreloading = true;
+	Mark( TEXT( "PreloadRequested" ) );
+}
+
+void UShooterPreloadSubsystem::OnPreLoadMap( const FString& MapName )
+{
+	Mark( FString::Printf( TEXT( "MapLoadStart %s" ), *FPackageName::GetShortName( MapName ) ) );
+}
+
+void UShooterPreloadSubsystem::OnPostLoadMap( UWorld* World )
+{
+	Mark( TEXT( "MapLoaded" ) );
+}
+
+void UShooterPreloadSubsystem::OnLevelStarted( UWorld* World )
+{
+	if ( bLevelStarted )
+	{
+		return;
+	}
+	bLevelStarted = true;
+	Mark( TEXT( "LevelStarted" ) );
+
+	// the level holds on to what it uses now; let the rest go once it's done loading
+	for ( TSharedPtr<FStreamableHandle>& Handle : TierHandles )
+	{
+		if ( Handle.IsValid( ) )
+		{
+			Handle->ReleaseHandle( );
+			Handle.Reset( );
+		}
+	}
+}
+
+void UShooterPreloadSubsystem::Mark( const FString& Name )
+{
+	if ( bInteractive )
+	{
+		return;
+	}
+	const double Seconds { FPlatformTime::Seconds( ) - GStartTime };
+	Timeline.Add( { Name, Seconds } );
+	UE_LOG( LogShooter, Log, TEXT( "Startup: %7.3f s %s" ), Seconds, *Name );
+}
+
+bool UShooterPreloadSubsystem::IsTickable( ) const
+{
+	return !IsTemplate( ) && bLevelStarted && !bInteractive;
+}
+
+TStatId UShooterPreloadSubsystem::GetStatId( ) const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT( UShooterPreloadSubsystem, STATGROUP_Tickables );
+}
+
+UWorld* UShooterPreloadSubsystem::GetTickableGameObjectWorld( ) const
+{
+	return GetGameInstance( )->GetWorld( );
+}
+
+bool UShooterPreloadSubsystem::IsLocalPlayerInteractive( ) const
+{
+	const ULocalPlayer* LocalPlayer = GetGameInstance( )->GetFirstGamePlayer( );
+	const APlayerController* PlayerController = LocalPlayer ? LocalPlayer->PlayerController : nullptr;
+	const APawn* Pawn = PlayerController ? PlayerController->GetPawn( ) : nullptr;
+	return Pawn && Pawn->HasActorBegunPlay( );
+}
+
+void UShooterPreloadSubsystem::Tick( float DeltaTime )
+{
+	// a server without local players is interactive as soon as its level has started
+	if ( GetGameInstance( )->GetFirstGamePlayer( ) && !IsLocalPlayerInteractive( ) )
+	{
+		return;
+	}
+
+	Mark( TEXT( "Interactive" ) );
+	bInteractive = true;
+	WriteTimeline( );
+}
+
+void UShooterPreloadSubsystem::WriteTimeline( )
+{
+	FString Log { FString::Printf( TEXT( "Startup timeline, %s, preload %s\n" ), *FDateTime::Now( ).ToString( ), bPreloading ? TEXT( "on" ) : TEXT( "off" ) ) };
+	double PreviousSeconds { 0.0 };
+	for ( const FTimelineMark& TimelineMark : Timeline )
+	{
+		Log += FString::Printf( TEXT( "%8.3f s  +%7.3f s  %s\n" ), TimelineMark.Seconds, TimelineMark.Seconds - PreviousSeconds, *TimelineMark.Name );
+		PreviousSeconds = TimelineMark.Seconds;
+	}
+	FFileHelper::SaveStringToFile( Log, *( FPaths::ProjectLogDir( ) / TEXT( "StartupTimeline.log" ) ) );
+
+	const FString Filename { FPaths::ProjectSavedDir( ) / TEXT( "StartupTimeline" ) / TEXT( "TimeToInteractive.csv" ) };
+	const FString Row { FString::Printf( TEXT( "%s,%s,%d,%.3f\n" ), *FDateTime::Now( ).ToString( ),
+		*UWorld::RemovePIEPrefix( GetGameInstance( )->GetWorld( )->GetMapName( ) ), bPreloading ? 1 : 0, PreviousSeconds ) };
+	SaveBenchmarkResults( TEXT( "Startup timeline" ), Filename, TEXT( "Date,Map,Preload,TimeToInteractiveSec\n" ), Row, true );
+}
@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/StreamableManager.h"
+#include "Tickable.h"
+#include "ShooterLevelSubsystem.h"
+#include "ShooterPreloadSubsystem.generated.h"
+
+/* preload tiers, loaded in this order of priority */
+enum class EShooterPreloadTier : uint8
+{
+	EPT_Player,		// game mode, character, anim Blueprint, HUD
+	EPT_Weapon,		// guns, weapon table and the effects and sounds they reference
+	EPT_Room,		// everything else the default map needs
+	EPT_Max
+};
+
+/**
+ * Starts loading the default map's content asynchronously as soon as the game instance is up,
+ * so the map's synchronous load mostly finds it in memory. The manifest of what to load, by tier,
+ * is generated by the ShooterPreloadManifest commandlet. -NoStartupPreload turns it off for comparison.
+ *
+ * Records a startup timeline from process start to the first frame the local player can move,
+ * written to Saved/Logs/StartupTimeline.log, with time-to-interactive appended to
+ * Saved/StartupTimeline/TimeToInteractive.csv.
+ */
+UCLASS( Config = Game )
+class SHOOTER_API UShooterPreloadSubsystem : public UShooterLevelSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize( FSubsystemCollectionBase& Collection ) override;
+	virtual void Deinitialize( ) override;
+
+	/* the first level is up; called by the game mode */
+	virtual void OnLevelStarted( UWorld* World ) override;
+
+	/* first, so the startup timeline ends before anything else runs */
+	virtual int32 GetLevelStartedOrder( ) const override { return -2; }
+
+	/* add a named point to the startup timeline; ignored once the player is interactive */
+	void Mark( const FString& Name );
+
+	static const TCHAR* GetTierName( EShooterPreloadTier Tier );
+
+	/* manifest location under the content directory */
+	static FString GetManifestPath( );
+
+	// FTickableGameObject
+	virtual void Tick( float DeltaTime ) override;
+	virtual bool IsTickable( ) const override;
+	virtual TStatId GetStatId( ) const override;
+	virtual UWorld* GetTickableGameObjectWorld( ) const override;
+
+	/* packages whose dependencies make up the Player tier, used by the manifest commandlet */
+	UPROPERTY( Config )
+	TArray<FString> PlayerRoots;
+
+	/* packages whose dependencies make up the Weapon tier, used by the manifest commandlet */
+	UPROPERTY( Config )
+	TArray<FString> WeaponRoots;
+
+private:
+	/* read the manifest and request every tier */
+	void StartPreload( );
+
+	void OnPreLoadMap( const FString& MapName );
+	void OnPostLoadMap( UWorld* World );
+
+	/* true once a local player's pawn has begun play */
+	bool IsLocalPlayerInteractive( ) const;
+
+	void WriteTimeline( );
+
+	/* manifest file, relative to the content directory */
+	UPROPERTY( Config )
+	FString ManifestFile;
+
+	FStreamableManager StreamableManager;
+	TSharedPtr<FStreamableHandle> TierHandles[static_cast<int32>( EShooterPreloadTier::EPT_Max )];
+
+	struct FTimelineMark
+	{
+		FString Name;
+		double Seconds;
+	};
+	TArray<FTimelineMark> Timeline;
+
+	bool bPreloading { false };
+	bool bLevelStarted { false };
+	bool bInteractive { false };
+
+	FDelegateHandle PreLoadMapHandle;
+	FDelegateHandle PostLoadMapHandle;
+};
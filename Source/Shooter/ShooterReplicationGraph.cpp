@@ -0,0 +1,152 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterReplicationGraph.h"
+#include "Engine/NetDriver.h"
+#include "UObject/UObjectIterator.h"
+#include "Item.h"
+#include "ShooterStats.h"
+
+DECLARE_CYCLE_STAT( TEXT( "Replicate Actors" ), STAT_ReplicateActors, STATGROUP_Shooter );
+DECLARE_DWORD_ACCUMULATOR_STAT( TEXT( "Items In Replication Grid" ), STAT_ReplicationGridItems, STATGROUP_Shooter );
+
+UShooterReplicationGraph::UShooterReplicationGraph( ) :
+	GridCellSize( 10000.f ),
+	SpatialBias( -150000.f, -200000.f ),
+	ItemCullDistance( 5000.f ),
+	GridNode( nullptr ),
+	AlwaysRelevantNode( nullptr )
+{
+}
+
+UShooterReplicationGraph::EClassRepPolicy UShooterReplicationGraph::GetClassPolicy( UClass* Class )
+{
+	if ( const EClassRepPolicy* Cached = ClassPolicies.Find( Class ) )
+	{
+		return *Cached;
+	}
+
+	EClassRepPolicy Policy { EClassRepPolicy::SpatializeDynamic };
+	const AActor* Defaults = GetDefault<AActor>( Class );
+	if ( Class->IsChildOf<AItem>( ) )
+	{
+		Policy = EClassRepPolicy::SpatializeDormancy;
+	}
+	else if ( Defaults->bOnlyRelevantToOwner )
+	{
+		Policy = EClassRepPolicy::NotRouted;
+	}
+	else if ( Defaults->bAlwaysRelevant )
+	{
+		Policy = EClassRepPolicy::RelevantAllConnections;
+	}
+
+	ClassPolicies.Add( Class, Policy );
+	return Policy;
+}
+
+void UShooterReplicationGraph::InitGlobalActorClassSettings( )
+{
+	Super::InitGlobalActorClassSettings( );
+
+	// give every replicated class its own update period and cull distance from its defaults
+	for ( TObjectIterator<UClass> It; It; ++It )
+	{
+		UClass* Class = *It;
+		const AActor* Defaults = Cast<AActor>( Class->GetDefaultObject( false ) );
+		if ( Defaults == nullptr || !Defaults->GetIsReplicated( )
+			|| Class->GetName( ).StartsWith( TEXT( "SKEL_" ) ) || Class->GetName( ).StartsWith( TEXT( "REINST_" ) ) )
+		{
+			continue;
+		}
+
+		FClassReplicationInfo ClassInfo;
+		ClassInfo.ReplicationPeriodFrame = GetReplicationPeriodFrameForFrequency( Defaults->NetUpdateFrequency );
+		ClassInfo.SetCullDistanceSquared( Class->IsChildOf<AItem>( ) ? FMath::Square( ItemCullDistance ) : Defaults->NetCullDistanceSquared );
+		GlobalActorReplicationInfoMap.SetClassInfo( Class, ClassInfo );
+	}
+}
+
+void UShooterReplicationGraph::InitGlobalGraphNodes( )
+{
+	GridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>( );
+	GridNode->CellSize = GridCellSize;
+	GridNode->SpatialBias = SpatialBias;
+	AddGlobalGraphNode( GridNode );
+
+	AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>( );
+	AddGlobalGraphNode( AlwaysRelevantNode );
+}
+
+void UShooterReplicationGraph::InitConnectionGraphNodes( UNetReplicationGraphConnection* RepGraphConnection )
+{
+	Super::InitConnectionGraphNodes( RepGraphConnection );
+
+	// adds the connection's player controller and view target itself
+	UReplicationGraphNode_AlwaysRelevant_ForConnection* ConnectionNode = CreateNewNode<UReplicationGraphNode_AlwaysRelevant_ForConnection>( );
+	AddConnectionGraphNode( ConnectionNode, RepGraphConnection );
+}
+
+void UShooterReplicationGraph::RouteAddNetworkActorToNodes( const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo )
+{
+	switch ( GetClassPolicy( ActorInfo.Class ) )
+	{
+	case EClassRepPolicy::RelevantAllConnections:
+		AlwaysRelevantNode->NotifyAddNetworkActor( ActorInfo );
+		break;
+	case EClassRepPolicy::SpatializeDynamic:
+		GridNode->AddActor_Dynamic( ActorInfo, GlobalInfo );
+		break;
+	case EClassRepPolicy::SpatializeDormancy:
+		GridNode->AddActor_Dormancy( ActorInfo, GlobalInfo );
+		NumGridItems++;
+		INC_DWORD_STAT( STAT_ReplicationGridItems );
+		break;
+	default:
+		break;
+	}
+}
+
+void UShooterReplicationGraph::RouteRemoveNetworkActorToNodes( const FNewReplicatedActorInfo& ActorInfo )
+{
+	switch ( GetClassPolicy( ActorInfo.Class ) )
+	{
+	case EClassRepPolicy::RelevantAllConnections:
+		AlwaysRelevantNode->NotifyRemoveNetworkActor( ActorInfo );
+		break;
+	case EClassRepPolicy::SpatializeDynamic:
+		GridNode->RemoveActor_Dynamic( ActorInfo );
+		break;
+	case EClassRepPolicy::SpatializeDormancy:
+		GridNode->RemoveActor_Dormancy( ActorInfo );
+		NumGridItems--;
+		DEC_DWORD_STAT( STAT_ReplicationGridItems );
+		break;
+	default:
+		break;
+	}
+}
+
+int32 UShooterReplicationGraph::ServerReplicateActors( float DeltaSeconds )
+{
+	SCOPE_CYCLE_COUNTER( STAT_ReplicateActors );
+
+	const uint64 StartCycles { FPlatformTime::Cycles64( ) };
+	const int32 Result { Super::ServerReplicateActors( DeltaSeconds ) };
+	const double ElapsedMs { FPlatformTime::ToMilliseconds64( FPlatformTime::Cycles64( ) - StartCycles ) };
+
+	ReplicateTotalMs += ElapsedMs;
+	ReplicateMaxMs = FMath::Max( ReplicateMaxMs, ElapsedMs );
+	ReplicateFrames++;
+	return Result;
+}
+
+void UShooterReplicationGraph::ConsumeReplicateTimes( double& OutTotalMs, double& OutMaxMs, int32& OutFrames )
+{
+	OutTotalMs = ReplicateTotalMs;
+	OutMaxMs = ReplicateMaxMs;
+	OutFrames = ReplicateFrames;
+	ReplicateTotalMs = 0.0;
+	ReplicateMaxMs = 0.0;
+	ReplicateFrames = 0;
+}
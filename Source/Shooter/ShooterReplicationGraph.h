@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+#include "ShooterReplicationGraph.generated.h"
+
+/**
+ * Replication graph for levels with thousands of items.
+ * Items and everything else that moves go into a 2D spatial grid, so each connection only
+ * considers actors in the cells around its viewers. Items stay net dormant there until picked up
+ * or changed. Always-relevant actors go to a global list; each connection's controller and
+ * view target are gathered per connection.
+ */
+UCLASS( Transient, Config = Engine )
+class SHOOTER_API UShooterReplicationGraph : public UReplicationGraph
+{
+	GENERATED_BODY()
+
+public:
+	UShooterReplicationGraph( );
+
+	virtual void InitGlobalActorClassSettings( ) override;
+	virtual void InitGlobalGraphNodes( ) override;
+	virtual void InitConnectionGraphNodes( UNetReplicationGraphConnection* RepGraphConnection ) override;
+	virtual void RouteAddNetworkActorToNodes( const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo ) override;
+	virtual void RouteRemoveNetworkActorToNodes( const FNewReplicatedActorInfo& ActorInfo ) override;
+	virtual int32 ServerReplicateActors( float DeltaSeconds ) override;
+
+	/* total and worst ServerReplicateActors time since the last call, for the net benchmark */
+	void ConsumeReplicateTimes( double& OutTotalMs, double& OutMaxMs, int32& OutFrames );
+
+	FORCEINLINE int32 GetNumGridItems( ) const { return NumGridItems; }
+
+private:
+	enum class EClassRepPolicy : uint8
+	{
+		/* gathered by the owning connection's node, e.g. player controllers */
+		NotRouted,
+		RelevantAllConnections,
+		SpatializeDynamic,
+		/* static in the grid while dormant, dynamic while awake */
+		SpatializeDormancy
+	};
+
+	EClassRepPolicy GetClassPolicy( UClass* Class );
+
+	/* size of a grid cell, cm */
+	UPROPERTY( Config )
+	float GridCellSize;
+
+	/* world position of the grid's corner; actors below it all land in the first cell */
+	UPROPERTY( Config )
+	FVector2D SpatialBias;
+
+	/* items further than this from every viewer aren't replicated, cm */
+	UPROPERTY( Config )
+	float ItemCullDistance;
+
+	UPROPERTY( )
+	UReplicationGraphNode_GridSpatialization2D* GridNode;
+
+	UPROPERTY( )
+	UReplicationGraphNode_ActorList* AlwaysRelevantNode;
+
+	TMap<const UClass*, EClassRepPolicy> ClassPolicies;
+
+	int32 NumGridItems { 0 };
+
+	double ReplicateTotalMs { 0.0 };
+	double ReplicateMaxMs { 0.0 };
+	int32 ReplicateFrames { 0 };
+};
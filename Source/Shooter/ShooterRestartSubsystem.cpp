@@ -0,0 +1,112 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterRestartSubsystem.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Paths.h"
+#include "Shooter.h"
+#include "ShooterStats.h"
+
+DECLARE_CYCLE_STAT( TEXT( "Restore Snapshot" ), STAT_RestoreSnapshot, STATGROUP_Shooter );
+
+static FAutoConsoleCommandWithWorldAndArgs RestartLevelCommand(
+	TEXT( "shooter.RestartLevel" ),
+	TEXT( "Restart the level from its starting snapshot; pass 0 to reload the map instead" ),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda( []( const TArray<FString>& Args, UWorld* World )
+	{
+		const UGameInstance* GameInstance = World ? World->GetGameInstance( ) : nullptr;
+		if ( UShooterRestartSubsystem* Restart = GameInstance ? GameInstance->GetSubsystem<UShooterRestartSubsystem>( ) : nullptr )
+		{
+			Restart->RestartLevel( Args.Num( ) == 0 || FCString::Atoi( *Args[0] ) != 0 );
+		}
+	} ) );
+
+void UShooterRestartSubsystem::Initialize( FSubsystemCollectionBase& Collection )
+{
+	Super::Initialize( Collection );
+
+	FParse::Value( FCommandLine::Get( ), TEXT( "RestartBenchmark=" ), BenchmarkRuns );
+}
+
+FString UShooterRestartSubsystem::GetSnapshotFilename( const UWorld* World )
+{
+	return FPaths::ProjectSavedDir( ) / TEXT( "Snapshots" ) / UWorld::RemovePIEPrefix( World->GetMapName( ) ) + TEXT( ".snap" );
+}
+
+void UShooterRestartSubsystem::OnLevelStarted( UWorld* World )
+{
+	if ( FullReloadStartSeconds > 0.0 )
+	{
+		TotalFullReloadMs += ( FPlatformTime::Seconds( ) - FullReloadStartSeconds ) * 1000.0;
+		FullReloadsDone++;
+		FullReloadStartSeconds = 0.0;
+	}
+
+	StartSnapshot.Capture( World );
+
+	if ( BenchmarkRuns > 0 )
+	{
+		RunBenchmarkStep( World );
+	}
+}
+
+void UShooterRestartSubsystem::RestartLevel( bool bInPlace )
+{
+	UWorld* World = GetGameInstance( )->GetWorld( );
+	if ( World == nullptr )
+	{
+		return;
+	}
+	if ( bInPlace )
+	{
+		SCOPE_CYCLE_COUNTER( STAT_RestoreSnapshot );
+		if ( StartSnapshot.Restore( World ) )
+		{
+			return;
+		}
+	}
+	UGameplayStatics::OpenLevel( World, FName( *UWorld::RemovePIEPrefix( World->GetMapName( ) ) ) );
+}
+
+void UShooterRestartSubsystem::RunBenchmarkStep( UWorld* World )
+{
+	// in-place restores go through the file each time, so mapping and validation are part of the cost
+	if ( InPlaceRunsDone == 0 )
+	{
+		const FString Filename { GetSnapshotFilename( World ) };
+		if ( !StartSnapshot.SaveToFile( Filename ) )
+		{
+			UE_LOG( LogShooter, Warning, TEXT( "Restart benchmark couldn't write %s" ), *Filename );
+		}
+		UE_LOG( LogShooter, Log, TEXT( "Restart benchmark: snapshot is %lld bytes" ), StartSnapshot.GetSize( ) );
+
+		for ( int32 Run = 0; Run < BenchmarkRuns; Run++ )
+		{
+			const double StartSeconds { FPlatformTime::Seconds( ) };
+			FShooterWorldSnapshot Loaded;
+			if ( Loaded.LoadFromFile( Filename ) )
+			{
+				Loaded.Restore( World );
+			}
+			TotalInPlaceMs += ( FPlatformTime::Seconds( ) - StartSeconds ) * 1000.0;
+			InPlaceRunsDone++;
+		}
+	}
+
+	// full reloads are timed from the request until the new level has started, including the frame travel waits for
+	if ( FullReloadsDone < BenchmarkRuns )
+	{
+		FullReloadStartSeconds = FPlatformTime::Seconds( );
+		UGameplayStatics::OpenLevel( World, FName( *UWorld::RemovePIEPrefix( World->GetMapName( ) ) ) );
+		return;
+	}
+
+	UE_LOG( LogShooter, Log, TEXT( "Restart benchmark: in place avg %.3f ms over %d runs, full reload avg %.3f ms over %d runs" ),
+		TotalInPlaceMs / FMath::Max( InPlaceRunsDone, 1 ), InPlaceRunsDone,
+		TotalFullReloadMs / FMath::Max( FullReloadsDone, 1 ), FullReloadsDone );
+	BenchmarkRuns = 0;
+	FinishBenchmarkRun( );
+}
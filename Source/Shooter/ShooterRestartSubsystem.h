@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ShooterWorldSnapshot.h"
+#include "ShooterLevelSubsystem.h"
+#include "ShooterRestartSubsystem.generated.h"
+
+/**
+ * Snapshots each level once it has started and restarts it by restoring that snapshot in place,
+ * instead of reloading the map and re-running every actor's construction and BeginPlay.
+ * -RestartBenchmark=<N> times N in-place restores against N full reloads, logs both and exits.
+ */
+UCLASS()
+class SHOOTER_API UShooterRestartSubsystem : public UShooterLevelSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize( FSubsystemCollectionBase& Collection ) override;
+
+	/* capture the level's starting state; called by the game mode once every actor has begun play */
+	virtual void OnLevelStarted( UWorld* World ) override;
+
+	/* before the benchmarks, so their bots and items aren't part of the starting state */
+	virtual int32 GetLevelStartedOrder( ) const override { return -1; }
+
+	/* restart the current level, restoring its starting snapshot in place or reloading the map */
+	UFUNCTION( BlueprintCallable, Category = Restart )
+	void RestartLevel( bool bInPlace = true );
+
+	const FShooterWorldSnapshot& GetStartSnapshot( ) const { return StartSnapshot; }
+
+private:
+	void RunBenchmarkStep( UWorld* World );
+
+	/* Saved/Snapshots/<Map>.snap */
+	static FString GetSnapshotFilename( const UWorld* World );
+
+	FShooterWorldSnapshot StartSnapshot;
+
+	/* restarts to time each way, 0 when not benchmarking */
+	int32 BenchmarkRuns { 0 };
+	int32 InPlaceRunsDone { 0 };
+	int32 FullReloadsDone { 0 };
+	double TotalInPlaceMs { 0.0 };
+	double TotalFullReloadMs { 0.0 };
+
+	/* when the pending full reload was requested, 0 if none */
+	double FullReloadStartSeconds { 0.0 };
+};
@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterRobotAnimComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "ShooterRobotAnimSubsystem.h"
+
+UShooterRobotAnimComponent::UShooterRobotAnimComponent( ) :
+	Animation( nullptr ),
+	PhaseOffset( 0.f ),
+	Mesh( nullptr )
+{
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UShooterRobotAnimComponent::BeginPlay( )
+{
+	Super::BeginPlay( );
+
+	Mesh = FindMesh( );
+	if ( UShooterRobotAnimSubsystem* RobotAnim = GetWorld( )->GetSubsystem<UShooterRobotAnimSubsystem>( ) )
+	{
+		RobotAnim->RegisterRobot( this );
+	}
+}
+
+void UShooterRobotAnimComponent::EndPlay( const EEndPlayReason::Type EndPlayReason )
+{
+	if ( UShooterRobotAnimSubsystem* RobotAnim = GetWorld( )->GetSubsystem<UShooterRobotAnimSubsystem>( ) )
+	{
+		RobotAnim->UnregisterRobot( this );
+	}
+
+	Super::EndPlay( EndPlayReason );
+}
+
+USkeletalMeshComponent* UShooterRobotAnimComponent::FindMesh( ) const
+{
+	const AActor* Owner = GetOwner( );
+	if ( Owner == nullptr )
+	{
+		return nullptr;
+	}
+	TInlineComponentArray<USkeletalMeshComponent*> Meshes( Owner );
+	for ( USkeletalMeshComponent* Component : Meshes )
+	{
+		if ( MeshComponentName == NAME_None || Component->GetFName( ) == MeshComponentName )
+		{
+			return Component;
+		}
+	}
+	return nullptr;
+}
@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "ShooterRobotAnimComponent.generated.h"
+
+class UAnimSequenceBase;
+class USkeletalMeshComponent;
+
+/**
+ * Plays a looping animation on one of the owner's skeletal meshes through UShooterRobotAnimSubsystem.
+ * Robots on the same loop and phase share a single evaluated pose; distant ones are slowed or frozen.
+ */
+UCLASS( ClassGroup = ( Custom ), meta = ( BlueprintSpawnableComponent ) )
+class SHOOTER_API UShooterRobotAnimComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UShooterRobotAnimComponent( );
+
+	/* the skeletal mesh to animate: MeshComponentName, or the first one on the owner */
+	USkeletalMeshComponent* FindMesh( ) const;
+
+protected:
+	virtual void BeginPlay( ) override;
+	virtual void EndPlay( const EEndPlayReason::Type EndPlayReason ) override;
+
+private:
+	friend class UShooterRobotAnimSubsystem;
+
+	/* owner skeletal mesh to animate; leave empty for the first one found */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = RobotAnimation, meta = ( AllowPrivateAccess = "true" ) )
+	FName MeshComponentName;
+
+	/* looping animation shared by every robot on the same loop */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = RobotAnimation, meta = ( AllowPrivateAccess = "true" ) )
+	UAnimSequenceBase* Animation;
+
+	/* where in the loop this robot is, as a fraction of its length; robots are grouped by this */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = RobotAnimation, meta = ( AllowPrivateAccess = "true", ClampMin = "0.0", ClampMax = "1.0" ) )
+	float PhaseOffset;
+
+	UPROPERTY( Transient )
+	USkeletalMeshComponent* Mesh;
+};
@@ -0,0 +1,262 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterRobotAnimSubsystem.h"
+#include "Animation/AnimSequenceBase.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "ShooterRobotAnimComponent.h"
+#include "ShooterStats.h"
+
+DECLARE_CYCLE_STAT( TEXT( "Robot Anim Sharing" ), STAT_RobotAnimSharing, STATGROUP_Shooter );
+DECLARE_DWORD_ACCUMULATOR_STAT( TEXT( "Robots" ), STAT_Robots, STATGROUP_Shooter );
+DECLARE_DWORD_ACCUMULATOR_STAT( TEXT( "Robot Poses Evaluated" ), STAT_RobotPosesEvaluated, STATGROUP_Shooter );
+DECLARE_DWORD_ACCUMULATOR_STAT( TEXT( "Robot Groups Frozen" ), STAT_RobotGroupsFrozen, STATGROUP_Shooter );
+
+static TAutoConsoleVariable<int32> CVarRobotAnimPhaseBuckets(
+	TEXT( "shooter.RobotAnim.PhaseBuckets" ),
+	4,
+	TEXT( "Robots on the same loop are grouped into this many phases; each group evaluates one pose" ) );
+
+static TAutoConsoleVariable<float> CVarRobotAnimSlowDistance(
+	TEXT( "shooter.RobotAnim.SlowDistance" ),
+	3000.f,
+	TEXT( "Groups farther than this from every player animate at SlowRate" ) );
+
+static TAutoConsoleVariable<float> CVarRobotAnimFreezeDistance(
+	TEXT( "shooter.RobotAnim.FreezeDistance" ),
+	8000.f,
+	TEXT( "Groups farther than this from every player, or not rendered, hold their pose" ) );
+
+static TAutoConsoleVariable<float> CVarRobotAnimSlowRate(
+	TEXT( "shooter.RobotAnim.SlowRate" ),
+	10.f,
+	TEXT( "Updates per second for slowed groups" ) );
+
+static TAutoConsoleVariable<float> CVarRobotAnimUpdateInterval(
+	TEXT( "shooter.RobotAnim.UpdateInterval" ),
+	0.25f,
+	TEXT( "Seconds between leader and LOD re-evaluation" ) );
+
+void UShooterRobotAnimSubsystem::RegisterRobot( UShooterRobotAnimComponent* Robot )
+{
+	USkeletalMeshComponent* Mesh = Robot ? Robot->Mesh : nullptr;
+	UAnimSequenceBase* Animation = Robot ? Robot->Animation : nullptr;
+	if ( Mesh == nullptr || Animation == nullptr || Mesh->SkeletalMesh == nullptr )
+	{
+		return;
+	}
+
+	const int32 NumBuckets { FMath::Max( CVarRobotAnimPhaseBuckets.GetValueOnGameThread( ), 1 ) };
+	const int32 PhaseBucket { FMath::Clamp( FMath::FloorToInt( Robot->PhaseOffset * NumBuckets ), 0, NumBuckets - 1 ) };
+
+	FRobotPoseGroup* Group = Groups.FindByPredicate( [&]( const FRobotPoseGroup& Candidate )
+	{
+		return Candidate.Animation == Animation && Candidate.SkeletalMesh == Mesh->SkeletalMesh && Candidate.PhaseBucket == PhaseBucket;
+	} );
+	if ( Group == nullptr )
+	{
+		Group = &Groups.AddDefaulted_GetRef( );
+		Group->Animation = Animation;
+		Group->SkeletalMesh = Mesh->SkeletalMesh;
+		Group->PhaseBucket = PhaseBucket;
+	}
+
+	Group->Meshes.AddUnique( Mesh );
+	INC_DWORD_STAT( STAT_Robots );
+	if ( Group->Leader.IsValid( ) )
+	{
+		MakeFollower( Mesh, Group->Leader.Get( ) );
+	}
+	else
+	{
+		SetLeader( *Group, Mesh, Animation->GetPlayLength( ) * PhaseBucket / NumBuckets );
+	}
+	SetGroupLOD( *Group, Group->LOD );
+}
+
+void UShooterRobotAnimSubsystem::UnregisterRobot( UShooterRobotAnimComponent* Robot )
+{
+	USkeletalMeshComponent* Mesh = Robot ? Robot->Mesh : nullptr;
+	if ( Mesh == nullptr )
+	{
+		return;
+	}
+	for ( int32 GroupIndex = 0; GroupIndex < Groups.Num( ); GroupIndex++ )
+	{
+		FRobotPoseGroup& Group = Groups[GroupIndex];
+		if ( Group.Meshes.Remove( Mesh ) == 0 )
+		{
+			continue;
+		}
+		DEC_DWORD_STAT( STAT_Robots );
+		Mesh->SetMasterPoseComponent( nullptr );
+
+		// robots destroyed since the last tick may still be listed, and one of them mustn't take over
+		Group.Meshes.RemoveAllSwap( []( const TWeakObjectPtr<USkeletalMeshComponent>& Other ) { return !Other.IsValid( ); } );
+		if ( Group.Meshes.Num( ) == 0 )
+		{
+			Groups.RemoveAtSwap( GroupIndex );
+		}
+		else if ( Group.Leader == Mesh )
+		{
+			// hand over without a pop in the loop
+			SetLeader( Group, Group.Meshes[0].Get( ), Mesh->GetPosition( ) );
+			SetGroupLOD( Group, Group.LOD );
+		}
+		return;
+	}
+}
+
+void UShooterRobotAnimSubsystem::SetLeader( FRobotPoseGroup& Group, USkeletalMeshComponent* NewLeader, float StartPosition )
+{
+	if ( NewLeader == nullptr )
+	{
+		return;
+	}
+	Group.Leader = NewLeader;
+	NewLeader->SetMasterPoseComponent( nullptr );
+	NewLeader->PlayAnimation( Group.Animation.Get( ), true );
+	NewLeader->SetPosition( StartPosition, false );
+
+	for ( const TWeakObjectPtr<USkeletalMeshComponent>& Mesh : Group.Meshes )
+	{
+		if ( Mesh.IsValid( ) && Mesh != NewLeader )
+		{
+			MakeFollower( Mesh.Get( ), NewLeader );
+		}
+	}
+}
+
+void UShooterRobotAnimSubsystem::MakeFollower( USkeletalMeshComponent* Follower, USkeletalMeshComponent* Leader )
+{
+	// no animation of its own, so copying the leader's pose is all that's left per frame
+	if ( Follower->GetAnimationMode( ) != EAnimationMode::AnimationSingleNode )
+	{
+		Follower->SetAnimationMode( EAnimationMode::AnimationSingleNode );
+	}
+	Follower->SetAnimation( nullptr );
+	Follower->SetMasterPoseComponent( Leader );
+}
+
+void UShooterRobotAnimSubsystem::SetGroupLOD( FRobotPoseGroup& Group, ERobotAnimLOD LOD )
+{
+	Group.LOD = LOD;
+
+	// a tick interval hands the skipped time to the next tick, so slowed loops stay in phase
+	const float TickInterval { LOD == ERobotAnimLOD::ERAL_Slow ? 1.f / FMath::Max( CVarRobotAnimSlowRate.GetValueOnGameThread( ), 1.f ) : 0.f };
+	for ( const TWeakObjectPtr<USkeletalMeshComponent>& Mesh : Group.Meshes )
+	{
+		if ( Mesh.IsValid( ) )
+		{
+			Mesh->SetComponentTickInterval( TickInterval );
+			Mesh->SetComponentTickEnabled( LOD != ERobotAnimLOD::ERAL_Frozen );
+		}
+	}
+}
+
+bool UShooterRobotAnimSubsystem::IsTickable( ) const
+{
+	const UWorld* World = GetWorld( );
+	return !IsTemplate( ) && World && World->IsGameWorld( ) && Groups.Num( ) > 0;
+}
+
+TStatId UShooterRobotAnimSubsystem::GetStatId( ) const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT( UShooterRobotAnimSubsystem, STATGROUP_Tickables );
+}
+
+void UShooterRobotAnimSubsystem::Tick( float DeltaTime )
+{
+	TimeUntilUpdate -= DeltaTime;
+	if ( TimeUntilUpdate > 0.f )
+	{
+		return;
+	}
+	TimeUntilUpdate = CVarRobotAnimUpdateInterval.GetValueOnGameThread( );
+
+	SCOPE_CYCLE_COUNTER( STAT_RobotAnimSharing );
+
+	TArray<FVector, TInlineAllocator<4>> ViewLocations;
+	for ( FConstPlayerControllerIterator It = GetWorld( )->GetPlayerControllerIterator( ); It; ++It )
+	{
+		if ( const APlayerController* PlayerController = It->Get( ) )
+		{
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PlayerController->GetPlayerViewPoint( ViewLocation, ViewRotation );
+			ViewLocations.Add( ViewLocation );
+		}
+	}
+
+	const float SlowDistanceSquared { FMath::Square( CVarRobotAnimSlowDistance.GetValueOnGameThread( ) ) };
+	const float FreezeDistanceSquared { FMath::Square( CVarRobotAnimFreezeDistance.GetValueOnGameThread( ) ) };
+	int32 NumEvaluated { 0 };
+	int32 NumFrozen { 0 };
+
+	for ( int32 GroupIndex = Groups.Num( ) - 1; GroupIndex >= 0; GroupIndex-- )
+	{
+		FRobotPoseGroup& Group = Groups[GroupIndex];
+		Group.Meshes.RemoveAllSwap( []( const TWeakObjectPtr<USkeletalMeshComponent>& Mesh ) { return !Mesh.IsValid( ); } );
+		if ( Group.Meshes.Num( ) == 0 || !Group.Animation.IsValid( ) )
+		{
+			Groups.RemoveAtSwap( GroupIndex );
+			continue;
+		}
+
+		// the nearest rendered robot leads, so the pose we evaluate is the one most likely to be seen
+		USkeletalMeshComponent* Nearest = nullptr;
+		float NearestDistanceSquared { MAX_flt };
+		for ( const TWeakObjectPtr<USkeletalMeshComponent>& Mesh : Group.Meshes )
+		{
+			if ( !Mesh->WasRecentlyRendered( 0.5f ) )
+			{
+				continue;
+			}
+			const FVector MeshLocation { Mesh->GetComponentLocation( ) };
+			for ( const FVector& ViewLocation : ViewLocations )
+			{
+				const float DistanceSquared { FVector::DistSquared( MeshLocation, ViewLocation ) };
+				if ( DistanceSquared < NearestDistanceSquared )
+				{
+					NearestDistanceSquared = DistanceSquared;
+					Nearest = Mesh.Get( );
+				}
+			}
+		}
+
+		ERobotAnimLOD LOD { ERobotAnimLOD::ERAL_Full };
+		if ( Nearest == nullptr || NearestDistanceSquared > FreezeDistanceSquared )
+		{
+			LOD = ERobotAnimLOD::ERAL_Frozen;
+		}
+		else if ( NearestDistanceSquared > SlowDistanceSquared )
+		{
+			LOD = ERobotAnimLOD::ERAL_Slow;
+		}
+
+		if ( Nearest && Nearest != Group.Leader )
+		{
+			const float Position { Group.Leader.IsValid( ) ? Group.Leader->GetPosition( ) : 0.f };
+			SetLeader( Group, Nearest, Position );
+			SetGroupLOD( Group, LOD );
+		}
+		else if ( LOD != Group.LOD )
+		{
+			SetGroupLOD( Group, LOD );
+		}
+
+		if ( LOD == ERobotAnimLOD::ERAL_Frozen )
+		{
+			NumFrozen++;
+		}
+		else
+		{
+			NumEvaluated++;
+		}
+	}
+
+	SET_DWORD_STAT( STAT_RobotPosesEvaluated, NumEvaluated );
+	SET_DWORD_STAT( STAT_RobotGroupsFrozen, NumFrozen );
+}
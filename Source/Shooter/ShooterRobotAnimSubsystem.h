@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ShooterRobotAnimSubsystem.generated.h"
+
+class UAnimSequenceBase;
+class USkeletalMesh;
+class USkeletalMeshComponent;
+class UShooterRobotAnimComponent;
+
+enum class ERobotAnimLOD : uint8
+{
+	ERAL_Full,
+	ERAL_Slow,
+	ERAL_Frozen
+};
+
+/* robots playing the same loop at the same phase; only Leader evaluates, the rest copy its pose */
+struct FRobotPoseGroup
+{
+	TWeakObjectPtr<UAnimSequenceBase> Animation;
+	TWeakObjectPtr<USkeletalMesh> SkeletalMesh;
+	int32 PhaseBucket;
+	TArray<TWeakObjectPtr<USkeletalMeshComponent>> Meshes;
+	TWeakObjectPtr<USkeletalMeshComponent> Leader;
+	ERobotAnimLOD LOD { ERobotAnimLOD::ERAL_Full };
+};
+
+/**
+ * Shares one evaluated pose between robots on the same loop via master pose components,
+ * and slows or freezes groups that are far away or off screen.
+ */
+UCLASS()
+class SHOOTER_API UShooterRobotAnimSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	void RegisterRobot( UShooterRobotAnimComponent* Robot );
+	void UnregisterRobot( UShooterRobotAnimComponent* Robot );
+
+	// FTickableGameObject
+	virtual void Tick( float DeltaTime ) override;
+	virtual bool IsTickable( ) const override;
+	virtual TStatId GetStatId( ) const override;
+	virtual UWorld* GetTickableGameObjectWorld( ) const override { return GetWorld( ); }
+
+private:
+	/* make NewLeader evaluate for Group, continuing from the old leader's position, and point everyone else at it */
+	void SetLeader( FRobotPoseGroup& Group, USkeletalMeshComponent* NewLeader, float StartPosition );
+
+	void SetGroupLOD( FRobotPoseGroup& Group, ERobotAnimLOD LOD );
+
+	/* stop Follower evaluating anything of its own and copy Leader's pose */
+	static void MakeFollower( USkeletalMeshComponent* Follower, USkeletalMeshComponent* Leader );
+
+	TArray<FRobotPoseGroup> Groups;
+
+	/* seconds until groups are re-evaluated */
+	float TimeUntilUpdate { 0.f };
+};
@@ -0,0 +1,230 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterServerBenchSubsystem.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GameFramework/GameModeBase.h"
+#include "Misc/CommandLine.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/Paths.h"
+#include "ShooterCharacter.h"
+#include "Shooter.h"
+
+namespace
+{
+	/* let loading hitches and first-shot spawns settle before timing */
+	const double WarmupSeconds { 5.0 };
+	const double MeasureSeconds { 20.0 };
+	const float BurstSeconds { 2.f };
+	const float PauseSeconds { 1.f };
+	const float SpawnRadius { 1500.f };
+}
+
+void UShooterServerBenchSubsystem::Initialize( FSubsystemCollectionBase& Collection )
+{
+	Super::Initialize( Collection );
+
+	FParse::Value( FCommandLine::Get( ), TEXT( "ServerTickBenchmark=" ), NumPlayers );
+	if ( NumPlayers > 0 )
+	{
+		WorldTickStartHandle = FWorldDelegates::OnWorldTickStart.AddUObject( this, &UShooterServerBenchSubsystem::OnWorldTickStart );
+		EndFrameHandle = FCoreDelegates::OnEndFrame.AddUObject( this, &UShooterServerBenchSubsystem::OnEndFrame );
+	}
+}
+
+void UShooterServerBenchSubsystem::Deinitialize( )
+{
+	FWorldDelegates::OnWorldTickStart.Remove( WorldTickStartHandle );
+	FCoreDelegates::OnEndFrame.Remove( EndFrameHandle );
+
+	Super::Deinitialize( );
+}
+
+void UShooterServerBenchSubsystem::OnWorldTickStart( UWorld* World, ELevelTick TickType, float DeltaSeconds )
+{
+	if ( World == GetGameInstance( )->GetWorld( ) )
+	{
+		FrameStartCycles = FPlatformTime::Cycles64( );
+	}
+}
+
+void UShooterServerBenchSubsystem::OnEndFrame( )
+{
+	if ( Phase != EBenchPhase::Idle && FrameStartCycles != 0 )
+	{
+		GameThreadMs += FPlatformTime::ToMilliseconds64( FPlatformTime::Cycles64( ) - FrameStartCycles );
+		Frames++;
+	}
+	FrameStartCycles = 0;
+}
+
+void UShooterServerBenchSubsystem::OnLevelStarted( UWorld* World )
+{
+	if ( NumPlayers <= 0 || Phase != EBenchPhase::Idle )
+	{
+		return;
+	}
+	if ( World->GetNetMode( ) == NM_Client )
+	{
+		return;
+	}
+
+	UE_LOG( LogShooter, Log, TEXT( "ServerTickBenchmark: timing %d players on the %s target" ), NumPlayers, UE_SERVER ? TEXT( "server" ) : TEXT( "game" ) );
+	SetPhase( EBenchPhase::BaselineWarmup );
+}
+
+bool UShooterServerBenchSubsystem::IsTickable( ) const
+{
+	return !IsTemplate( ) && Phase != EBenchPhase::Idle;
+}
+
+TStatId UShooterServerBenchSubsystem::GetStatId( ) const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT( UShooterServerBenchSubsystem, STATGROUP_Tickables );
+}
+
+UWorld* UShooterServerBenchSubsystem::GetTickableGameObjectWorld( ) const
+{
+	return GetGameInstance( )->GetWorld( );
+}
+
+void UShooterServerBenchSubsystem::SetPhase( EBenchPhase NewPhase )
+{
+	Phase = NewPhase;
+	PhaseStartSeconds = FPlatformTime::Seconds( );
+	GameThreadMs = 0.0;
+	Frames = 0;
+}
+
+void UShooterServerBenchSubsystem::Tick( float DeltaTime )
+{
+	UpdatePlayers( DeltaTime );
+
+	const double PhaseSeconds { FPlatformTime::Seconds( ) - PhaseStartSeconds };
+
+	switch ( Phase )
+	{
+	case EBenchPhase::BaselineWarmup:
+		if ( PhaseSeconds >= WarmupSeconds )
+		{
+			SetPhase( EBenchPhase::Baseline );
+		}
+		break;
+
+	case EBenchPhase::Baseline:
+		if ( PhaseSeconds >= MeasureSeconds )
+		{
+			BaselineMs = GameThreadMs / FMath::Max( Frames, 1 );
+			if ( !SpawnPlayers( GetGameInstance( )->GetWorld( ) ) )
+			{
+				UE_LOG( LogShooter, Error, TEXT( "ServerTickBenchmark: couldn't spawn any players, giving up" ) );
+				SetPhase( EBenchPhase::Idle );
+				FinishBenchmarkRun( false );
+				break;
+			}
+			SetPhase( EBenchPhase::LoadedWarmup );
+		}
+		break;
+
+	case EBenchPhase::LoadedWarmup:
+		if ( PhaseSeconds >= WarmupSeconds )
+		{
+			SetPhase( EBenchPhase::Loaded );
+		}
+		break;
+
+	case EBenchPhase::Loaded:
+		if ( PhaseSeconds >= MeasureSeconds )
+		{
+			FinishBenchmark( );
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+bool UShooterServerBenchSubsystem::SpawnPlayers( UWorld* World )
+{
+	// the game mode's pawn is the Blueprint character, with its mesh, anim Blueprint and default weapon
+	const AGameModeBase* GameMode = World ? World->GetAuthGameMode( ) : nullptr;
+	UClass* PlayerClass = GameMode ? GameMode->DefaultPawnClass.Get( ) : nullptr;
+	if ( PlayerClass == nullptr || !PlayerClass->IsChildOf<AShooterCharacter>( ) )
+	{
+		UE_LOG( LogShooter, Error, TEXT( "ServerTickBenchmark: the default pawn isn't a ShooterCharacter" ) );
+		return false;
+	}
+
+	const AActor* PlayerStart = GameMode->FindPlayerStart( nullptr );
+	const FVector Origin { PlayerStart ? PlayerStart->GetActorLocation( ) : FVector::ZeroVector };
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	// same placement on both targets
+	FRandomStream RandomStream( NumPlayers );
+	for ( int32 PlayerIndex = 0; PlayerIndex < NumPlayers; PlayerIndex++ )
+	{
+		const FVector Offset { RandomStream.FRandRange( -SpawnRadius, SpawnRadius ), RandomStream.FRandRange( -SpawnRadius, SpawnRadius ), 0.f };
+		const FRotator Facing { 0.f, RandomStream.FRandRange( 0.f, 360.f ), 0.f };
+		AShooterCharacter* Character = World->SpawnActor<AShooterCharacter>( PlayerClass, Origin + Offset, Facing, SpawnParams );
+		if ( Character )
+		{
+			Character->SpawnDefaultController( );
+			Players.Add( { Character, RandomStream.FRandRange( 0.f, BurstSeconds ), false } );
+		}
+	}
+	return Players.Num( ) > 0;
+}
+
+void UShooterServerBenchSubsystem::UpdatePlayers( float DeltaTime )
+{
+	for ( FBenchPlayer& Player : Players )
+	{
+		AShooterCharacter* Character = Player.Character.Get( );
+		if ( Character == nullptr )
+		{
+			continue;
+		}
+		if ( Character->IsDead( ) )
+		{
+			Character->Revive( );
+		}
+
+		// turn and fire in bursts, like players trading shots
+		Character->AddActorWorldRotation( FRotator( 0.f, 45.f * DeltaTime, 0.f ) );
+		Player.FireTimer -= DeltaTime;
+		if ( Player.FireTimer <= 0.f )
+		{
+			Player.bFiring = !Player.bFiring;
+			Player.FireTimer = Player.bFiring ? BurstSeconds : PauseSeconds;
+			Character->SetTriggerHeld( Player.bFiring );
+		}
+	}
+}
+
+void UShooterServerBenchSubsystem::FinishBenchmark( )
+{
+	const double LoadedMs { GameThreadMs / FMath::Max( Frames, 1 ) };
+	const double MsPerPlayer { ( LoadedMs - BaselineMs ) / FMath::Max( Players.Num( ), 1 ) };
+
+	const FString Filename { FPaths::ProjectSavedDir( ) / TEXT( "ServerBench" ) / TEXT( "TickCost.csv" ) };
+	const FString Row { FString::Printf( TEXT( "%s,%s,%d,%d,%.3f,%.3f,%.4f\n" ), UE_SERVER ? TEXT( "Server" ) : TEXT( "Game" ),
+		*UWorld::RemovePIEPrefix( GetGameInstance( )->GetWorld( )->GetMapName( ) ), Players.Num( ), Frames, BaselineMs, LoadedMs, MsPerPlayer ) };
+	UE_LOG( LogShooter, Log, TEXT( "ServerTickBenchmark: %s" ), *Row );
+	SaveBenchmarkResults( TEXT( "ServerTickBenchmark" ), Filename, TEXT( "Target,Map,Players,Frames,BaselineGameThreadMs,LoadedGameThreadMs,MsPerPlayer\n" ), Row, true );
+
+	for ( const FBenchPlayer& Player : Players )
+	{
+		if ( AShooterCharacter* Character = Player.Character.Get( ) )
+		{
+			Character->SetTriggerHeld( false );
+		}
+	}
+	Players.Reset( );
+	SetPhase( EBenchPhase::Idle );
+
+	FinishBenchmarkRun( );
+}
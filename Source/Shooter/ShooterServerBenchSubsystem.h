@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+#include "ShooterLevelSubsystem.h"
+#include "ShooterServerBenchSubsystem.generated.h"
+
+class AShooterCharacter;
+
+/**
+ * Headless server tick cost per player. Run the same map on both targets, e.g.
+ *
+ * ShooterServer Factory -ServerTickBenchmark=32 -log
+ * Shooter Factory?listen -ServerTickBenchmark=32 -nullrhi -nosound
+ *
+ * Times the game thread with no players, then spawns the requested number of characters that
+ * fire in bursts and times it again. Appends the per-player difference, tagged with the target,
+ * to Saved/ServerBench/TickCost.csv and exits.
+ */
+UCLASS()
+class SHOOTER_API UShooterServerBenchSubsystem : public UShooterLevelSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize( FSubsystemCollectionBase& Collection ) override;
+	virtual void Deinitialize( ) override;
+
+	/* start timing the empty level; called by the game mode */
+	virtual void OnLevelStarted( UWorld* World ) override;
+
+	// FTickableGameObject
+	virtual void Tick( float DeltaTime ) override;
+	virtual bool IsTickable( ) const override;
+	virtual TStatId GetStatId( ) const override;
+	virtual UWorld* GetTickableGameObjectWorld( ) const override;
+
+private:
+	enum class EBenchPhase : uint8
+	{
+		Idle,
+		BaselineWarmup,
+		Baseline,
+		LoadedWarmup,
+		Loaded
+	};
+
+	/* spawn the players around the player start; false if the default pawn can't be used */
+	bool SpawnPlayers( UWorld* World );
+
+	void UpdatePlayers( float DeltaTime );
+
+	void FinishBenchmark( );
+
+	void SetPhase( EBenchPhase NewPhase );
+
+	/* time the game thread from the start of the world tick to the end of the frame, which leaves out the wait for the server tick rate */
+	void OnWorldTickStart( UWorld* World, ELevelTick TickType, float DeltaSeconds );
+	void OnEndFrame( );
+
+	EBenchPhase Phase { EBenchPhase::Idle };
+	double PhaseStartSeconds { 0.0 };
+
+	int32 NumPlayers { 0 };
+
+	struct FBenchPlayer
+	{
+		TWeakObjectPtr<AShooterCharacter> Character;
+		float FireTimer;
+		bool bFiring;
+	};
+	TArray<FBenchPlayer> Players;
+
+	/* game thread time summed over the phase being measured */
+	double GameThreadMs { 0.0 };
+	int32 Frames { 0 };
+	uint64 FrameStartCycles { 0 };
+
+	FDelegateHandle WorldTickStartHandle;
+	FDelegateHandle EndFrameHandle;
+
+	double BaselineMs { 0.0 };
+};
@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterShowerComponent.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "Components/AudioComponent.h"
+
+UShooterShowerComponent::UShooterShowerComponent( )
+{
+	Duration = 0.5f;
+}
+
+void UShooterShowerComponent::BeginPlay( )
+{
+	if ( const AActor* Owner = GetOwner( ) )
+	{
+		TInlineComponentArray<UParticleSystemComponent*> OwnerParticles( Owner );
+		for ( UParticleSystemComponent* Component : OwnerParticles )
+		{
+			if ( EffectTag == NAME_None || Component->ComponentHasTag( EffectTag ) )
+			{
+				Particles.Add( Component );
+			}
+		}
+		TInlineComponentArray<UAudioComponent*> OwnerSounds( Owner );
+		for ( UAudioComponent* Component : OwnerSounds )
+		{
+			if ( EffectTag == NAME_None || Component->ComponentHasTag( EffectTag ) )
+			{
+				Sounds.Add( Component );
+			}
+		}
+	}
+	SetEffectsActive( bStartAtEnd );
+
+	Super::BeginPlay( );
+}
+
+void UShooterShowerComponent::ReadSnapshot( const FShooterActionSnapshot& Snapshot )
+{
+	SetEffectsActive( Snapshot.Progress > 0.f );
+
+	Super::ReadSnapshot( Snapshot );
+}
+
+void UShooterShowerComponent::ApplyActionAlpha( float Alpha )
+{
+	for ( UAudioComponent* Sound : Sounds )
+	{
+		Sound->SetVolumeMultiplier( Alpha );
+	}
+
+	Super::ApplyActionAlpha( Alpha );
+}
+
+void UShooterShowerComponent::OnTransitionStarted( bool bForward )
+{
+	if ( bForward )
+	{
+		SetEffectsActive( true );
+	}
+	else
+	{
+		// let the spray die out naturally while the sound fades
+		for ( UParticleSystemComponent* Particle : Particles )
+		{
+			Particle->Deactivate( );
+		}
+	}
+}
+
+void UShooterShowerComponent::OnTransitionFinished( bool bForward )
+{
+	if ( !bForward )
+	{
+		SetEffectsActive( false );
+	}
+}
+
+void UShooterShowerComponent::SetEffectsActive( bool bActive )
+{
+	for ( UParticleSystemComponent* Particle : Particles )
+	{
+		if ( bActive )
+		{
+			Particle->Activate( );
+		}
+		else
+		{
+			Particle->Deactivate( );
+		}
+	}
+	for ( UAudioComponent* Sound : Sounds )
+	{
+		if ( bActive )
+		{
+			if ( !Sound->IsPlaying( ) )
+			{
+				Sound->Play( );
+			}
+		}
+		else
+		{
+			Sound->Stop( );
+		}
+	}
+}
@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ShooterActionComponent.h"
+#include "ShooterShowerComponent.generated.h"
+
+class UParticleSystemComponent;
+class UAudioComponent;
+
+/**
+ * Turns the owner's particle and audio components on and off, fading the sound over Duration.
+ * Effects are only activated while the shower is on, so an idle shower costs nothing.
+ */
+UCLASS( Blueprintable, ClassGroup = ( Custom ), meta = ( BlueprintSpawnableComponent ) )
+class SHOOTER_API UShooterShowerComponent : public UShooterActionComponent
+{
+	GENERATED_BODY()
+
+public:
+	UShooterShowerComponent( );
+
+	UFUNCTION( BlueprintCallable, Category = Shower )
+	void TurnOn( ) { PlayForward( ); }
+
+	UFUNCTION( BlueprintCallable, Category = Shower )
+	void TurnOff( ) { PlayReverse( ); }
+
+	virtual void ReadSnapshot( const FShooterActionSnapshot& Snapshot ) override;
+
+protected:
+	virtual void BeginPlay( ) override;
+	virtual void ApplyActionAlpha( float Alpha ) override;
+	virtual void OnTransitionStarted( bool bForward ) override;
+	virtual void OnTransitionFinished( bool bForward ) override;
+
+private:
+	void SetEffectsActive( bool bActive );
+
+	/* only drive components with this tag; leave empty to drive every particle and audio component on the owner */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Shower, meta = ( AllowPrivateAccess = "true" ) )
+	FName EffectTag;
+
+	UPROPERTY( Transient )
+	TArray<UParticleSystemComponent*> Particles;
+
+	UPROPERTY( Transient )
+	TArray<UAudioComponent*> Sounds;
+};
@@ -0,0 +1,373 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterSoakSubsystem.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GameFramework/GameModeBase.h"
+#include "HAL/FileManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectIterator.h"
+#include "ShooterCharacter.h"
+#include "Shooter.h"
+#include "Weapon.h"
+
+static TAutoConsoleVariable<float> CVarSoakSampleInterval(
+	TEXT( "shooter.Soak.SampleInterval" ),
+	30.f,
+	TEXT( "Seconds between soak samples" ) );
+
+static TAutoConsoleVariable<int32> CVarSoakMinLive(
+	TEXT( "shooter.Soak.MinLive" ),
+	20,
+	TEXT( "Classes with fewer live objects than this are only written while they churn, and never flagged" ) );
+
+static TAutoConsoleVariable<int32> CVarSoakGrowthWindow(
+	TEXT( "shooter.Soak.GrowthWindow" ),
+	10,
+	TEXT( "A class is flagged when its live count hasn't dropped over this many samples and has risen overall" ) );
+
+static TAutoConsoleVariable<float> CVarSoakWeaponSwapInterval(
+	TEXT( "shooter.Soak.WeaponSwapInterval" ),
+	8.f,
+	TEXT( "Seconds between each soak bot picking up a fresh weapon" ) );
+
+namespace
+{
+	const float SoakBurstSeconds { 2.f };
+	const float SoakPauseSeconds { 1.5f };
+	/* a dropped weapon lies this long, overlapping the bot, before it's picked up */
+	const float SoakPickupSeconds { 1.f };
+	const float SoakBotSpawnRadius { 800.f };
+	const double BytesPerMB { 1024.0 * 1024.0 };
+}
+
+void UShooterSoakSubsystem::Initialize( FSubsystemCollectionBase& Collection )
+{
+	Super::Initialize( Collection );
+
+	float SoakMinutes { 0.f };
+	FParse::Value( FCommandLine::Get( ), TEXT( "Soak=" ), SoakMinutes );
+	FParse::Value( FCommandLine::Get( ), TEXT( "SoakBots=" ), RequestedBots );
+	if ( SoakMinutes <= 0.f )
+	{
+		return;
+	}
+
+	SoakSeconds = SoakMinutes * 60.0;
+	SoakStartSeconds = FPlatformTime::Seconds( );
+	LastSampleSeconds = SoakStartSeconds;
+	OutputDir = FPaths::ProjectSavedDir( ) / TEXT( "Soak" ) / FDateTime::Now( ).ToString( );
+
+	FFileHelper::SaveStringToFile( TEXT( "Seconds,Class,Live,CreatedPerSec,DestroyedPerSec\n" ), *( OutputDir / TEXT( "Classes.csv" ) ) );
+	FFileHelper::SaveStringToFile( TEXT( "Seconds,UsedPhysicalMB,PeakUsedPhysicalMB,UsedVirtualMB,UObjects\n" ), *( OutputDir / TEXT( "Memory.csv" ) ) );
+
+	GUObjectArray.AddUObjectCreateListener( this );
+	GUObjectArray.AddUObjectDeleteListener( this );
+	bListening = true;
+
+	UE_LOG( LogShooter, Log, TEXT( "Soaking for %.0f minutes, writing to %s" ), SoakMinutes, *OutputDir );
+}
+
+void UShooterSoakSubsystem::Deinitialize( )
+{
+	if ( IsSoaking( ) )
+	{
+		FinishSoak( );
+	}
+	StopListening( );
+
+	Super::Deinitialize( );
+}
+
+void UShooterSoakSubsystem::StopListening( )
+{
+	if ( bListening )
+	{
+		GUObjectArray.RemoveUObjectCreateListener( this );
+		GUObjectArray.RemoveUObjectDeleteListener( this );
+		bListening = false;
+	}
+}
+
+void UShooterSoakSubsystem::OnLevelStarted( UWorld* World )
+{
+	Bots.Reset( );
+	if ( !IsSoaking( ) || RequestedBots <= 0 )
+	{
+		return;
+	}
+
+	// the game mode's pawn is the Blueprint character, with its mesh and default weapon set up
+	const AGameModeBase* GameMode = World->GetAuthGameMode( );
+	UClass* BotClass = GameMode ? GameMode->DefaultPawnClass.Get( ) : nullptr;
+	if ( BotClass == nullptr || !BotClass->IsChildOf<AShooterCharacter>( ) )
+	{
+		UE_LOG( LogShooter, Warning, TEXT( "Soak: the default pawn isn't a ShooterCharacter, running without soak bots" ) );
+		return;
+	}
+
+	const AActor* PlayerStart = GameMode->FindPlayerStart( nullptr );
+	const FVector Origin { PlayerStart ? PlayerStart->GetActorLocation( ) : FVector::ZeroVector };
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	for ( int32 BotIndex = 0; BotIndex < RequestedBots; BotIndex++ )
+	{
+		const FVector2D Offset { FMath::RandPointInCircle( SoakBotSpawnRadius ) };
+		const FRotator Facing { 0.f, FMath::FRandRange( 0.f, 360.f ), 0.f };
+		AShooterCharacter* Character = World->SpawnActor<AShooterCharacter>( BotClass, Origin + FVector( Offset, 0.f ), Facing, SpawnParams );
+		if ( Character )
+		{
+			Character->SpawnDefaultController( );
+			// stagger the bots so bursts and swaps don't all land on the same frame
+			Bots.Add( { Character, FMath::FRandRange( 0.f, SoakBurstSeconds ), FMath::FRandRange( 0.f, CVarSoakWeaponSwapInterval.GetValueOnGameThread( ) ), false } );
+		}
+	}
+
+	UE_LOG( LogShooter, Log, TEXT( "Soak: spawned %d bots" ), Bots.Num( ) );
+}
+
+bool UShooterSoakSubsystem::IsTickable( ) const
+{
+	return !IsTemplate( ) && IsSoaking( );
+}
+
+TStatId UShooterSoakSubsystem::GetStatId( ) const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT( UShooterSoakSubsystem, STATGROUP_Tickables );
+}
+
+UWorld* UShooterSoakSubsystem::GetTickableGameObjectWorld( ) const
+{
+	return GetGameInstance( )->GetWorld( );
+}
+
+void UShooterSoakSubsystem::Tick( float DeltaTime )
+{
+	UpdateBots( DeltaTime );
+
+	const double Now { FPlatformTime::Seconds( ) };
+	if ( Now - LastSampleSeconds >= CVarSoakSampleInterval.GetValueOnGameThread( ) )
+	{
+		TakeSample( );
+	}
+	if ( Now - SoakStartSeconds >= SoakSeconds )
+	{
+		FinishSoak( );
+	}
+}
+
+void UShooterSoakSubsystem::UpdateBots( float DeltaTime )
+{
+	for ( FSoakBot& Bot : Bots )
+	{
+		AShooterCharacter* Character = Bot.Character.Get( );
+		if ( Character == nullptr )
+		{
+			continue;
+		}
+
+		// bots shoot each other; keep the soak going at full strength
+		if ( Character->IsDead( ) )
+		{
+			Character->Revive( );
+		}
+
+		// sweep around so shots land on different surfaces
+		Character->AddActorWorldRotation( FRotator( 0.f, 30.f * DeltaTime, 0.f ) );
+
+		Bot.FireTimer -= DeltaTime;
+		if ( Bot.FireTimer <= 0.f )
+		{
+			Bot.bFiring = !Bot.bFiring;
+			Bot.FireTimer = Bot.bFiring ? SoakBurstSeconds : SoakPauseSeconds;
+			Character->SetTriggerHeld( Bot.bFiring );
+		}
+
+		Bot.SwapTimer -= DeltaTime;
+		if ( Bot.SwapTimer <= 0.f )
+		{
+			if ( AWeapon* Pickup = Bot.Pickup.Get( ) )
+			{
+				Character->PickUpWeapon( Pickup );
+				Bot.Pickup.Reset( );
+				Bot.SwapTimer = CVarSoakWeaponSwapInterval.GetValueOnGameThread( );
+			}
+			else
+			{
+				// at the bot's feet, so the item's area sphere overlaps it the way a player walking up would
+				const FVector Feet { Character->GetActorLocation( ) - FVector( 0.f, 0.f, Character->GetSimpleCollisionHalfHeight( ) ) };
+				Bot.Pickup = Character->DropDefaultWeapon( Feet + Character->GetActorForwardVector( ) * 50.f );
+				Bot.SwapTimer = Bot.Pickup.IsValid( ) ? SoakPickupSeconds : CVarSoakWeaponSwapInterval.GetValueOnGameThread( );
+			}
+		}
+	}
+}
+
+void UShooterSoakSubsystem::NotifyUObjectCreated( const UObjectBase* Object, int32 Index )
+{
+	const FName ClassName { Object->GetClass( )->GetFName( ) };
+
+	FScopeLock Lock( &ChurnLock );
+	int32 ClassIndex;
+	if ( const int32* Existing = ClassIndices.Find( ClassName ) )
+	{
+		ClassIndex = *Existing;
+	}
+	else
+	{
+		ClassIndex = ClassChurns.Add( { ClassName, 0, 0, { }, false } );
+		ClassIndices.Add( ClassName, ClassIndex );
+	}
+	ClassChurns[ClassIndex].Created++;
+
+	if ( Index >= ObjectClasses.Num( ) )
+	{
+		const int32 OldNum { ObjectClasses.Num( ) };
+		ObjectClasses.AddUninitialized( Index + 1 - OldNum );
+		for ( int32 Slot = OldNum; Slot < ObjectClasses.Num( ); Slot++ )
+		{
+			ObjectClasses[Slot] = INDEX_NONE;
+		}
+	}
+	ObjectClasses[Index] = ClassIndex;
+}
+
+void UShooterSoakSubsystem::NotifyUObjectDeleted( const UObjectBase* Object, int32 Index )
+{
+	// the object's class may already be gone, so go by what was recorded at creation
+	FScopeLock Lock( &ChurnLock );
+	if ( ObjectClasses.IsValidIndex( Index ) && ObjectClasses[Index] != INDEX_NONE )
+	{
+		ClassChurns[ObjectClasses[Index]].Destroyed++;
+		ObjectClasses[Index] = INDEX_NONE;
+	}
+}
+
+void UShooterSoakSubsystem::OnUObjectArrayShutdown( )
+{
+	StopListening( );
+}
+
+bool UShooterSoakSubsystem::IsGrowingMonotonically( const FClassChurn& ClassChurn ) const
+{
+	const int32 Window { FMath::Max( CVarSoakGrowthWindow.GetValueOnGameThread( ), 2 ) };
+	const TArray<int32>& History = ClassChurn.LiveHistory;
+	if ( History.Num( ) < Window || History.Last( ) < CVarSoakMinLive.GetValueOnGameThread( ) )
+	{
+		return false;
+	}
+
+	const int32 First { History.Num( ) - Window };
+	for ( int32 Sample = First + 1; Sample < History.Num( ); Sample++ )
+	{
+		if ( History[Sample] < History[Sample - 1] )
+		{
+			return false;
+		}
+	}
+	return History.Last( ) > History[First];
+}
+
+void UShooterSoakSubsystem::TakeSample( )
+{
+	const double Now { FPlatformTime::Seconds( ) };
+	const double Interval { FMath::Max( Now - LastSampleSeconds, 0.001 ) };
+	const double Elapsed { Now - SoakStartSeconds };
+	LastSampleSeconds = Now;
+
+	// live counts come from the object array itself, so objects from before the soak are counted too
+	TMap<FName, int32> LiveCounts;
+	int32 NumObjects { 0 };
+	for ( TObjectIterator<UObject> It; It; ++It )
+	{
+		LiveCounts.FindOrAdd( It->GetClass( )->GetFName( ) )++;
+		NumObjects++;
+	}
+
+	const int32 MinLive { CVarSoakMinLive.GetValueOnGameThread( ) };
+	FString ClassRows;
+	TArray<FName> NewlyFlagged;
+	{
+		FScopeLock Lock( &ChurnLock );
+		for ( const TPair<FName, int32>& LiveCount : LiveCounts )
+		{
+			if ( !ClassIndices.Contains( LiveCount.Key ) )
+			{
+				ClassIndices.Add( LiveCount.Key, ClassChurns.Add( { LiveCount.Key, 0, 0, { }, false } ) );
+			}
+		}
+
+		for ( FClassChurn& ClassChurn : ClassChurns )
+		{
+			const int32 Live { LiveCounts.FindRef( ClassChurn.ClassName ) };
+			ClassChurn.LiveHistory.Add( Live );
+			if ( Live >= MinLive || ClassChurn.Created > 0 || ClassChurn.Destroyed > 0 )
+			{
+				ClassRows += FString::Printf( TEXT( "%.0f,%s,%d,%.2f,%.2f\n" ), Elapsed, *ClassChurn.ClassName.ToString( ), Live,
+					ClassChurn.Created / Interval, ClassChurn.Destroyed / Interval );
+			}
+			ClassChurn.Created = 0;
+			ClassChurn.Destroyed = 0;
+
+			if ( !ClassChurn.bFlagged && IsGrowingMonotonically( ClassChurn ) )
+			{
+				ClassChurn.bFlagged = true;
+				NewlyFlagged.Add( ClassChurn.ClassName );
+			}
+		}
+	}
+
+	const FPlatformMemoryStats MemoryStats { FPlatformMemory::GetStats( ) };
+	const FString MemoryRow { FString::Printf( TEXT( "%.0f,%.1f,%.1f,%.1f,%d\n" ), Elapsed,
+		MemoryStats.UsedPhysical / BytesPerMB, MemoryStats.PeakUsedPhysical / BytesPerMB, MemoryStats.UsedVirtual / BytesPerMB, NumObjects ) };
+
+	// appended as we go so a crash still leaves the series up to it
+	FFileHelper::SaveStringToFile( ClassRows, *( OutputDir / TEXT( "Classes.csv" ) ), FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get( ), FILEWRITE_Append );
+	FFileHelper::SaveStringToFile( MemoryRow, *( OutputDir / TEXT( "Memory.csv" ) ), FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get( ), FILEWRITE_Append );
+
+	for ( const FName& ClassName : NewlyFlagged )
+	{
+		UE_LOG( LogShooter, Warning, TEXT( "Soak: %s live count has grown for %d samples" ), *ClassName.ToString( ), CVarSoakGrowthWindow.GetValueOnGameThread( ) );
+	}
+}
+
+void UShooterSoakSubsystem::FinishSoak( )
+{
+	TakeSample( );
+	StopListening( );
+
+	FString Report { TEXT( "Class,FirstLive,LastLive,Samples,StillGrowing\n" ) };
+	int32 NumFlagged { 0 };
+	{
+		FScopeLock Lock( &ChurnLock );
+		for ( const FClassChurn& ClassChurn : ClassChurns )
+		{
+			if ( ClassChurn.bFlagged )
+			{
+				Report += FString::Printf( TEXT( "%s,%d,%d,%d,%d\n" ), *ClassChurn.ClassName.ToString( ),
+					ClassChurn.LiveHistory[0], ClassChurn.LiveHistory.Last( ), ClassChurn.LiveHistory.Num( ), IsGrowingMonotonically( ClassChurn ) ? 1 : 0 );
+				NumFlagged++;
+			}
+		}
+	}
+	FFileHelper::SaveStringToFile( Report, *( OutputDir / TEXT( "Growth.csv" ) ) );
+	UE_LOG( LogShooter, Log, TEXT( "Soak finished after %.0f minutes, %d classes flagged for growth; see %s" ),
+		( FPlatformTime::Seconds( ) - SoakStartSeconds ) / 60.0, NumFlagged, *OutputDir );
+
+	for ( const FSoakBot& Bot : Bots )
+	{
+		if ( AShooterCharacter* Character = Bot.Character.Get( ) )
+		{
+			Character->SetTriggerHeld( false );
+		}
+	}
+	Bots.Reset( );
+	SoakSeconds = 0.0;
+
+	FinishBenchmarkRun( );
+}
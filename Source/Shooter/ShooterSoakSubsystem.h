@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+#include "UObject/UObjectArray.h"
+#include "ShooterLevelSubsystem.h"
+#include "ShooterSoakSubsystem.generated.h"
+
+/**
+ * Long-running soak test for tracking down memory creep. Started with -Soak=<minutes>, e.g.
+ *
+ * Factory -Soak=240 -SoakBots=8 -ShooterBots=200 -nullrhi
+ *
+ * Soak bots fire in bursts and keep dropping fresh weapons at their feet and picking them up, so
+ * muzzle flash and impact particles, AWeapon/AItem actors, their overlaps and pickup widgets are
+ * created and destroyed all session long. At every sample the per-class UObject live counts, creation and destruction
+ * rates and process memory are appended to Saved/Soak/<start time>/. Classes whose live count
+ * keeps rising across samples are flagged.
+ */
+UCLASS()
+class SHOOTER_API UShooterSoakSubsystem : public UShooterLevelSubsystem, public FTickableGameObject,
+	public FUObjectArray::FUObjectCreateListener, public FUObjectArray::FUObjectDeleteListener
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize( FSubsystemCollectionBase& Collection ) override;
+	virtual void Deinitialize( ) override;
+
+	/* spawn the soak bots into a level that has just started; called by the game mode */
+	virtual void OnLevelStarted( UWorld* World ) override;
+
+	FORCEINLINE bool IsSoaking( ) const { return SoakSeconds > 0.0; }
+
+	// FTickableGameObject
+	virtual void Tick( float DeltaTime ) override;
+	virtual bool IsTickable( ) const override;
+	virtual TStatId GetStatId( ) const override;
+	virtual UWorld* GetTickableGameObjectWorld( ) const override;
+
+	// FUObjectArray listeners, may be called from any thread
+	virtual void NotifyUObjectCreated( const UObjectBase* Object, int32 Index ) override;
+	virtual void NotifyUObjectDeleted( const UObjectBase* Object, int32 Index ) override;
+	virtual void OnUObjectArrayShutdown( ) override;
+
+private:
+	struct FClassChurn
+	{
+		FName ClassName;
+		/* since the last sample */
+		int32 Created;
+		int32 Destroyed;
+		/* live count at each sample the class was written at */
+		TArray<int32> LiveHistory;
+		bool bFlagged;
+	};
+
+	struct FSoakBot
+	{
+		TWeakObjectPtr<class AShooterCharacter> Character;
+		float FireTimer;
+		float SwapTimer;
+		bool bFiring;
+		/* weapon dropped for the bot, waiting to be picked up */
+		TWeakObjectPtr<class AWeapon> Pickup;
+	};
+
+	void StopListening( );
+
+	void UpdateBots( float DeltaTime );
+
+	void TakeSample( );
+
+	/* does ClassChurn's recent history only go up */
+	bool IsGrowingMonotonically( const FClassChurn& ClassChurn ) const;
+
+	void FinishSoak( );
+
+	/* total soak length, 0 when not soaking */
+	double SoakSeconds { 0.0 };
+	double SoakStartSeconds { 0.0 };
+	double LastSampleSeconds { 0.0 };
+
+	int32 RequestedBots { 8 };
+	TArray<FSoakBot> Bots;
+
+	/* Saved/Soak/<start time> */
+	FString OutputDir;
+
+	/* guards ClassChurns, ClassIndices and ObjectClasses against the listeners */
+	FCriticalSection ChurnLock;
+	TArray<FClassChurn> ClassChurns;
+	TMap<FName, int32> ClassIndices;
+
+	/* ClassChurns index of each live object by its GUObjectArray index, INDEX_NONE for objects from before the soak */
+	TArray<int32> ObjectClasses;
+
+	bool bListening { false };
+};
@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterSplineMoverComponent.h"
+#include "Components/SplineComponent.h"
+#include "Engine/World.h"
+#include "ShooterSplineMoverSubsystem.h"
+
+UShooterSplineMoverComponent::UShooterSplineMoverComponent( ) :
+	SplineActor( nullptr ),
+	MovedComponentName( NAME_None ),
+	Speed( 500.f ),
+	Mode( ESplineMoverMode::ESMM_Loop ),
+	bFollowRotation( true ),
+	bPlayOnBeginPlay( true ),
+	Distance( 0.f ),
+	bPlaying( false ),
+	Direction( 1.f ),
+	PendingDeltaTime( 0.f ),
+	TableIndex( INDEX_NONE ),
+	MovedComponent( nullptr )
+{
+	// the subsystem moves us
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UShooterSplineMoverComponent::BeginPlay( )
+{
+	Super::BeginPlay( );
+
+	if ( UShooterSplineMoverSubsystem* SplineMovers = GetWorld( )->GetSubsystem<UShooterSplineMoverSubsystem>( ) )
+	{
+		SplineMovers->RegisterMover( this );
+	}
+	bPlaying = bPlayOnBeginPlay;
+}
+
+void UShooterSplineMoverComponent::EndPlay( const EEndPlayReason::Type EndPlayReason )
+{
+	if ( UShooterSplineMoverSubsystem* SplineMovers = GetWorld( )->GetSubsystem<UShooterSplineMoverSubsystem>( ) )
+	{
+		SplineMovers->UnregisterMover( this );
+	}
+
+	Super::EndPlay( EndPlayReason );
+}
+
+void UShooterSplineMoverComponent::Play( )
+{
+	bPlaying = true;
+}
+
+void UShooterSplineMoverComponent::Stop( )
+{
+	bPlaying = false;
+	PendingDeltaTime = 0.f;
+}
+
+void UShooterSplineMoverComponent::SetDistance( float NewDistance )
+{
+	Distance = NewDistance;
+}
+
+void UShooterSplineMoverComponent::SetSpeed( float NewSpeed )
+{
+	Speed = NewSpeed;
+}
+
+USplineComponent* UShooterSplineMoverComponent::FindSpline( ) const
+{
+	const AActor* SplineOwner = SplineActor ? SplineActor : GetOwner( );
+	return SplineOwner ? SplineOwner->FindComponentByClass<USplineComponent>( ) : nullptr;
+}
+
+USceneComponent* UShooterSplineMoverComponent::FindMovedComponent( ) const
+{
+	const AActor* Owner = GetOwner( );
+	if ( Owner == nullptr )
+	{
+		return nullptr;
+	}
+	if ( MovedComponentName != NAME_None )
+	{
+		TInlineComponentArray<USceneComponent*> SceneComponents( Owner );
+		for ( USceneComponent* SceneComponent : SceneComponents )
+		{
+			if ( SceneComponent->GetFName( ) == MovedComponentName )
+			{
+				return SceneComponent;
+			}
+		}
+	}
+	return Owner->GetRootComponent( );
+}
@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "ShooterSplineMoverComponent.generated.h"
+
+UENUM( BlueprintType )
+enum class ESplineMoverMode : uint8
+{
+	ESMM_Loop		UMETA( DisplayName = "Loop" ),
+	ESMM_PingPong	UMETA( DisplayName = "Ping Pong" ),
+	ESMM_Once		UMETA( DisplayName = "Once" ),
+
+	ESMM_Max		UMETA( DisplayName = "DefaultMAX" )
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE( FOnSplineMoverReachedEnd );
+
+/**
+ * Moves its owner along a spline. Doesn't tick itself: UShooterSplineMoverSubsystem advances
+ * every mover in one pass per frame using a precomputed arc-length table per spline.
+ */
+UCLASS( ClassGroup = ( Custom ), meta = ( BlueprintSpawnableComponent ) )
+class SHOOTER_API UShooterSplineMoverComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UShooterSplineMoverComponent( );
+
+	UFUNCTION( BlueprintCallable, Category = SplineMover )
+	void Play( );
+
+	UFUNCTION( BlueprintCallable, Category = SplineMover )
+	void Stop( );
+
+	/* jump to Distance along the spline; takes effect on the next update */
+	UFUNCTION( BlueprintCallable, Category = SplineMover )
+	void SetDistance( float NewDistance );
+
+	UFUNCTION( BlueprintCallable, Category = SplineMover )
+	void SetSpeed( float NewSpeed );
+
+	/* the spline the owner follows: SplineActor's spline, or one on the owner */
+	class USplineComponent* FindSpline( ) const;
+
+	/* the component moved along the spline: MovedComponentName, or the owner's root */
+	USceneComponent* FindMovedComponent( ) const;
+
+	/* called once when a Once mover reaches the end, or each time a ping-pong mover turns around */
+	UPROPERTY( BlueprintAssignable, Category = SplineMover )
+	FOnSplineMoverReachedEnd OnReachedEnd;
+
+protected:
+	virtual void BeginPlay( ) override;
+	virtual void EndPlay( const EEndPlayReason::Type EndPlayReason ) override;
+
+private:
+	friend class UShooterSplineMoverSubsystem;
+
+	/* actor whose spline to follow; leave empty to use a spline on the owner */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = SplineMover, meta = ( AllowPrivateAccess = "true" ) )
+	AActor* SplineActor;
+
+	/* owner component to move; leave empty to move the root. Set this when the spline is on the owner itself */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = SplineMover, meta = ( AllowPrivateAccess = "true" ) )
+	FName MovedComponentName;
+
+	/* cm/s along the spline */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = SplineMover, meta = ( AllowPrivateAccess = "true" ) )
+	float Speed;
+
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = SplineMover, meta = ( AllowPrivateAccess = "true" ) )
+	ESplineMoverMode Mode;
+
+	/* face along the spline as well as following it */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = SplineMover, meta = ( AllowPrivateAccess = "true" ) )
+	bool bFollowRotation;
+
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = SplineMover, meta = ( AllowPrivateAccess = "true" ) )
+	bool bPlayOnBeginPlay;
+
+	/* distance along the spline, cm */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = SplineMover, meta = ( AllowPrivateAccess = "true" ) )
+	float Distance;
+
+	UPROPERTY( VisibleInstanceOnly, BlueprintReadOnly, Category = SplineMover, meta = ( AllowPrivateAccess = "true" ) )
+	bool bPlaying;
+
+	/* 1 forwards, -1 backwards (ping pong) */
+	float Direction;
+
+	/* seconds not yet applied while this mover is on a coarse update rate */
+	float PendingDeltaTime;
+
+	/* index of our spline's arc-length table in the subsystem */
+	int32 TableIndex;
+
+	/* resolved from MovedComponentName when registered */
+	UPROPERTY( Transient )
+	USceneComponent* MovedComponent;
+
+public:
+	FORCEINLINE float GetDistance( ) const { return Distance; }
+	FORCEINLINE bool IsPlaying( ) const { return bPlaying; }
+};
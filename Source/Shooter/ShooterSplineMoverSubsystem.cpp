@@ -0,0 +1,273 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterSplineMoverSubsystem.h"
+#include "Components/SplineComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "ShooterSplineMoverComponent.h"
+#include "ShooterStats.h"
+
+DECLARE_CYCLE_STAT( TEXT( "Spline Movers" ), STAT_SplineMovers, STATGROUP_Shooter );
+DECLARE_DWORD_COUNTER_STAT( TEXT( "Spline Movers Updated" ), STAT_SplineMoversUpdated, STATGROUP_Shooter );
+DECLARE_DWORD_COUNTER_STAT( TEXT( "Spline Movers Coarse" ), STAT_SplineMoversCoarse, STATGROUP_Shooter );
+
+static TAutoConsoleVariable<float> CVarSplineMoverSampleSpacing(
+	TEXT( "shooter.SplineMover.SampleSpacing" ),
+	50.f,
+	TEXT( "Distance between arc-length table samples, cm" ) );
+
+static TAutoConsoleVariable<float> CVarSplineMoverCoarseDistance(
+	TEXT( "shooter.SplineMover.CoarseDistance" ),
+	6000.f,
+	TEXT( "Movers farther than this from every player update at the coarse rate" ) );
+
+static TAutoConsoleVariable<int32> CVarSplineMoverCoarseRate(
+	TEXT( "shooter.SplineMover.CoarseRate" ),
+	4,
+	TEXT( "Far movers update once every this many frames" ) );
+
+void FSplineArcLengthTable::Build( USplineComponent* InSpline, float InSampleSpacing )
+{
+	Spline = InSpline;
+	Length = InSpline->GetSplineLength( );
+
+	const int32 NumSamples { FMath::Max( FMath::CeilToInt( Length / FMath::Max( InSampleSpacing, 1.f ) ), 1 ) + 1 };
+	SampleSpacing = Length / ( NumSamples - 1 );
+
+	Locations.SetNumUninitialized( NumSamples );
+	Rotations.SetNumUninitialized( NumSamples );
+	for ( int32 i = 0; i < NumSamples; i++ )
+	{
+		const float SampleDistance { i * SampleSpacing };
+		Locations[i] = InSpline->GetLocationAtDistanceAlongSpline( SampleDistance, ESplineCoordinateSpace::World );
+		Rotations[i] = InSpline->GetQuaternionAtDistanceAlongSpline( SampleDistance, ESplineCoordinateSpace::World );
+	}
+}
+
+void FSplineArcLengthTable::Sample( float Distance, FVector& OutLocation, FQuat& OutRotation ) const
+{
+	if ( SampleSpacing <= 0.f )
+	{
+		OutLocation = Locations[0];
+		OutRotation = Rotations[0];
+		return;
+	}
+	const float SamplePosition { Distance / SampleSpacing };
+	const int32 Index { FMath::Clamp( FMath::FloorToInt( SamplePosition ), 0, Locations.Num( ) - 2 ) };
+	const float Alpha { FMath::Clamp( SamplePosition - Index, 0.f, 1.f ) };
+	OutLocation = FMath::Lerp( Locations[Index], Locations[Index + 1], Alpha );
+	OutRotation = FQuat::Slerp( Rotations[Index], Rotations[Index + 1], Alpha );
+}
+
+void UShooterSplineMoverSubsystem::RegisterMover( UShooterSplineMoverComponent* Mover )
+{
+	if ( Mover == nullptr )
+	{
+		return;
+	}
+	Mover->TableIndex = FindOrBuildTable( Mover->FindSpline( ) );
+	Mover->MovedComponent = Mover->FindMovedComponent( );
+	Movers.AddUnique( Mover );
+}
+
+void UShooterSplineMoverSubsystem::UnregisterMover( UShooterSplineMoverComponent* Mover )
+{
+	if ( Movers.RemoveSingleSwap( Mover ) == 0 )
+	{
+		return;
+	}
+	const int32 TableIndex { Mover->TableIndex };
+	Mover->TableIndex = INDEX_NONE;
+
+	// drop the spline's table once nothing rides it, so streamed out splines don't pile up
+	const bool bTableInUse { Movers.ContainsByPredicate( [TableIndex]( const UShooterSplineMoverComponent* Other ) { return Other && Other->TableIndex == TableIndex; } ) };
+	if ( !Tables.IsValidIndex( TableIndex ) || bTableInUse )
+	{
+		return;
+	}
+	const int32 LastIndex { Tables.Num( ) - 1 };
+	Tables.RemoveAtSwap( TableIndex, 1, false );
+	for ( UShooterSplineMoverComponent* Other : Movers )
+	{
+		if ( Other && Other->TableIndex == LastIndex )
+		{
+			Other->TableIndex = TableIndex;
+		}
+	}
+}
+
+void UShooterSplineMoverSubsystem::InvalidateSpline( USplineComponent* Spline )
+{
+	for ( FSplineArcLengthTable& Table : Tables )
+	{
+		if ( Table.Spline == Spline )
+		{
+			Table.Build( Spline, CVarSplineMoverSampleSpacing.GetValueOnGameThread( ) );
+		}
+	}
+}
+
+int32 UShooterSplineMoverSubsystem::FindOrBuildTable( USplineComponent* Spline )
+{
+	if ( Spline == nullptr )
+	{
+		return INDEX_NONE;
+	}
+	const int32 Existing { Tables.IndexOfByPredicate( [Spline]( const FSplineArcLengthTable& Table ) { return Table.Spline == Spline; } ) };
+	if ( Existing != INDEX_NONE )
+	{
+		return Existing;
+	}
+	FSplineArcLengthTable& Table = Tables.AddDefaulted_GetRef( );
+	Table.Build( Spline, CVarSplineMoverSampleSpacing.GetValueOnGameThread( ) );
+	return Tables.Num( ) - 1;
+}
+
+bool UShooterSplineMoverSubsystem::IsTickable( ) const
+{
+	const UWorld* World = GetWorld( );
+	return !IsTemplate( ) && World && World->IsGameWorld( ) && Movers.Num( ) > 0;
+}
+
+TStatId UShooterSplineMoverSubsystem::GetStatId( ) const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT( UShooterSplineMoverSubsystem, STATGROUP_Tickables );
+}
+
+bool UShooterSplineMoverSubsystem::AdvanceMover( UShooterSplineMoverComponent* Mover, const FSplineArcLengthTable& Table, float DeltaTime ) const
+{
+	float NewDistance { Mover->Distance + Mover->Speed * Mover->Direction * DeltaTime };
+	bool bReachedEnd { false };
+
+	switch ( Mover->Mode )
+	{
+	case ESplineMoverMode::ESMM_Loop:
+		NewDistance = Table.Length > 0.f ? FMath::Fmod( NewDistance, Table.Length ) : 0.f;
+		if ( NewDistance < 0.f )
+		{
+			NewDistance += Table.Length;
+		}
+		break;
+	case ESplineMoverMode::ESMM_PingPong:
+		if ( NewDistance > Table.Length || NewDistance < 0.f )
+		{
+			// reflect back off the end we passed
+			NewDistance = NewDistance > Table.Length ? 2.f * Table.Length - NewDistance : -NewDistance;
+			NewDistance = FMath::Clamp( NewDistance, 0.f, Table.Length );
+			Mover->Direction = -Mover->Direction;
+			bReachedEnd = true;
+		}
+		break;
+	case ESplineMoverMode::ESMM_Once:
+	default:
+		// only the end we're heading for stops us; a mover starting at 0 isn't done
+		if ( Mover->Direction >= 0.f ? NewDistance >= Table.Length : NewDistance <= 0.f )
+		{
+			NewDistance = FMath::Clamp( NewDistance, 0.f, Table.Length );
+			Mover->bPlaying = false;
+			bReachedEnd = true;
+		}
+		break;
+	}
+
+	Mover->Distance = NewDistance;
+	return bReachedEnd;
+}
+
+void UShooterSplineMoverSubsystem::Tick( float DeltaTime )
+{
+	SCOPE_CYCLE_COUNTER( STAT_SplineMovers );
+
+	FrameCounter++;
+
+	TArray<FVector, TInlineAllocator<4>> ViewLocations;
+	for ( FConstPlayerControllerIterator It = GetWorld( )->GetPlayerControllerIterator( ); It; ++It )
+	{
+		if ( const APlayerController* PlayerController = It->Get( ) )
+		{
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PlayerController->GetPlayerViewPoint( ViewLocation, ViewRotation );
+			ViewLocations.Add( ViewLocation );
+		}
+	}
+
+	const float CoarseDistanceSquared { FMath::Square( CVarSplineMoverCoarseDistance.GetValueOnGameThread( ) ) };
+	const uint32 CoarseRate { static_cast<uint32>( FMath::Max( CVarSplineMoverCoarseRate.GetValueOnGameThread( ), 1 ) ) };
+
+	PendingTransforms.Reset( );
+	PendingMovers.Reset( );
+	TArray<UShooterSplineMoverComponent*, TInlineAllocator<8>> ReachedEnd;
+	int32 CoarseMovers { 0 };
+
+	// advance everything first...
+	for ( int32 MoverIndex = 0; MoverIndex < Movers.Num( ); MoverIndex++ )
+	{
+		UShooterSplineMoverComponent* Mover = Movers[MoverIndex];
+		if ( Mover == nullptr || !Mover->bPlaying || !Tables.IsValidIndex( Mover->TableIndex ) )
+		{
+			continue;
+		}
+		const USceneComponent* UpdatedComponent = Mover->MovedComponent;
+		if ( UpdatedComponent == nullptr )
+		{
+			continue;
+		}
+
+		Mover->PendingDeltaTime += DeltaTime;
+
+		bool bFar { ViewLocations.Num( ) > 0 };
+		const FVector MoverLocation { UpdatedComponent->GetComponentLocation( ) };
+		for ( const FVector& ViewLocation : ViewLocations )
+		{
+			if ( FVector::DistSquared( MoverLocation, ViewLocation ) < CoarseDistanceSquared )
+			{
+				bFar = false;
+				break;
+			}
+		}
+		// stagger coarse movers across frames so they don't all land on the same one
+		if ( bFar )
+		{
+			CoarseMovers++;
+			if ( ( FrameCounter + MoverIndex ) % CoarseRate != 0 )
+			{
+				continue;
+			}
+		}
+
+		const FSplineArcLengthTable& Table = Tables[Mover->TableIndex];
+		if ( AdvanceMover( Mover, Table, Mover->PendingDeltaTime ) )
+		{
+			ReachedEnd.Add( Mover );
+		}
+		Mover->PendingDeltaTime = 0.f;
+
+		FVector Location;
+		FQuat Rotation;
+		Table.Sample( Mover->Distance, Location, Rotation );
+		if ( Mover->Direction < 0.f )
+		{
+			Rotation = Rotation * FQuat( FVector::UpVector, PI );
+		}
+		PendingTransforms.Emplace( Mover->bFollowRotation ? Rotation : UpdatedComponent->GetComponentQuat( ), Location );
+		PendingMovers.Add( Mover );
+	}
+
+	// ...then write every transform back in one go
+	for ( int32 i = 0; i < PendingMovers.Num( ); i++ )
+	{
+		PendingMovers[i]->MovedComponent->SetWorldLocationAndRotation(
+			PendingTransforms[i].GetLocation( ),
+			PendingTransforms[i].GetRotation( ) );
+	}
+
+	for ( UShooterSplineMoverComponent* Mover : ReachedEnd )
+	{
+		Mover->OnReachedEnd.Broadcast( );
+	}
+
+	SET_DWORD_STAT( STAT_SplineMoversUpdated, PendingMovers.Num( ) );
+	SET_DWORD_STAT( STAT_SplineMoversCoarse, CoarseMovers );
+}
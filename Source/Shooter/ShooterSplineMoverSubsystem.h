@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ShooterSplineMoverSubsystem.generated.h"
+
+class UShooterSplineMoverComponent;
+class USplineComponent;
+
+/* world space transforms sampled at even distances along a spline */
+struct FSplineArcLengthTable
+{
+	TWeakObjectPtr<USplineComponent> Spline;
+	float Length;
+	float SampleSpacing;
+	TArray<FVector> Locations;
+	TArray<FQuat> Rotations;
+
+	void Build( USplineComponent* InSpline, float InSampleSpacing );
+
+	/* Distance must be in [0, Length] */
+	void Sample( float Distance, FVector& OutLocation, FQuat& OutRotation ) const;
+};
+
+/**
+ * Advances every UShooterSplineMoverComponent in one pass per frame.
+ * Movers far from every player drop to a coarse update rate.
+ */
+UCLASS()
+class SHOOTER_API UShooterSplineMoverSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	void RegisterMover( UShooterSplineMoverComponent* Mover );
+
+	/* stop advancing Mover, dropping its spline's table if no other mover uses it */
+	void UnregisterMover( UShooterSplineMoverComponent* Mover );
+
+	/* rebuild Spline's arc-length table after its points change */
+	UFUNCTION( BlueprintCallable, Category = SplineMover )
+	void InvalidateSpline( USplineComponent* Spline );
+
+	// FTickableGameObject
+	virtual void Tick( float DeltaTime ) override;
+	virtual bool IsTickable( ) const override;
+	virtual TStatId GetStatId( ) const override;
+	virtual UWorld* GetTickableGameObjectWorld( ) const override { return GetWorld( ); }
+
+private:
+	/* index of Spline's table, building it if needed */
+	int32 FindOrBuildTable( USplineComponent* Spline );
+
+	/* move Mover's distance on by DeltaTime; returns true if it reached an end */
+	bool AdvanceMover( UShooterSplineMoverComponent* Mover, const FSplineArcLengthTable& Table, float DeltaTime ) const;
+
+	UPROPERTY( Transient )
+	TArray<UShooterSplineMoverComponent*> Movers;
+
+	TArray<FSplineArcLengthTable> Tables;
+
+	/* transforms computed this frame, written back after every mover has advanced */
+	TArray<FTransform> PendingTransforms;
+	TArray<UShooterSplineMoverComponent*> PendingMovers;
+
+	/* counts frames so coarse movers can be spread across them */
+	uint32 FrameCounter { 0 };
+};
@@ -0,0 +1,9 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+/* all Shooter gameplay stats show up under "stat Shooter" */
+DECLARE_STATS_GROUP( TEXT( "Shooter" ), STATGROUP_Shooter, STATCAT_Advanced );
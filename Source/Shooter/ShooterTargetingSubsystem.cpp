@@ -0,0 +1,272 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterTargetingSubsystem.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "ShooterCharacter.h"
+#include "ShooterCollision.h"
+#include "ShooterStats.h"
+
+DECLARE_CYCLE_STAT( TEXT( "Target Queries" ), STAT_TargetQueries, STATGROUP_Shooter );
+DECLARE_DWORD_COUNTER_STAT( TEXT( "Target Queries Run" ), STAT_TargetQueriesRun, STATGROUP_Shooter );
+DECLARE_DWORD_COUNTER_STAT( TEXT( "Target Candidates" ), STAT_TargetCandidates, STATGROUP_Shooter );
+DECLARE_DWORD_COUNTER_STAT( TEXT( "Target Visibility Traces" ), STAT_TargetTraces, STATGROUP_Shooter );
+
+static TAutoConsoleVariable<int32> CVarTargetingMaxCandidates(
+	TEXT( "shooter.Targeting.MaxCandidates" ),
+	3,
+	TEXT( "Candidates per query, closest to the aim ray first, that may get a visibility trace" ) );
+
+namespace
+{
+	const int32 CandidateLimit { 8 };
+
+	/* padding positions are far enough away to fail every range test */
+	const float PaddingDistance { 1.0e7f };
+
+	struct FTargetCandidate
+	{
+		int32 Index;
+		float CosAngle;
+		float DistSquared;
+	};
+}
+
+void UShooterTargetingSubsystem::Deinitialize( )
+{
+	Targets.Reset( );
+	PackedTargets.Reset( );
+	StandingQueries.Reset( );
+	StandingResults.Reset( );
+	FreeQueriers.Reset( );
+
+	Super::Deinitialize( );
+}
+
+void UShooterTargetingSubsystem::RegisterTarget( AShooterCharacter* Character )
+{
+	if ( Character )
+	{
+		Targets.AddUnique( Character );
+		RefreshedFrame = MAX_uint64;
+	}
+}
+
+void UShooterTargetingSubsystem::UnregisterTarget( AShooterCharacter* Character )
+{
+	Targets.RemoveSwap( Character );
+	RefreshedFrame = MAX_uint64;
+}
+
+int32 UShooterTargetingSubsystem::AddQuerier( )
+{
+	if ( FreeQueriers.Num( ) > 0 )
+	{
+		return FreeQueriers.Pop( false );
+	}
+	StandingResults.AddDefaulted( );
+	return StandingQueries.AddDefaulted( );
+}
+
+void UShooterTargetingSubsystem::RemoveQuerier( int32& Querier )
+{
+	if ( StandingQueries.IsValidIndex( Querier ) )
+	{
+		StandingQueries[Querier] = FShooterTargetQuery( );
+		StandingResults[Querier] = FShooterTargetResult( );
+		FreeQueriers.Add( Querier );
+	}
+	Querier = INDEX_NONE;
+}
+
+void UShooterTargetingSubsystem::SetQuery( int32 Querier, const FShooterTargetQuery& Query )
+{
+	if ( StandingQueries.IsValidIndex( Querier ) )
+	{
+		StandingQueries[Querier] = Query;
+	}
+}
+
+const FShooterTargetResult& UShooterTargetingSubsystem::GetResult( int32 Querier ) const
+{
+	static const FShooterTargetResult NoResult;
+	return StandingResults.IsValidIndex( Querier ) ? StandingResults[Querier] : NoResult;
+}
+
+bool UShooterTargetingSubsystem::IsTickable( ) const
+{
+	const UWorld* World = GetWorld( );
+	return !IsTemplate( ) && World && World->IsGameWorld( ) && StandingQueries.Num( ) > FreeQueriers.Num( );
+}
+
+TStatId UShooterTargetingSubsystem::GetStatId( ) const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT( UShooterTargetingSubsystem, STATGROUP_Tickables );
+}
+
+void UShooterTargetingSubsystem::Tick( float DeltaTime )
+{
+	// after every actor has ticked, so the rays are this frame's; repack too, since a batch run
+	// earlier this frame packed the targets before they moved
+	RefreshedFrame = MAX_uint64;
+	RunQueries( StandingQueries, StandingResults );
+}
+
+void UShooterTargetingSubsystem::RefreshTargets( )
+{
+	if ( RefreshedFrame == GFrameCounter )
+	{
+		return;
+	}
+	RefreshedFrame = GFrameCounter;
+
+	PackedTargets.Reset( );
+	for ( const TWeakObjectPtr<AShooterCharacter>& Target : Targets )
+	{
+		AShooterCharacter* Character = Target.Get( );
+		if ( Character && !Character->IsDead( ) )
+		{
+			PackedTargets.Add( Character );
+		}
+	}
+
+	const int32 NumPacked { Align( PackedTargets.Num( ), 4 ) };
+	TargetX.SetNumUninitialized( NumPacked, false );
+	TargetY.SetNumUninitialized( NumPacked, false );
+	TargetZ.SetNumUninitialized( NumPacked, false );
+	for ( int32 Index = 0; Index < NumPacked; Index++ )
+	{
+		const FVector Location { Index < PackedTargets.Num( ) ? PackedTargets[Index]->GetActorLocation( ) : FVector( PaddingDistance ) };
+		TargetX[Index] = Location.X;
+		TargetY[Index] = Location.Y;
+		TargetZ[Index] = Location.Z;
+	}
+}
+
+void UShooterTargetingSubsystem::RunQueries( TArrayView<const FShooterTargetQuery> Queries, TArrayView<FShooterTargetResult> OutResults, int32 MaxTraces )
+{
+	SCOPE_CYCLE_COUNTER( STAT_TargetQueries );
+	check( OutResults.Num( ) >= Queries.Num( ) );
+
+	RefreshTargets( );
+
+	const UWorld* World = GetWorld( );
+	const FShooterQueryPreset& Preset = ShooterCollision::GetQueryPreset( EShooterQuery::ESQ_Bullet );
+	const int32 MaxCandidates { FMath::Clamp( CVarTargetingMaxCandidates.GetValueOnGameThread( ), 1, CandidateLimit ) };
+	const VectorRegister Zero { VectorZero( ) };
+
+	int32 QueriesRun { 0 };
+	int32 NumCandidates { 0 };
+	int32 TracesRun { 0 };
+
+	for ( int32 QueryIndex = 0; QueryIndex < Queries.Num( ); QueryIndex++ )
+	{
+		const FShooterTargetQuery& Query = Queries[QueryIndex];
+		FShooterTargetResult& Result = OutResults[QueryIndex];
+		Result = FShooterTargetResult( );
+		if ( Query.Direction.IsZero( ) || PackedTargets.Num( ) == 0 )
+		{
+			continue;
+		}
+		QueriesRun++;
+
+		const float CosHalfAngle { FMath::Cos( FMath::DegreesToRadians( FMath::Clamp( Query.HalfAngleDegrees, 0.f, 89.f ) ) ) };
+		const VectorRegister OriginX { VectorSetFloat1( Query.Origin.X ) };
+		const VectorRegister OriginY { VectorSetFloat1( Query.Origin.Y ) };
+		const VectorRegister OriginZ { VectorSetFloat1( Query.Origin.Z ) };
+		const VectorRegister DirectionX { VectorSetFloat1( Query.Direction.X ) };
+		const VectorRegister DirectionY { VectorSetFloat1( Query.Direction.Y ) };
+		const VectorRegister DirectionZ { VectorSetFloat1( Query.Direction.Z ) };
+		const VectorRegister RangeSquared { VectorSetFloat1( FMath::Square( Query.MaxRange ) ) };
+		const VectorRegister CosSquared { VectorSetFloat1( FMath::Square( CosHalfAngle ) ) };
+
+		// best candidates so far, closest to the aim ray first
+		TArray<FTargetCandidate, TInlineAllocator<CandidateLimit + 1>> Candidates;
+
+		for ( int32 Base = 0; Base < TargetX.Num( ); Base += 4 )
+		{
+			const VectorRegister ToX { VectorSubtract( VectorLoadAligned( &TargetX[Base] ), OriginX ) };
+			const VectorRegister ToY { VectorSubtract( VectorLoadAligned( &TargetY[Base] ), OriginY ) };
+			const VectorRegister ToZ { VectorSubtract( VectorLoadAligned( &TargetZ[Base] ), OriginZ ) };
+			const VectorRegister DistSquared { VectorMultiplyAdd( ToX, ToX, VectorMultiplyAdd( ToY, ToY, VectorMultiply( ToZ, ToZ ) ) ) };
+			const VectorRegister Dot { VectorMultiplyAdd( ToX, DirectionX, VectorMultiplyAdd( ToY, DirectionY, VectorMultiply( ToZ, DirectionZ ) ) ) };
+
+			// in front, in range and inside the cone, without a square root: Dot^2 >= Cos^2 * Dist^2
+			const VectorRegister InCone { VectorBitwiseAnd(
+				VectorBitwiseAnd( VectorCompareGT( Dot, Zero ), VectorCompareLE( DistSquared, RangeSquared ) ),
+				VectorCompareGE( VectorMultiply( Dot, Dot ), VectorMultiply( CosSquared, DistSquared ) ) ) };
+
+			uint32 Lanes { static_cast<uint32>( VectorMaskBits( InCone ) ) };
+			if ( Lanes == 0 )
+			{
+				continue;
+			}
+
+			MS_ALIGN( 16 ) float Dots[4] GCC_ALIGN( 16 );
+			MS_ALIGN( 16 ) float Distances[4] GCC_ALIGN( 16 );
+			VectorStoreAligned( Dot, Dots );
+			VectorStoreAligned( DistSquared, Distances );
+
+			for ( ; Lanes != 0; Lanes &= Lanes - 1 )
+			{
+				const int32 Lane { static_cast<int32>( FMath::CountTrailingZeros( Lanes ) ) };
+				const int32 Index { Base + Lane };
+				if ( PackedTargets[Index] == Query.IgnoreActor || Distances[Lane] <= KINDA_SMALL_NUMBER )
+				{
+					continue;
+				}
+
+				const FTargetCandidate Candidate { Index, Dots[Lane] * FMath::InvSqrt( Distances[Lane] ), Distances[Lane] };
+				int32 Insert { Candidates.Num( ) };
+				while ( Insert > 0 && Candidates[Insert - 1].CosAngle < Candidate.CosAngle )
+				{
+					Insert--;
+				}
+				if ( Insert < MaxCandidates )
+				{
+					Candidates.Insert( Candidate, Insert );
+					Candidates.SetNum( FMath::Min( Candidates.Num( ), MaxCandidates ), false );
+				}
+			}
+		}
+		NumCandidates += Candidates.Num( );
+
+		if ( Candidates.Num( ) == 0 )
+		{
+			continue;
+		}
+
+		// visibility only for the few that made the cut; the first one in sight wins
+		FCollisionQueryParams Params { Preset.Params };
+		Params.AddIgnoredActor( Query.IgnoreActor );
+		for ( const FTargetCandidate& Candidate : Candidates )
+		{
+			AShooterCharacter* Character = PackedTargets[Candidate.Index];
+			const FVector AimPoint { TargetX[Candidate.Index], TargetY[Candidate.Index], TargetZ[Candidate.Index] };
+
+			bool bVisible { true };
+			const bool bTraced { TracesRun < MaxTraces };
+			if ( bTraced )
+			{
+				TracesRun++;
+				FHitResult Hit;
+				bVisible = !World->LineTraceSingleByChannel( Hit, Query.Origin, AimPoint, Preset.Channel, Params ) || Hit.GetActor( ) == Character;
+			}
+
+			if ( bVisible )
+			{
+				Result.Target = Character;
+				Result.AimPoint = AimPoint;
+				Result.Distance = FMath::Sqrt( Candidate.DistSquared );
+				Result.CosAngle = Candidate.CosAngle;
+				Result.bTraced = bTraced;
+				break;
+			}
+		}
+	}
+
+	INC_DWORD_STAT_BY( STAT_TargetQueriesRun, QueriesRun );
+	INC_DWORD_STAT_BY( STAT_TargetCandidates, NumCandidates );
+	INC_DWORD_STAT_BY( STAT_TargetTraces, TracesRun );
+}
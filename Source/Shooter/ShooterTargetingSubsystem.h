@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ShooterTargetingSubsystem.generated.h"
+
+class AShooterCharacter;
+
+/* an aim ray looking for targets within HalfAngleDegrees of Direction and closer than MaxRange */
+struct FShooterTargetQuery
+{
+	FVector Origin { FVector::ZeroVector };
+	/* unit length; a zero direction finds nothing */
+	FVector Direction { FVector::ZeroVector };
+	float MaxRange { 0.f };
+	float HalfAngleDegrees { 0.f };
+	/* never found, usually the querier itself */
+	const AActor* IgnoreActor { nullptr };
+};
+
+/* the best visible target a query found */
+struct FShooterTargetResult
+{
+	/* unset if nothing in the cone could be seen */
+	TWeakObjectPtr<AShooterCharacter> Target;
+	FVector AimPoint { FVector::ZeroVector };
+	float Distance { 0.f };
+	/* cosine of the angle between the aim ray and AimPoint; 1 is dead on */
+	float CosAngle { 0.f };
+	/* false if the batch was out of visibility traces and the best candidate was taken on trust */
+	bool bTraced { false };
+};
+
+/**
+ * Finds which characters are inside an aim cone.
+ * Every registered character's position is packed into flat arrays once a frame, and each query
+ * tests four at a time with vector math for range and angle. Only the best few candidates of a
+ * query, by angle, get a visibility trace. Standing queries, like a player's aim assist, are resolved
+ * together at the end of the frame; a batch of queries, like a bot swarm's, can be run at any time.
+ */
+UCLASS()
+class SHOOTER_API UShooterTargetingSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize( ) override;
+
+	/* Character can be found by queries while it is alive */
+	void RegisterTarget( AShooterCharacter* Character );
+	void UnregisterTarget( AShooterCharacter* Character );
+
+	FORCEINLINE int32 GetNumTargets( ) const { return Targets.Num( ); }
+
+	/* add a standing query, resolved once a frame with the others; returns its slot */
+	int32 AddQuerier( );
+
+	/* remove a standing query and reset Querier */
+	void RemoveQuerier( int32& Querier );
+
+	/* aim the standing query for this frame's resolve */
+	void SetQuery( int32 Querier, const FShooterTargetQuery& Query );
+
+	/* the standing query's result from the last resolve */
+	const FShooterTargetResult& GetResult( int32 Querier ) const;
+
+	/**
+	* Resolve Queries now against this frame's target positions
+	* @param OutResults  One per query
+	* @param MaxTraces   Visibility traces the whole batch may run; after that each query takes its best candidate untraced
+	*/
+	void RunQueries( TArrayView<const FShooterTargetQuery> Queries, TArrayView<FShooterTargetResult> OutResults, int32 MaxTraces = MAX_int32 );
+
+	// FTickableGameObject
+	virtual void Tick( float DeltaTime ) override;
+	virtual bool IsTickable( ) const override;
+	virtual TStatId GetStatId( ) const override;
+	virtual UWorld* GetTickableGameObjectWorld( ) const override { return GetWorld( ); }
+
+private:
+	/* pack the living targets' positions, once a frame and again for the standing resolve */
+	void RefreshTargets( );
+
+	TArray<TWeakObjectPtr<AShooterCharacter>> Targets;
+
+	/* living targets' positions, padded to a multiple of four and aligned for vector loads */
+	TArray<float, TAlignedHeapAllocator<16>> TargetX;
+	TArray<float, TAlignedHeapAllocator<16>> TargetY;
+	TArray<float, TAlignedHeapAllocator<16>> TargetZ;
+
+	/* character behind each packed position, for this frame only */
+	TArray<AShooterCharacter*> PackedTargets;
+	uint64 RefreshedFrame { MAX_uint64 };
+
+	/* standing queries, indexed by slot; a free slot has a zero direction */
+	TArray<FShooterTargetQuery> StandingQueries;
+	TArray<FShooterTargetResult> StandingResults;
+	TArray<int32> FreeQueriers;
+};
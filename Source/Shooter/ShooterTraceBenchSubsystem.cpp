@@ -0,0 +1,135 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterTraceBenchSubsystem.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "Components/BoxComponent.h"
+#include "GameFramework/PlayerStart.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Paths.h"
+#include "Item.h"
+#include "ShooterCollision.h"
+#include "Shooter.h"
+
+namespace
+{
+	/* same rays for every query type and every run */
+	const int32 RandomSeed { 0x5EED };
+	/* start above the floor an item or player start sits on */
+	const float OriginHeight { 100.f };
+	/* the range every crosshair trace used before the presets */
+	const float LegacyDistance { 50'000.f };
+
+	struct FTraceBenchCase
+	{
+		const TCHAR* Name;
+		ECollisionChannel Channel;
+		float Distance;
+		FCollisionQueryParams Params;
+		/* run against the collision items had before the presets */
+		bool bLegacy;
+	};
+
+	/* item CollisionBoxes blocked Visibility before they got the ItemTrace profile */
+	void SetLegacyItemCollision( UWorld* World, bool bLegacy )
+	{
+		for ( TActorIterator<AItem> It( World ); It; ++It )
+		{
+			if ( UBoxComponent* CollisionBox = It->GetCollisionBox( ) )
+			{
+				if ( bLegacy )
+				{
+					CollisionBox->SetCollisionResponseToAllChannels( ECollisionResponse::ECR_Ignore );
+					CollisionBox->SetCollisionResponseToChannel( ECollisionChannel::ECC_Visibility, ECollisionResponse::ECR_Block );
+				}
+				else
+				{
+					CollisionBox->SetCollisionProfileName( ShooterCollision::ItemTraceProfile );
+				}
+			}
+		}
+	}
+}
+
+void UShooterTraceBenchSubsystem::Initialize( FSubsystemCollectionBase& Collection )
+{
+	Super::Initialize( Collection );
+
+	FParse::Value( FCommandLine::Get( ), TEXT( "TraceBenchmark=" ), NumTraces );
+}
+
+void UShooterTraceBenchSubsystem::OnLevelStarted( UWorld* World )
+{
+	if ( NumTraces <= 0 )
+	{
+		return;
+	}
+
+	// trace from where the game does: next to items and where players spawn
+	TArray<FVector> Origins;
+	for ( TActorIterator<AItem> It( World ); It; ++It )
+	{
+		Origins.Add( It->GetActorLocation( ) + FVector( 0.f, 0.f, OriginHeight ) );
+	}
+	for ( TActorIterator<APlayerStart> It( World ); It; ++It )
+	{
+		Origins.Add( It->GetActorLocation( ) );
+	}
+	if ( Origins.Num( ) == 0 )
+	{
+		Origins.Add( FVector::ZeroVector );
+	}
+
+	FRandomStream RandomStream( RandomSeed );
+	TArray<FVector> Starts;
+	TArray<FVector> Directions;
+	Starts.Reserve( NumTraces );
+	Directions.Reserve( NumTraces );
+	for ( int32 i = 0; i < NumTraces; i++ )
+	{
+		Starts.Add( Origins[RandomStream.RandHelper( Origins.Num( ) )] );
+		Directions.Add( RandomStream.GetUnitVector( ) );
+	}
+
+	const FShooterQueryPreset& ItemPreset = ShooterCollision::GetQueryPreset( EShooterQuery::ESQ_Item );
+	const FShooterQueryPreset& BulletPreset = ShooterCollision::GetQueryPreset( EShooterQuery::ESQ_Bullet );
+	FCollisionQueryParams LegacyBulletParams( SCENE_QUERY_STAT( LegacyShotTrace ), false );
+	LegacyBulletParams.bReturnPhysicalMaterial = true;
+
+	const FTraceBenchCase Cases[] {
+		{ TEXT( "ItemVisibility" ), ECC_Visibility, LegacyDistance, FCollisionQueryParams( SCENE_QUERY_STAT( LegacyItemTrace ), false ), true },
+		{ TEXT( "Item" ), ItemPreset.Channel, ItemPreset.MaxDistance, ItemPreset.Params, false },
+		{ TEXT( "BulletVisibility" ), ECC_Visibility, LegacyDistance, LegacyBulletParams, true },
+		{ TEXT( "Bullet" ), BulletPreset.Channel, BulletPreset.MaxDistance, BulletPreset.Params, false }
+	};
+
+	FString Results;
+	for ( const FTraceBenchCase& Case : Cases )
+	{
+		// outside the timing; the old way has to see the items the old way did
+		SetLegacyItemCollision( World, Case.bLegacy );
+
+		int32 Hits { 0 };
+		int32 ItemHits { 0 };
+		FHitResult Hit;
+		const uint64 StartCycles { FPlatformTime::Cycles64( ) };
+		for ( int32 i = 0; i < NumTraces; i++ )
+		{
+			if ( World->LineTraceSingleByChannel( Hit, Starts[i], Starts[i] + Directions[i] * Case.Distance, Case.Channel, Case.Params ) )
+			{
+				Hits++;
+				ItemHits += Cast<AItem>( Hit.GetActor( ) ) ? 1 : 0;
+			}
+		}
+		const double TotalMs { FPlatformTime::ToMilliseconds64( FPlatformTime::Cycles64( ) - StartCycles ) };
+
+		const FString Row { FString::Printf( TEXT( "%s,%d,%d,%d,%.3f,%.3f" ), Case.Name, NumTraces, Hits, ItemHits, TotalMs, TotalMs * 1000.0 / NumTraces ) };
+		UE_LOG( LogShooter, Log, TEXT( "TraceBenchmark: %s" ), *Row );
+		Results += Row + TEXT( "\n" );
+	}
+
+	const FString Filename { FPaths::ProjectSavedDir( ) / TEXT( "TraceBench" ) / UWorld::RemovePIEPrefix( World->GetMapName( ) ) + TEXT( ".csv" ) };
+	SaveBenchmarkResults( TEXT( "TraceBenchmark" ), Filename, TEXT( "Query,Traces,Hits,ItemHits,TotalMs,AvgUs\n" ), Results, false );
+	FinishBenchmarkRun( );
+}
@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ShooterLevelSubsystem.h"
+#include "ShooterTraceBenchSubsystem.generated.h"
+
+/**
+ * Scene query cost benchmark. "-TraceBenchmark=<traces>" fires that many line traces per query type
+ * from the level's items and player starts in fixed random directions. Each item and bullet query runs
+ * twice: once the old way (Visibility channel, default params, full range, item CollisionBoxes blocking
+ * Visibility again) and once with its ShooterCollision preset. Writes Saved/TraceBench/<Map>.csv and exits.
+ */
+UCLASS()
+class SHOOTER_API UShooterTraceBenchSubsystem : public UShooterLevelSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize( FSubsystemCollectionBase& Collection ) override;
+
+	/* run the benchmark once the level's actors are registered; called by the game mode */
+	virtual void OnLevelStarted( UWorld* World ) override;
+
+private:
+	int32 NumTraces { 0 };
+};
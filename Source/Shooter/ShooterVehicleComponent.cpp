@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterVehicleComponent.h"
+#include "Engine/World.h"
+#include "ShooterVehicleSubsystem.h"
+
+UShooterVehicleComponent::UShooterVehicleComponent( ) :
+	bAttachDriver( true ),
+	bHideDriver( false ),
+	ExitOffset( 0.f, -200.f, 0.f ),
+	Driver( nullptr ),
+	HudWidget( nullptr ),
+	bOwnerTickSuspended( false ),
+	bDormant( false )
+{
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UShooterVehicleComponent::BeginPlay( )
+{
+	Super::BeginPlay( );
+
+	if ( UShooterVehicleSubsystem* Vehicles = GetWorld( )->GetSubsystem<UShooterVehicleSubsystem>( ) )
+	{
+		Vehicles->RegisterVehicle( this );
+	}
+}
+
+void UShooterVehicleComponent::EndPlay( const EEndPlayReason::Type EndPlayReason )
+{
+	if ( UShooterVehicleSubsystem* Vehicles = GetWorld( )->GetSubsystem<UShooterVehicleSubsystem>( ) )
+	{
+		Vehicles->UnregisterVehicle( this );
+	}
+
+	Super::EndPlay( EndPlayReason );
+}
+
+bool UShooterVehicleComponent::Enter( AShooterCharacter* NewDriver )
+{
+	UShooterVehicleSubsystem* Vehicles = GetWorld( )->GetSubsystem<UShooterVehicleSubsystem>( );
+	return Vehicles && Vehicles->EnterVehicle( NewDriver, this );
+}
+
+bool UShooterVehicleComponent::Exit( )
+{
+	UShooterVehicleSubsystem* Vehicles = GetWorld( )->GetSubsystem<UShooterVehicleSubsystem>( );
+	return Vehicles && Vehicles->ExitVehicle( this );
+}
+
+USceneComponent* UShooterVehicleComponent::FindSeat( ) const
+{
+	const AActor* Owner = GetOwner( );
+	if ( Owner == nullptr )
+	{
+		return nullptr;
+	}
+	if ( SeatComponentName != NAME_None )
+	{
+		TInlineComponentArray<USceneComponent*> SceneComponents( Owner );
+		for ( USceneComponent* Component : SceneComponents )
+		{
+			if ( Component->GetFName( ) == SeatComponentName )
+			{
+				return Component;
+			}
+		}
+	}
+	return Owner->GetRootComponent( );
+}
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "ShooterVehicleComponent.generated.h"
+
+class AShooterCharacter;
+class UUserWidget;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam( FOnVehicleDriverChanged, AShooterCharacter*, Driver );
+
+/**
+ * Makes its owning pawn drivable by an AShooterCharacter. While nobody drives it the pawn is
+ * kept dormant by UShooterVehicleSubsystem: ticking off, rigid bodies asleep, HUD not built.
+ */
+UCLASS( ClassGroup = ( Custom ), meta = ( BlueprintSpawnableComponent ) )
+class SHOOTER_API UShooterVehicleComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UShooterVehicleComponent( );
+
+	/* wake the vehicle and hand Driver's controller over to it */
+	UFUNCTION( BlueprintCallable, Category = Vehicle )
+	bool Enter( AShooterCharacter* NewDriver );
+
+	/* hand control back to the driver and put the vehicle to sleep */
+	UFUNCTION( BlueprintCallable, Category = Vehicle )
+	bool Exit( );
+
+	/* the component the driver sits on: SeatComponentName, or the owner's root */
+	USceneComponent* FindSeat( ) const;
+
+	UPROPERTY( BlueprintAssignable, Category = Vehicle )
+	FOnVehicleDriverChanged OnDriverEntered;
+
+	UPROPERTY( BlueprintAssignable, Category = Vehicle )
+	FOnVehicleDriverChanged OnDriverExited;
+
+protected:
+	virtual void BeginPlay( ) override;
+	virtual void EndPlay( const EEndPlayReason::Type EndPlayReason ) override;
+
+private:
+	friend class UShooterVehicleSubsystem;
+
+	/* HUD shown while driving; built the first time someone gets in */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Vehicle, meta = ( AllowPrivateAccess = "true" ) )
+	TSubclassOf<UUserWidget> HudWidgetClass;
+
+	/* attach the driver to the seat (forklift, crane); off for remote-controlled pawns (drone) */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Vehicle, meta = ( AllowPrivateAccess = "true" ) )
+	bool bAttachDriver;
+
+	/* hide the driver while seated */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Vehicle, meta = ( AllowPrivateAccess = "true" ) )
+	bool bHideDriver;
+
+	/* owner component the driver sits on; leave empty for the root */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Vehicle, meta = ( AllowPrivateAccess = "true" ) )
+	FName SeatComponentName;
+
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Vehicle, meta = ( AllowPrivateAccess = "true" ) )
+	FName SeatSocket;
+
+	/* where an attached driver is put on exit, relative to the vehicle */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Vehicle, meta = ( AllowPrivateAccess = "true" ) )
+	FVector ExitOffset;
+
+	UPROPERTY( VisibleInstanceOnly, BlueprintReadOnly, Category = Vehicle, meta = ( AllowPrivateAccess = "true" ) )
+	AShooterCharacter* Driver;
+
+	UPROPERTY( Transient )
+	UUserWidget* HudWidget;
+
+	/* components whose tick we switched off going dormant, switched back on when woken */
+	UPROPERTY( Transient )
+	TArray<UActorComponent*> SuspendedComponents;
+
+	bool bOwnerTickSuspended;
+
+	bool bDormant;
+
+public:
+	FORCEINLINE AShooterCharacter* GetDriver( ) const { return Driver; }
+	FORCEINLINE bool IsDormant( ) const { return bDormant; }
+};
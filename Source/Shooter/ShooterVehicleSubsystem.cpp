@@ -0,0 +1,234 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterVehicleSubsystem.h"
+#include "Blueprint/UserWidget.h"
+#include "Components/PrimitiveComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "ShooterCharacter.h"
+#include "ShooterVehicleComponent.h"
+#include "ShooterStats.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT( TEXT( "Vehicles Registered" ), STAT_VehiclesRegistered, STATGROUP_Shooter );
+DECLARE_DWORD_ACCUMULATOR_STAT( TEXT( "Vehicles Dormant" ), STAT_VehiclesDormant, STATGROUP_Shooter );
+
+static TAutoConsoleVariable<float> CVarVehicleSleepSpeed(
+	TEXT( "shooter.Vehicle.SleepSpeed" ),
+	10.f,
+	TEXT( "Bodies slower than this (cm/s) are put to sleep when their vehicle goes dormant; faster ones are left to settle" ) );
+
+void UShooterVehicleSubsystem::RegisterVehicle( UShooterVehicleComponent* Vehicle )
+{
+	if ( Vehicle == nullptr || Vehicles.Contains( Vehicle ) )
+	{
+		return;
+	}
+	Vehicles.Add( Vehicle );
+	INC_DWORD_STAT( STAT_VehiclesRegistered );
+
+	// pawns placed already possessed (AI, auto-possess) stay awake
+	const APawn* Pawn = Cast<APawn>( Vehicle->GetOwner( ) );
+	if ( Pawn && Pawn->GetController( ) == nullptr )
+	{
+		SetDormant( Vehicle, true );
+	}
+}
+
+void UShooterVehicleSubsystem::UnregisterVehicle( UShooterVehicleComponent* Vehicle )
+{
+	if ( !Vehicles.Contains( Vehicle ) )
+	{
+		return;
+	}
+
+	// destroyed or streamed out while driven: the driver gets out and back in control first
+	if ( Vehicle->Driver && !Vehicle->Driver->IsPendingKill( ) )
+	{
+		ExitVehicle( Vehicle );
+	}
+	Vehicle->Driver = nullptr;
+
+	Vehicles.RemoveSingleSwap( Vehicle );
+	DEC_DWORD_STAT( STAT_VehiclesRegistered );
+	if ( Vehicle->bDormant )
+	{
+		DEC_DWORD_STAT( STAT_VehiclesDormant );
+	}
+	HideHud( Vehicle );
+}
+
+bool UShooterVehicleSubsystem::EnterVehicle( AShooterCharacter* Driver, UShooterVehicleComponent* Vehicle )
+{
+	if ( Driver == nullptr || Vehicle == nullptr || Vehicle->Driver || Driver->IsSeated( ) )
+	{
+		return false;
+	}
+	AController* Controller = Driver->GetController( );
+	APawn* VehiclePawn = Cast<APawn>( Vehicle->GetOwner( ) );
+	if ( Controller == nullptr || VehiclePawn == nullptr )
+	{
+		return false;
+	}
+
+	SetDormant( Vehicle, false );
+
+	// Possess unpossesses the character itself, so the handoff completes this frame
+	Controller->Possess( VehiclePawn );
+	Vehicle->Driver = Driver;
+
+	Driver->SetSeated( true );
+	if ( Vehicle->bAttachDriver )
+	{
+		Driver->AttachToComponent( Vehicle->FindSeat( ), FAttachmentTransformRules::SnapToTargetNotIncludingScale, Vehicle->SeatSocket );
+	}
+	Driver->SetActorHiddenInGame( Vehicle->bHideDriver );
+
+	ShowHud( Vehicle, Controller );
+	Vehicle->OnDriverEntered.Broadcast( Driver );
+	return true;
+}
+
+bool UShooterVehicleSubsystem::ExitVehicle( UShooterVehicleComponent* Vehicle )
+{
+	if ( Vehicle == nullptr || Vehicle->Driver == nullptr )
+	{
+		return false;
+	}
+	AShooterCharacter* Driver = Vehicle->Driver;
+	APawn* VehiclePawn = Cast<APawn>( Vehicle->GetOwner( ) );
+	AController* Controller = VehiclePawn ? VehiclePawn->GetController( ) : nullptr;
+
+	HideHud( Vehicle );
+
+	if ( Vehicle->bAttachDriver && VehiclePawn )
+	{
+		Driver->DetachFromActor( FDetachmentTransformRules::KeepWorldTransform );
+		Driver->SetActorLocationAndRotation(
+			VehiclePawn->GetActorTransform( ).TransformPosition( Vehicle->ExitOffset ),
+			FRotator( 0.f, VehiclePawn->GetActorRotation( ).Yaw, 0.f ),
+			false, nullptr, ETeleportType::TeleportPhysics );
+	}
+	Driver->SetActorHiddenInGame( false );
+	Driver->SetSeated( false );
+
+	if ( Controller )
+	{
+		Controller->Possess( Driver );
+	}
+	Vehicle->Driver = nullptr;
+
+	SetDormant( Vehicle, true );
+	Vehicle->OnDriverExited.Broadcast( Driver );
+	return true;
+}
+
+void UShooterVehicleSubsystem::ResetVehicle( UShooterVehicleComponent* Vehicle, const FTransform& Transform )
+{
+	AActor* Owner = Vehicle ? Vehicle->GetOwner( ) : nullptr;
+	if ( Owner == nullptr )
+	{
+		return;
+	}
+	ExitVehicle( Vehicle );
+
+	Owner->SetActorTransform( Transform, false, nullptr, ETeleportType::ResetPhysics );
+	TInlineComponentArray<UPrimitiveComponent*> Primitives( Owner );
+	for ( UPrimitiveComponent* Primitive : Primitives )
+	{
+		if ( Primitive->IsSimulatingPhysics( ) )
+		{
+			Primitive->SetPhysicsLinearVelocity( FVector::ZeroVector );
+			Primitive->SetPhysicsAngularVelocityInDegrees( FVector::ZeroVector );
+			Primitive->PutAllRigidBodiesToSleep( );
+		}
+	}
+	SetDormant( Vehicle, true );
+}
+
+void UShooterVehicleSubsystem::SetDormant( UShooterVehicleComponent* Vehicle, bool bDormant )
+{
+	AActor* Owner = Vehicle->GetOwner( );
+	if ( Owner == nullptr || Vehicle->bDormant == bDormant )
+	{
+		return;
+	}
+	Vehicle->bDormant = bDormant;
+
+	TInlineComponentArray<UActorComponent*> Components( Owner );
+	if ( bDormant )
+	{
+		INC_DWORD_STAT( STAT_VehiclesDormant );
+
+		Vehicle->bOwnerTickSuspended = Owner->IsActorTickEnabled( );
+		Owner->SetActorTickEnabled( false );
+
+		const float SleepSpeedSquared { FMath::Square( CVarVehicleSleepSpeed.GetValueOnGameThread( ) ) };
+		Vehicle->SuspendedComponents.Reset( );
+		for ( UActorComponent* Component : Components )
+		{
+			if ( Component->IsComponentTickEnabled( ) )
+			{
+				Component->SetComponentTickEnabled( false );
+				Vehicle->SuspendedComponents.Add( Component );
+			}
+			// don't freeze a vehicle that's still rolling or falling; physics will sleep it once it settles
+			UPrimitiveComponent* Primitive = Cast<UPrimitiveComponent>( Component );
+			if ( Primitive && Primitive->IsSimulatingPhysics( ) && Primitive->GetPhysicsLinearVelocity( ).SizeSquared( ) < SleepSpeedSquared )
+			{
+				Primitive->PutAllRigidBodiesToSleep( );
+			}
+		}
+	}
+	else
+	{
+		DEC_DWORD_STAT( STAT_VehiclesDormant );
+
+		if ( Vehicle->bOwnerTickSuspended )
+		{
+			Owner->SetActorTickEnabled( true );
+		}
+		for ( UActorComponent* Component : Vehicle->SuspendedComponents )
+		{
+			if ( Component )
+			{
+				Component->SetComponentTickEnabled( true );
+			}
+		}
+		Vehicle->SuspendedComponents.Reset( );
+
+		for ( UActorComponent* Component : Components )
+		{
+			UPrimitiveComponent* Primitive = Cast<UPrimitiveComponent>( Component );
+			if ( Primitive && Primitive->IsSimulatingPhysics( ) )
+			{
+				Primitive->WakeAllRigidBodies( );
+			}
+		}
+	}
+}
+
+void UShooterVehicleSubsystem::ShowHud( UShooterVehicleComponent* Vehicle, AController* Controller )
+{
+	APlayerController* PlayerController = Cast<APlayerController>( Controller );
+	if ( PlayerController == nullptr || !PlayerController->IsLocalController( ) || !Vehicle->HudWidgetClass )
+	{
+		return;
+	}
+	// built on first use, then kept for the next time someone gets in
+	if ( Vehicle->HudWidget == nullptr )
+	{
+		Vehicle->HudWidget = CreateWidget<UUserWidget>( PlayerController, Vehicle->HudWidgetClass );
+	}
+	if ( Vehicle->HudWidget && !Vehicle->HudWidget->IsInViewport( ) )
+	{
+		Vehicle->HudWidget->AddToViewport( );
+	}
+}
+
+void UShooterVehicleSubsystem::HideHud( UShooterVehicleComponent* Vehicle )
+{
+	if ( Vehicle->HudWidget )
+	{
+		Vehicle->HudWidget->RemoveFromParent( );
+	}
+}
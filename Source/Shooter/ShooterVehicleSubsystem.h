@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ShooterVehicleSubsystem.generated.h"
+
+class AShooterCharacter;
+class UShooterVehicleComponent;
+
+/**
+ * Possession manager for drivable pawns. Vehicles nobody is driving are kept dormant;
+ * entering wakes the vehicle and swaps possession from the character in the same frame.
+ */
+UCLASS()
+class SHOOTER_API UShooterVehicleSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	void RegisterVehicle( UShooterVehicleComponent* Vehicle );
+	/* drop Vehicle, putting its driver back in control first */
+	void UnregisterVehicle( UShooterVehicleComponent* Vehicle );
+
+	/* wake Vehicle, possess it with Driver's controller and seat Driver */
+	bool EnterVehicle( AShooterCharacter* Driver, UShooterVehicleComponent* Vehicle );
+
+	/* give control back to Vehicle's driver and put Vehicle to sleep */
+	bool ExitVehicle( UShooterVehicleComponent* Vehicle );
+
+	/* put Vehicle back at Transform, empty and asleep */
+	void ResetVehicle( UShooterVehicleComponent* Vehicle, const FTransform& Transform );
+
+private:
+	void SetDormant( UShooterVehicleComponent* Vehicle, bool bDormant );
+
+	void ShowHud( UShooterVehicleComponent* Vehicle, AController* Controller );
+	void HideHud( UShooterVehicleComponent* Vehicle );
+
+	UPROPERTY( Transient )
+	TArray<UShooterVehicleComponent*> Vehicles;
+};
@@ -0,0 +1,363 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterWorldCellSubsystem.h"
+#include "AssetRegistryModule.h"
+#include "Engine/Engine.h"
+#include "Engine/Level.h"
+#include "Engine/LevelStreamingDynamic.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "Item.h"
+#include "Shooter.h"
+#include "ShooterStats.h"
+#include "ShooterVehicleComponent.h"
+#include "ShooterWorldSnapshot.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT( TEXT( "World Cells Loaded" ), STAT_WorldCellsLoaded, STATGROUP_Shooter );
+
+static TAutoConsoleVariable<float> CVarCellLoadRadius(
+	TEXT( "shooter.Cells.LoadRadius" ),
+	12000.f,
+	TEXT( "Cells closer than this to a player (cm) are streamed in" ) );
+
+static TAutoConsoleVariable<float> CVarCellUnloadRadius(
+	TEXT( "shooter.Cells.UnloadRadius" ),
+	16000.f,
+	TEXT( "Cells further than this from every player (cm) are streamed out; keep it above LoadRadius so cells on the edge don't thrash" ) );
+
+namespace
+{
+	const double BytesPerMB { 1024.0 * 1024.0 };
+}
+
+UShooterWorldCellSubsystem::UShooterWorldCellSubsystem( ) :
+	CellSize( 10000.f ),
+	CellOrigin( 0.f, 0.f )
+{
+}
+
+void UShooterWorldCellSubsystem::OnWorldBeginPlay( UWorld& InWorld )
+{
+	Super::OnWorldBeginPlay( InWorld );
+
+	if ( InWorld.IsGameWorld( ) )
+	{
+		DiscoverCells( InWorld );
+		bBenchmarking = FParse::Param( FCommandLine::Get( ), TEXT( "CellBenchmark" ) );
+	}
+}
+
+void UShooterWorldCellSubsystem::Deinitialize( )
+{
+	for ( const FWorldCell& Cell : Cells )
+	{
+		if ( Cell.Streaming.IsValid( ) )
+		{
+			DEC_DWORD_STAT( STAT_WorldCellsLoaded );
+		}
+	}
+	Cells.Reset( );
+
+	Super::Deinitialize( );
+}
+
+void UShooterWorldCellSubsystem::DiscoverCells( const UWorld& InWorld )
+{
+	const FString MapPackage { UWorld::RemovePIEPrefix( InWorld.GetOutermost( )->GetName( ) ) };
+	const FString MapName { FPackageName::GetShortName( MapPackage ) };
+	const FString CellPath { FPackageName::GetLongPackagePath( MapPackage ) / MapName + TEXT( "_Cells" ) };
+	const FString CellPrefix { MapName + TEXT( "_Cell_" ) };
+
+	TArray<FAssetData> CellAssets;
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>( TEXT( "AssetRegistry" ) ).Get( );
+	AssetRegistry.GetAssetsByPath( FName( *CellPath ), CellAssets );
+
+	for ( const FAssetData& CellAsset : CellAssets )
+	{
+		const FString AssetName { CellAsset.AssetName.ToString( ) };
+		FString X, Y;
+		if ( CellAsset.AssetClass != UWorld::StaticClass( )->GetFName( )
+			|| !AssetName.StartsWith( CellPrefix )
+			|| !AssetName.RightChop( CellPrefix.Len( ) ).Split( TEXT( "_" ), &X, &Y ) )
+		{
+			continue;
+		}
+
+		const FVector2D Min { CellOrigin + FVector2D( FCString::Atoi( *X ), FCString::Atoi( *Y ) ) * CellSize };
+
+		FWorldCell& Cell = Cells.AddDefaulted_GetRef( );
+		Cell.PackageName = CellAsset.PackageName.ToString( );
+		Cell.InstancePackageName = Cell.PackageName + TEXT( "_Streamed" );
+		Cell.Bounds = FBox2D( Min, Min + FVector2D( CellSize, CellSize ) );
+		Cell.bWanted = false;
+		Cell.bRestored = false;
+	}
+
+	// stable order for the benchmark tour
+	Cells.Sort( []( const FWorldCell& A, const FWorldCell& B ) { return A.PackageName < B.PackageName; } );
+
+	if ( Cells.Num( ) > 0 )
+	{
+		UE_LOG( LogShooter, Log, TEXT( "Streaming %s in %d cells from %s" ), *MapName, Cells.Num( ), *CellPath );
+	}
+}
+
+void UShooterWorldCellSubsystem::SetStreamingSourceOverride( const FVector& Location )
+{
+	StreamingSourceOverride = Location;
+}
+
+void UShooterWorldCellSubsystem::ClearStreamingSourceOverride( )
+{
+	StreamingSourceOverride.Reset( );
+}
+
+void UShooterWorldCellSubsystem::GatherStreamingSources( TArray<FVector, TInlineAllocator<4>>& OutSources ) const
+{
+	if ( StreamingSourceOverride.IsSet( ) )
+	{
+		OutSources.Add( StreamingSourceOverride.GetValue( ) );
+		return;
+	}
+
+	for ( FConstPlayerControllerIterator It = GetWorld( )->GetPlayerControllerIterator( ); It; ++It )
+	{
+		const APlayerController* PlayerController = It->Get( );
+		if ( PlayerController && PlayerController->IsLocalController( ) )
+		{
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PlayerController->GetPlayerViewPoint( ViewLocation, ViewRotation );
+			OutSources.Add( ViewLocation );
+		}
+	}
+}
+
+bool UShooterWorldCellSubsystem::IsTickable( ) const
+{
+	const UWorld* World = GetWorld( );
+	return !IsTemplate( ) && World && World->IsGameWorld( ) && ( Cells.Num( ) > 0 || bBenchmarking );
+}
+
+TStatId UShooterWorldCellSubsystem::GetStatId( ) const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT( UShooterWorldCellSubsystem, STATGROUP_Tickables );
+}
+
+bool UShooterWorldCellSubsystem::IsCellVisible( const FWorldCell& Cell ) const
+{
+	const ULevelStreamingDynamic* Streaming = Cell.Streaming.Get( );
+	const ULevel* Level = Streaming ? Streaming->GetLoadedLevel( ) : nullptr;
+	return Level && Level->bIsVisible;
+}
+
+bool UShooterWorldCellSubsystem::AreNearbyCellsVisible( ) const
+{
+	for ( const FWorldCell& Cell : Cells )
+	{
+		if ( Cell.bWanted && !IsCellVisible( Cell ) )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void UShooterWorldCellSubsystem::Tick( float DeltaTime )
+{
+	TArray<FVector, TInlineAllocator<4>> Sources;
+	GatherStreamingSources( Sources );
+
+	const float LoadRadiusSquared { FMath::Square( CVarCellLoadRadius.GetValueOnGameThread( ) ) };
+	const float UnloadRadiusSquared { FMath::Square( FMath::Max( CVarCellUnloadRadius.GetValueOnGameThread( ), CVarCellLoadRadius.GetValueOnGameThread( ) ) ) };
+
+	for ( FWorldCell& Cell : Cells )
+	{
+		const float ClosestSquared { GetClosestSquared( Cell, Sources ) };
+
+		Cell.bWanted = ClosestSquared <= LoadRadiusSquared;
+		if ( Cell.bWanted && !Cell.Streaming.IsValid( ) )
+		{
+			LoadCell( Cell );
+		}
+		else if ( ClosestSquared > UnloadRadiusSquared && Cell.Streaming.IsValid( ) && !IsCellInUse( Cell, Sources, LoadRadiusSquared ) )
+		{
+			UnloadCell( Cell );
+		}
+
+		// put the state back once the cell's actors have begun play
+		if ( !Cell.bRestored && IsCellVisible( Cell ) )
+		{
+			if ( Cell.State.IsValid( ) )
+			{
+				Cell.State->RestoreLevel( Cell.Streaming->GetLoadedLevel( ) );
+			}
+			Cell.bRestored = true;
+		}
+	}
+
+	if ( bBenchmarking )
+	{
+		TickBenchmark( );
+	}
+}
+
+float UShooterWorldCellSubsystem::GetClosestSquared( const FWorldCell& Cell, const TArray<FVector, TInlineAllocator<4>>& Sources ) const
+{
+	float ClosestSquared { TNumericLimits<float>::Max( ) };
+	for ( const FVector& Source : Sources )
+	{
+		const FVector2D Source2D { Source };
+		ClosestSquared = FMath::Min( ClosestSquared, Cell.Bounds.ComputeSquaredDistanceToPoint( Source2D ) );
+		for ( const FVector2D& Stray : Cell.StrayLocations )
+		{
+			ClosestSquared = FMath::Min( ClosestSquared, FVector2D::DistSquared( Stray, Source2D ) );
+		}
+	}
+	return ClosestSquared;
+}
+
+bool UShooterWorldCellSubsystem::IsCellInUse( const FWorldCell& Cell, const TArray<FVector, TInlineAllocator<4>>& Sources, float LoadRadiusSquared ) const
+{
+	const ULevelStreamingDynamic* Streaming = Cell.Streaming.Get( );
+	const ULevel* Level = Streaming ? Streaming->GetLoadedLevel( ) : nullptr;
+	if ( Level == nullptr )
+	{
+		return false;
+	}
+
+	for ( const AActor* Actor : Level->Actors )
+	{
+		if ( Actor == nullptr || Actor->IsPendingKill( ) )
+		{
+			continue;
+		}
+
+		const APawn* Pawn = Cast<APawn>( Actor );
+		const UShooterVehicleComponent* Vehicle = Actor->FindComponentByClass<UShooterVehicleComponent>( );
+		const AItem* Item = Cast<AItem>( Actor );
+		if ( ( Pawn && Pawn->IsPlayerControlled( ) ) || ( Vehicle && Vehicle->GetDriver( ) ) || ( Item && Item->GetAttachParentActor( ) ) )
+		{
+			return true;
+		}
+
+		// anything that moves is judged by where it is now, not by the cell it came from
+		if ( Pawn || Vehicle || Item )
+		{
+			const FVector Location { Actor->GetActorLocation( ) };
+			for ( const FVector& Source : Sources )
+			{
+				if ( FVector2D::DistSquared( FVector2D( Location ), FVector2D( Source ) ) <= LoadRadiusSquared )
+				{
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+void UShooterWorldCellSubsystem::LoadCell( FWorldCell& Cell )
+{
+	// the last instance is still waiting for garbage collection; reusing its name has to wait too
+	if ( FindObject<UPackage>( nullptr, *Cell.InstancePackageName ) )
+	{
+		GEngine->ForceGarbageCollection( false );
+		return;
+	}
+
+	bool bSuccess { false };
+	ULevelStreamingDynamic* Streaming = ULevelStreamingDynamic::LoadLevelInstance(
+		GetWorld( ), Cell.PackageName, FVector::ZeroVector, FRotator::ZeroRotator, bSuccess, Cell.InstancePackageName );
+	if ( bSuccess && Streaming )
+	{
+		Cell.Streaming = Streaming;
+		Cell.bRestored = false;
+		INC_DWORD_STAT( STAT_WorldCellsLoaded );
+	}
+}
+
+void UShooterWorldCellSubsystem::UnloadCell( FWorldCell& Cell )
+{
+	ULevelStreamingDynamic* Streaming = Cell.Streaming.Get( );
+	if ( IsCellVisible( Cell ) )
+	{
+		if ( !Cell.State.IsValid( ) )
+		{
+			Cell.State = MakeShared<FShooterWorldSnapshot>( );
+		}
+		Cell.State->CaptureLevel( Streaming->GetLoadedLevel( ) );
+
+		// the snapshot puts actors back where they were, so the cell has to come back when a player nears any of them
+		Cell.StrayLocations.Reset( );
+		for ( const AActor* Actor : Streaming->GetLoadedLevel( )->Actors )
+		{
+			if ( Actor && ( Actor->IsA<AItem>( ) || Actor->IsA<APawn>( ) || Actor->FindComponentByClass<UShooterVehicleComponent>( ) ) )
+			{
+				const FVector2D Location { Actor->GetActorLocation( ) };
+				if ( !Cell.Bounds.IsInside( Location ) )
+				{
+					Cell.StrayLocations.Add( Location );
+				}
+			}
+		}
+	}
+
+	Streaming->SetIsRequestingUnloadAndRemoval( true );
+	Cell.Streaming.Reset( );
+	Cell.bRestored = false;
+	DEC_DWORD_STAT( STAT_WorldCellsLoaded );
+}
+
+void UShooterWorldCellSubsystem::TickBenchmark( )
+{
+	if ( !AreNearbyCellsVisible( ) )
+	{
+		return;
+	}
+
+	const double Now { FPlatformTime::Seconds( ) };
+	if ( BenchmarkCell == INDEX_NONE )
+	{
+		FirstFrameSeconds = Now - GStartTime;
+		FirstFramePeakMB = FPlatformMemory::GetStats( ).PeakUsedPhysical / BytesPerMB;
+		TourStartSeconds = Now;
+		UE_LOG( LogShooter, Log, TEXT( "CellBenchmark: first frame after %.2f s, peak %.0f MB" ), FirstFrameSeconds, FirstFramePeakMB );
+	}
+
+	// visit each cell in turn, moving on once everything around it has streamed in
+	if ( ++BenchmarkCell < Cells.Num( ) )
+	{
+		const FVector2D Center { Cells[BenchmarkCell].Bounds.GetCenter( ) };
+		SetStreamingSourceOverride( FVector( Center, 0.f ) );
+		return;
+	}
+
+	ClearStreamingSourceOverride( );
+	bBenchmarking = false;
+
+	const double TourPeakMB { FPlatformMemory::GetStats( ).PeakUsedPhysical / BytesPerMB };
+	const FString Filename { FPaths::ProjectSavedDir( ) / TEXT( "CellBench" ) / TEXT( "Streaming.csv" ) };
+	FString Rows;
+	if ( !IFileManager::Get( ).FileExists( *Filename ) )
+	{
+		Rows = TEXT( "Map,Cells,TimeToFirstFrameSec,FirstFramePeakMB,TourPeakMB,TourSec\n" );
+	}
+	Rows += FString::Printf( TEXT( "%s,%d,%.2f,%.0f,%.0f,%.1f\n" ), *UWorld::RemovePIEPrefix( GetWorld( )->GetMapName( ) ),
+		Cells.Num( ), FirstFrameSeconds, FirstFramePeakMB, TourPeakMB, Now - TourStartSeconds );
+	FFileHelper::SaveStringToFile( Rows, *Filename, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get( ), FILEWRITE_Append );
+	UE_LOG( LogShooter, Log, TEXT( "CellBenchmark: %s" ), *Rows );
+
+	if ( !GIsEditor )
+	{
+		FPlatformMisc::RequestExit( false );
+	}
+}
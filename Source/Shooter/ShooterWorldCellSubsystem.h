@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "ShooterWorldCellSubsystem.generated.h"
+
+class FShooterWorldSnapshot;
+
+/**
+ * Streams a map's cells in and out around the local players.
+ * Cells are levels named <Map>_Cell_<X>_<Y> in a <Map>_Cells folder next to the map; cell X,Y covers
+ * CellOrigin + (X,Y) * CellSize. Maps without cells are left alone.
+ * Items, action props and vehicles in a cell keep their state across unload and reload: the cell is
+ * captured into a compact in-memory snapshot as it unloads and restored once it is visible again.
+ * A cell stays loaded while any of its actors is in use (a possessed pawn, a driven vehicle, a held
+ * item) or sits within the load radius, wherever it has moved to. Actors that were outside their cell
+ * when it unloaded also bring it back in when a player comes near them.
+ *
+ * -CellBenchmark measures time to the first fully streamed-in frame and peak memory, tours every
+ * cell, appends the results to Saved/CellBench/Streaming.csv and exits. Run it on the monolithic map
+ * and on the streamed one to compare.
+ */
+UCLASS( Config = Game )
+class SHOOTER_API UShooterWorldCellSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UShooterWorldCellSubsystem( );
+
+	virtual void OnWorldBeginPlay( UWorld& InWorld ) override;
+	virtual void Deinitialize( ) override;
+
+	/* stream around Location instead of the local players' views */
+	void SetStreamingSourceOverride( const FVector& Location );
+	void ClearStreamingSourceOverride( );
+
+	/* true once every cell within the load radius of the streaming sources is loaded and visible */
+	bool AreNearbyCellsVisible( ) const;
+
+	FORCEINLINE int32 GetNumCells( ) const { return Cells.Num( ); }
+
+	// FTickableGameObject
+	virtual void Tick( float DeltaTime ) override;
+	virtual bool IsTickable( ) const override;
+	virtual TStatId GetStatId( ) const override;
+	virtual UWorld* GetTickableGameObjectWorld( ) const override { return GetWorld( ); }
+
+private:
+	struct FWorldCell
+	{
+		FString PackageName;
+		/* fixed name for the loaded instance, so actor keys match from one load to the next */
+		FString InstancePackageName;
+		FBox2D Bounds;
+		TWeakObjectPtr<class ULevelStreamingDynamic> Streaming;
+		/* state captured when the cell last unloaded */
+		TSharedPtr<FShooterWorldSnapshot> State;
+		/* where actors that had left the cell's bounds were when it unloaded */
+		TArray<FVector2D> StrayLocations;
+		bool bWanted;
+		bool bRestored;
+	};
+
+	/* find the map's cell levels in the asset registry */
+	void DiscoverCells( const UWorld& InWorld );
+
+	void GatherStreamingSources( TArray<FVector, TInlineAllocator<4>>& OutSources ) const;
+
+	/* squared distance from the nearest source to the cell or to any of its stray actors */
+	float GetClosestSquared( const FWorldCell& Cell, const TArray<FVector, TInlineAllocator<4>>& Sources ) const;
+
+	/* true while one of the cell's actors is possessed, driven, held or within LoadRadiusSquared of a source */
+	bool IsCellInUse( const FWorldCell& Cell, const TArray<FVector, TInlineAllocator<4>>& Sources, float LoadRadiusSquared ) const;
+
+	void LoadCell( FWorldCell& Cell );
+	void UnloadCell( FWorldCell& Cell );
+
+	bool IsCellVisible( const FWorldCell& Cell ) const;
+
+	void TickBenchmark( );
+
+	/* size of a cell, cm */
+	UPROPERTY( Config )
+	float CellSize;
+
+	/* world XY of cell 0,0's corner */
+	UPROPERTY( Config )
+	FVector2D CellOrigin;
+
+	TArray<FWorldCell> Cells;
+
+	TOptional<FVector> StreamingSourceOverride;
+
+	/* -CellBenchmark progress; INDEX_NONE until the first frame, then the cell being toured */
+	bool bBenchmarking { false };
+	int32 BenchmarkCell { INDEX_NONE };
+	double FirstFrameSeconds { 0.0 };
+	double FirstFramePeakMB { 0.0 };
+	double TourStartSeconds { 0.0 };
+};
@@ -0,0 +1,352 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShooterWorldSnapshot.h"
+#include "Async/MappedFileHandle.h"
+#include "EngineUtils.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+#include "Item.h"
+#include "Shooter.h"
+#include "ShooterCharacter.h"
+#include "ShooterVehicleComponent.h"
+#include "ShooterVehicleSubsystem.h"
+#include "Weapon.h"
+
+// records are copied straight in and out of the file, so keep them packed to 4 bytes
+static_assert( sizeof( FShooterSnapshotHeader ) % 4 == 0, "Snapshot header must stay 4 byte aligned" );
+static_assert( sizeof( FShooterItemRecord ) % 4 == 0, "Snapshot records must stay 4 byte aligned" );
+static_assert( sizeof( FShooterActionRecord ) % 4 == 0, "Snapshot records must stay 4 byte aligned" );
+static_assert( sizeof( FShooterVehicleRecord ) % 4 == 0, "Snapshot records must stay 4 byte aligned" );
+static_assert( sizeof( FShooterCharacterRecord ) % 4 == 0, "Snapshot records must stay 4 byte aligned" );
+
+namespace
+{
+	uint32 GetMapKey( const UWorld* World )
+	{
+		return FCrc::StrCrc32( *UWorld::RemovePIEPrefix( World->GetMapName( ) ) );
+	}
+
+	uint32 GetLevelKey( const ULevel* Level )
+	{
+		return FCrc::StrCrc32( *UWorld::RemovePIEPrefix( Level->GetOutermost( )->GetName( ) ) );
+	}
+
+	bool IsSectionInBounds( const FShooterSnapshotSection& Section, uint32 RecordSize, uint32 TotalSize )
+	{
+		return static_cast<uint64>( Section.Offset ) + static_cast<uint64>( Section.Count ) * RecordSize <= TotalSize;
+	}
+}
+
+void FShooterTransformRecord::Write( const FTransform& Transform )
+{
+	const FVector Translation { Transform.GetLocation( ) };
+	const FQuat Quat { Transform.GetRotation( ) };
+	Location[0] = Translation.X;
+	Location[1] = Translation.Y;
+	Location[2] = Translation.Z;
+	Rotation[0] = Quat.X;
+	Rotation[1] = Quat.Y;
+	Rotation[2] = Quat.Z;
+	Rotation[3] = Quat.W;
+}
+
+FTransform FShooterTransformRecord::Read( ) const
+{
+	return FTransform(
+		FQuat( Rotation[0], Rotation[1], Rotation[2], Rotation[3] ),
+		FVector( Location[0], Location[1], Location[2] ) );
+}
+
+FShooterWorldSnapshot::FShooterWorldSnapshot( ) :
+	Data( nullptr ),
+	Size( 0 )
+{
+}
+
+FShooterWorldSnapshot::~FShooterWorldSnapshot( )
+{
+	Reset( );
+}
+
+void FShooterWorldSnapshot::Reset( )
+{
+	// the region has to go before the file it maps
+	MappedRegion.Reset( );
+	MappedFile.Reset( );
+	Blob.Reset( );
+	Data = nullptr;
+	Size = 0;
+}
+
+uint32 FShooterWorldSnapshot::GetObjectKey( const UObject* Object )
+{
+	return Object ? FCrc::StrCrc32( *UWorld::RemovePIEPrefix( Object->GetPathName( ) ) ) : 0;
+}
+
+void FShooterWorldSnapshot::Capture( UWorld* World )
+{
+	Reset( );
+	if ( World == nullptr )
+	{
+		return;
+	}
+
+	TArray<AActor*> Actors;
+	for ( TActorIterator<AActor> It( World ); It; ++It )
+	{
+		Actors.Add( *It );
+	}
+	CaptureActors( Actors, GetMapKey( World ) );
+}
+
+void FShooterWorldSnapshot::CaptureLevel( ULevel* Level )
+{
+	Reset( );
+	if ( Level == nullptr )
+	{
+		return;
+	}
+
+	TArray<AActor*> Actors;
+	for ( AActor* Actor : Level->Actors )
+	{
+		if ( Actor && !Actor->IsPendingKill( ) )
+		{
+			Actors.Add( Actor );
+		}
+	}
+	CaptureActors( Actors, GetLevelKey( Level ) );
+}
+
+void FShooterWorldSnapshot::CaptureActors( const TArray<AActor*>& Actors, uint32 ScopeKey )
+{
+	TArray<FShooterItemRecord> Items;
+	TArray<FShooterActionRecord> Actions;
+	TArray<FShooterVehicleRecord> Vehicles;
+	TArray<FShooterCharacterRecord> Characters;
+
+	for ( AActor* Actor : Actors )
+	{
+		const uint32 ActorKey { GetObjectKey( Actor ) };
+
+		if ( const AItem* Item = Cast<AItem>( Actor ) )
+		{
+			// equipped weapons are restored with their character
+			if ( Item->GetAttachParentActor( ) == nullptr )
+			{
+				FShooterItemRecord& Record = Items.AddZeroed_GetRef( );
+				Record.ActorKey = ActorKey;
+				Record.Transform.Write( Item->GetActorTransform( ) );
+				Record.ItemCount = Item->GetItemCount( );
+				Record.Rarity = static_cast<uint8>( Item->GetItemRarity( ) );
+				Record.bHidden = Item->IsHidden( ) ? 1 : 0;
+			}
+		}
+		else if ( const AShooterCharacter* Character = Cast<AShooterCharacter>( Actor ) )
+		{
+			FShooterCharacterRecord& Record = Characters.AddZeroed_GetRef( );
+			Record.ActorKey = ActorKey;
+			Record.Transform.Write( Character->GetActorTransform( ) );
+			const FRotator ControlRotation { Character->GetControlRotation( ) };
+			Record.ControlRotation[0] = ControlRotation.Pitch;
+			Record.ControlRotation[1] = ControlRotation.Yaw;
+			Record.ControlRotation[2] = ControlRotation.Roll;
+			Record.EquippedWeaponKey = GetObjectKey( Character->GetEquippedWeapon( ) );
+		}
+
+		TInlineComponentArray<UShooterActionComponent*> ActionComponents( Actor );
+		for ( const UShooterActionComponent* Action : ActionComponents )
+		{
+			FShooterActionRecord& Record = Actions.AddZeroed_GetRef( );
+			Record.ActorKey = ActorKey;
+			Record.ComponentKey = GetObjectKey( Action );
+			Action->WriteSnapshot( Record.State );
+		}
+
+		if ( Actor->FindComponentByClass<UShooterVehicleComponent>( ) )
+		{
+			FShooterVehicleRecord& Record = Vehicles.AddZeroed_GetRef( );
+			Record.ActorKey = ActorKey;
+			Record.Transform.Write( Actor->GetActorTransform( ) );
+		}
+	}
+
+	// header, then each section's records back to back
+	FShooterSnapshotHeader Header;
+	Header.MapKey = ScopeKey;
+	uint32 Offset { sizeof( FShooterSnapshotHeader ) };
+	auto PlaceSection = [&Offset]( FShooterSnapshotSection& Section, int32 Count, uint32 RecordSize )
+	{
+		Section.Offset = Offset;
+		Section.Count = Count;
+		Offset += Count * RecordSize;
+	};
+	PlaceSection( Header.Items, Items.Num( ), sizeof( FShooterItemRecord ) );
+	PlaceSection( Header.Actions, Actions.Num( ), sizeof( FShooterActionRecord ) );
+	PlaceSection( Header.Vehicles, Vehicles.Num( ), sizeof( FShooterVehicleRecord ) );
+	PlaceSection( Header.Characters, Characters.Num( ), sizeof( FShooterCharacterRecord ) );
+	Header.TotalSize = Offset;
+
+	Blob.SetNumZeroed( Offset );
+	FMemory::Memcpy( Blob.GetData( ), &Header, sizeof( FShooterSnapshotHeader ) );
+	FMemory::Memcpy( Blob.GetData( ) + Header.Items.Offset, Items.GetData( ), Items.Num( ) * sizeof( FShooterItemRecord ) );
+	FMemory::Memcpy( Blob.GetData( ) + Header.Actions.Offset, Actions.GetData( ), Actions.Num( ) * sizeof( FShooterActionRecord ) );
+	FMemory::Memcpy( Blob.GetData( ) + Header.Vehicles.Offset, Vehicles.GetData( ), Vehicles.Num( ) * sizeof( FShooterVehicleRecord ) );
+	FMemory::Memcpy( Blob.GetData( ) + Header.Characters.Offset, Characters.GetData( ), Characters.Num( ) * sizeof( FShooterCharacterRecord ) );
+
+	Data = Blob.GetData( );
+	Size = Blob.Num( );
+}
+
+bool FShooterWorldSnapshot::Restore( UWorld* World ) const
+{
+	if ( !IsValid( ) || World == nullptr )
+	{
+		return false;
+	}
+	if ( GetHeader( ).MapKey != GetMapKey( World ) )
+	{
+		UE_LOG( LogShooter, Warning, TEXT( "Snapshot was taken in a different map than %s" ), *World->GetMapName( ) );
+		return false;
+	}
+
+	TMap<uint32, AActor*> Actors;
+	for ( TActorIterator<AActor> It( World ); It; ++It )
+	{
+		Actors.Add( GetObjectKey( *It ), *It );
+	}
+	RestoreActors( World, Actors );
+	return true;
+}
+
+bool FShooterWorldSnapshot::RestoreLevel( ULevel* Level ) const
+{
+	if ( !IsValid( ) || Level == nullptr || GetHeader( ).MapKey != GetLevelKey( Level ) )
+	{
+		return false;
+	}
+
+	TMap<uint32, AActor*> Actors;
+	for ( AActor* Actor : Level->Actors )
+	{
+		if ( Actor )
+		{
+			Actors.Add( GetObjectKey( Actor ), Actor );
+		}
+	}
+	RestoreActors( Level->GetWorld( ), Actors );
+	return true;
+}
+
+void FShooterWorldSnapshot::RestoreActors( UWorld* World, const TMap<uint32, AActor*>& Actors ) const
+{
+	const FShooterSnapshotHeader& Header = GetHeader( );
+
+	for ( const FShooterItemRecord& Record : GetRecords<FShooterItemRecord>( Header.Items ) )
+	{
+		if ( AItem* Item = Cast<AItem>( Actors.FindRef( Record.ActorKey ) ) )
+		{
+			Item->SetActorTransform( Record.Transform.Read( ), false, nullptr, ETeleportType::ResetPhysics );
+			Item->SetItemCount( Record.ItemCount );
+			if ( Item->GetItemRarity( ) != static_cast<EItemRarity>( Record.Rarity ) )
+			{
+				Item->SetItemRarity( static_cast<EItemRarity>( Record.Rarity ) );
+			}
+			Item->SetActorHiddenInGame( Record.bHidden != 0 );
+		}
+	}
+
+	for ( const FShooterActionRecord& Record : GetRecords<FShooterActionRecord>( Header.Actions ) )
+	{
+		const AActor* Owner = Actors.FindRef( Record.ActorKey );
+		if ( Owner == nullptr )
+		{
+			continue;
+		}
+		TInlineComponentArray<UShooterActionComponent*> ActionComponents( Owner );
+		for ( UShooterActionComponent* Action : ActionComponents )
+		{
+			if ( GetObjectKey( Action ) == Record.ComponentKey )
+			{
+				Action->ReadSnapshot( Record.State );
+				break;
+			}
+		}
+	}
+
+	// vehicles first, so drivers are out before characters are moved
+	if ( UShooterVehicleSubsystem* VehicleSubsystem = World->GetSubsystem<UShooterVehicleSubsystem>( ) )
+	{
+		for ( const FShooterVehicleRecord& Record : GetRecords<FShooterVehicleRecord>( Header.Vehicles ) )
+		{
+			const AActor* Owner = Actors.FindRef( Record.ActorKey );
+			if ( UShooterVehicleComponent* Vehicle = Owner ? Owner->FindComponentByClass<UShooterVehicleComponent>( ) : nullptr )
+			{
+				VehicleSubsystem->ResetVehicle( Vehicle, Record.Transform.Read( ) );
+			}
+		}
+	}
+
+	for ( const FShooterCharacterRecord& Record : GetRecords<FShooterCharacterRecord>( Header.Characters ) )
+	{
+		if ( AShooterCharacter* Character = Cast<AShooterCharacter>( Actors.FindRef( Record.ActorKey ) ) )
+		{
+			Character->ResetForRestart(
+				Record.Transform.Read( ),
+				FRotator( Record.ControlRotation[0], Record.ControlRotation[1], Record.ControlRotation[2] ),
+				Cast<AWeapon>( Actors.FindRef( Record.EquippedWeaponKey ) ) );
+		}
+	}
+}
+
+bool FShooterWorldSnapshot::SaveToFile( const FString& Filename ) const
+{
+	return IsValid( ) && FFileHelper::SaveArrayToFile( TArrayView<const uint8>( Data, Size ), *Filename );
+}
+
+bool FShooterWorldSnapshot::LoadFromFile( const FString& Filename )
+{
+	Reset( );
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get( ).GetPlatformFile( );
+	MappedFile.Reset( PlatformFile.OpenMapped( *Filename ) );
+	if ( MappedFile.IsValid( ) )
+	{
+		MappedRegion.Reset( MappedFile->MapRegion( 0, MappedFile->GetFileSize( ), true ) );
+	}
+	if ( MappedRegion.IsValid( ) )
+	{
+		Data = MappedRegion->GetMappedPtr( );
+		Size = MappedRegion->GetMappedSize( );
+	}
+	else
+	{
+		// not every platform file supports mapping
+		MappedFile.Reset( );
+		if ( !FFileHelper::LoadFileToArray( Blob, *Filename ) )
+		{
+			return false;
+		}
+		Data = Blob.GetData( );
+		Size = Blob.Num( );
+	}
+
+	const FShooterSnapshotHeader* Header = Size >= static_cast<int64>( sizeof( FShooterSnapshotHeader ) ) ? &GetHeader( ) : nullptr;
+	const bool bValid { Header
+		&& Header->Magic == ShooterSnapshot::Magic
+		&& Header->Version == ShooterSnapshot::Version
+		&& Header->HeaderSize == sizeof( FShooterSnapshotHeader )
+		&& Header->TotalSize <= Size
+		&& IsSectionInBounds( Header->Items, sizeof( FShooterItemRecord ), Header->TotalSize )
+		&& IsSectionInBounds( Header->Actions, sizeof( FShooterActionRecord ), Header->TotalSize )
+		&& IsSectionInBounds( Header->Vehicles, sizeof( FShooterVehicleRecord ), Header->TotalSize )
+		&& IsSectionInBounds( Header->Characters, sizeof( FShooterCharacterRecord ), Header->TotalSize ) };
+	if ( !bValid )
+	{
+		UE_LOG( LogShooter, Warning, TEXT( "%s isn't a version %d world snapshot" ), *Filename, ShooterSnapshot::Version );
+		Reset( );
+		return false;
+	}
+	return true;
+}
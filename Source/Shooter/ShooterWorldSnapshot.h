@@ -0,0 +1,137 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ShooterActionComponent.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/**
+ * Snapshot file layout. Everything is plain 4-byte-aligned data, little endian, so a snapshot can be
+ * memory mapped and its records read in place. Bump Version whenever a record changes.
+ */
+namespace ShooterSnapshot
+{
+	constexpr uint32 Magic { 0x50414E53 }; // "SNAP"
+	constexpr uint16 Version { 1 };
+}
+
+struct FShooterSnapshotSection
+{
+	uint32 Offset { 0 };
+	uint32 Count { 0 };
+};
+
+struct FShooterSnapshotHeader
+{
+	uint32 Magic { ShooterSnapshot::Magic };
+	uint16 Version { ShooterSnapshot::Version };
+	uint16 HeaderSize { sizeof( FShooterSnapshotHeader ) };
+	uint32 TotalSize { 0 };
+	/* CRC of the map, or the streamed level, the snapshot was taken in */
+	uint32 MapKey { 0 };
+	FShooterSnapshotSection Items;
+	FShooterSnapshotSection Actions;
+	FShooterSnapshotSection Vehicles;
+	FShooterSnapshotSection Characters;
+};
+
+struct FShooterTransformRecord
+{
+	float Location[3];
+	float Rotation[4];
+
+	void Write( const FTransform& Transform );
+	FTransform Read( ) const;
+};
+
+struct FShooterItemRecord
+{
+	uint32 ActorKey;
+	FShooterTransformRecord Transform;
+	int32 ItemCount;
+	uint8 Rarity;
+	uint8 bHidden;
+	uint8 Pad[2];
+};
+
+struct FShooterActionRecord
+{
+	uint32 ActorKey;
+	uint32 ComponentKey;
+	FShooterActionSnapshot State;
+};
+
+struct FShooterVehicleRecord
+{
+	uint32 ActorKey;
+	FShooterTransformRecord Transform;
+};
+
+struct FShooterCharacterRecord
+{
+	uint32 ActorKey;
+	FShooterTransformRecord Transform;
+	float ControlRotation[3];
+	/* key of the equipped weapon actor, 0 for none */
+	uint32 EquippedWeaponKey;
+};
+
+/**
+ * Dynamic gameplay state of a world: items, action props (doors, elevators...), vehicles and characters.
+ * Restore applies it to the live actors in place instead of reloading the map.
+ */
+class SHOOTER_API FShooterWorldSnapshot
+{
+public:
+	FShooterWorldSnapshot( );
+	~FShooterWorldSnapshot( );
+
+	/* replace the snapshot with World's current state */
+	void Capture( UWorld* World );
+
+	/* apply the snapshot to World's actors; returns false if it was taken in another map */
+	bool Restore( UWorld* World ) const;
+
+	/* replace the snapshot with the state of Level's actors alone, e.g. a streamed cell about to unload */
+	void CaptureLevel( ULevel* Level );
+
+	/* apply a CaptureLevel snapshot to Level's actors; returns false if it was taken in another level */
+	bool RestoreLevel( ULevel* Level ) const;
+
+	bool SaveToFile( const FString& Filename ) const;
+
+	/* map Filename (or read it, where mapping isn't supported) and validate its header */
+	bool LoadFromFile( const FString& Filename );
+
+	bool IsValid( ) const { return Data != nullptr; }
+	int64 GetSize( ) const { return Size; }
+
+	/* stable key for an actor or component across map loads */
+	static uint32 GetObjectKey( const UObject* Object );
+
+private:
+	void Reset( );
+
+	void CaptureActors( const TArray<AActor*>& Actors, uint32 ScopeKey );
+
+	void RestoreActors( UWorld* World, const TMap<uint32, AActor*>& Actors ) const;
+
+	const FShooterSnapshotHeader& GetHeader( ) const { return *reinterpret_cast<const FShooterSnapshotHeader*>( Data ); }
+
+	template<typename RecordType>
+	TArrayView<const RecordType> GetRecords( const FShooterSnapshotSection& Section ) const
+	{
+		return TArrayView<const RecordType>( reinterpret_cast<const RecordType*>( Data + Section.Offset ), Section.Count );
+	}
+
+	/* captured snapshots live here; loaded ones in the mapped region, or here if mapping failed */
+	TArray<uint8> Blob;
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	const uint8* Data;
+	int64 Size;
+};
@@ -0,0 +1,137 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ShotTrace.h"
+#include "Engine/World.h"
+#include "Components/PrimitiveComponent.h"
+#include "ShooterCollision.h"
+#include "ShooterPhysicalMaterial.h"
+#include "ShooterStats.h"
+
+DECLARE_CYCLE_STAT( TEXT( "Shot Trace" ), STAT_ShotTrace, STATGROUP_Shooter );
+DECLARE_DWORD_ACCUMULATOR_STAT( TEXT( "Shots Traced" ), STAT_ShotsTraced, STATGROUP_Shooter );
+DECLARE_DWORD_ACCUMULATOR_STAT( TEXT( "Shot Segments Traced" ), STAT_ShotSegmentsTraced, STATGROUP_Shooter );
+DECLARE_FLOAT_ACCUMULATOR_STAT( TEXT( "Avg Segments Per Shot" ), STAT_AvgSegmentsPerShot, STATGROUP_Shooter );
+
+namespace
+{
+	/* nudge off a surface so the next segment doesn't start inside it */
+	constexpr float SegmentStartOffset = 0.1f;
+
+	uint64 TotalShots = 0;
+	uint64 TotalSegments = 0;
+
+	void RecordShot( int32 NumSegments )
+	{
+		TotalShots++;
+		TotalSegments += NumSegments;
+
+		INC_DWORD_STAT( STAT_ShotsTraced );
+		INC_DWORD_STAT_BY( STAT_ShotSegmentsTraced, NumSegments );
+		SET_FLOAT_STAT( STAT_AvgSegmentsPerShot, static_cast<float>( TotalSegments ) / static_cast<float>( TotalShots ) );
+	}
+}
+
+bool ShotTrace::TraceShot(
+	const UWorld* World,
+	const FVector& Start,
+	const FVector& Direction,
+	const FShotTraceBudget& Budget,
+	const AActor* IgnoredActor,
+	FShotSegmentArray& OutSegments,
+	FShotHitArray& OutHits )
+{
+	SCOPE_CYCLE_COUNTER( STAT_ShotTrace );
+
+	OutSegments.Reset( );
+	OutHits.Reset( );
+	if ( World == nullptr )
+	{
+		return false;
+	}
+
+	const FShooterQueryPreset& Preset = ShooterCollision::GetQueryPreset( EShooterQuery::ESQ_Bullet );
+	FCollisionQueryParams QueryParams { Preset.Params };
+	QueryParams.AddIgnoredActor( IgnoredActor );
+
+	FVector SegmentStart { Start };
+	FVector SegmentDirection { Direction.GetSafeNormal( ) };
+	float RemainingDistance { Budget.MaxTraceDistance };
+	bool bAnyHit { false };
+
+	while ( OutSegments.Num( ) < Budget.MaxSegments && RemainingDistance > KINDA_SMALL_NUMBER )
+	{
+		const FVector SegmentEnd { SegmentStart + SegmentDirection * RemainingDistance };
+
+		FHitResult& Hit = OutHits.AddDefaulted_GetRef( );
+		World->LineTraceSingleByChannel(
+			Hit,
+			SegmentStart,
+			SegmentEnd,
+			Preset.Channel,
+			QueryParams );
+
+		FShotSegment& Segment = OutSegments.AddDefaulted_GetRef( );
+		Segment.Start = SegmentStart;
+		Segment.End = SegmentEnd;
+		Segment.ImpactNormal = FVector::ZeroVector;
+		Segment.EndType = EShotSegmentEnd::ESE_None;
+		Segment.HitComponent = nullptr;
+
+		if ( !Hit.bBlockingHit )
+		{
+			break;
+		}
+
+		bAnyHit = true;
+		Segment.End = Hit.ImpactPoint;
+		Segment.ImpactNormal = Hit.ImpactNormal;
+		Segment.EndType = EShotSegmentEnd::ESE_Impact;
+		Segment.HitComponent = Hit.GetComponent( );
+		RemainingDistance -= Hit.Distance;
+
+		const UShooterPhysicalMaterial* Material = Cast<UShooterPhysicalMaterial>( Hit.PhysMaterial.Get( ) );
+		if ( Material == nullptr || OutSegments.Num( ) >= Budget.MaxSegments )
+		{
+			break;
+		}
+
+		// angle between the bullet and the surface: 0 is grazing, 90 is head on
+		const float CosToNormal { FMath::Clamp( -SegmentDirection | Hit.ImpactNormal, -1.f, 1.f ) };
+		const float SurfaceAngle { 90.f - FMath::RadiansToDegrees( FMath::Acos( CosToNormal ) ) };
+
+		if ( Budget.bCanRicochet && SurfaceAngle <= Material->RicochetMaxAngle )
+		{
+			Segment.EndType = EShotSegmentEnd::ESE_Ricochet;
+			SegmentDirection = SegmentDirection.MirrorByVector( Hit.ImpactNormal ).GetSafeNormal( );
+			SegmentStart = Hit.ImpactPoint + Hit.ImpactNormal * SegmentStartOffset;
+			RemainingDistance *= Material->RicochetDistanceScale;
+			continue;
+		}
+
+		UPrimitiveComponent* HitComponent = Hit.GetComponent( );
+		if ( Budget.bCanPenetrate && Material->PenetrationThickness > 0.f && HitComponent )
+		{
+			// trace back from the deepest point we could reach to find the far side of the wall
+			const FVector ProbeStart { Hit.ImpactPoint + SegmentDirection * Material->PenetrationThickness };
+			FHitResult& ExitHit = OutHits.AddDefaulted_GetRef( );
+			const bool bFoundExit = HitComponent->LineTraceComponent(
+				ExitHit,
+				ProbeStart,
+				Hit.ImpactPoint,
+				QueryParams );
+
+			if ( bFoundExit && !ExitHit.bStartPenetrating )
+			{
+				Segment.EndType = EShotSegmentEnd::ESE_Penetrate;
+				SegmentStart = ExitHit.ImpactPoint + SegmentDirection * SegmentStartOffset;
+				RemainingDistance -= FVector::Dist( Hit.ImpactPoint, ExitHit.ImpactPoint );
+				continue;
+			}
+		}
+		break;
+	}
+
+	RecordShot( OutSegments.Num( ) );
+	return bAnyHit;
+}
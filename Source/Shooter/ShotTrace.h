@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/MemStack.h"
+#include "ShotTrace.generated.h"
+
+/* hard per-shot limits for the multi-segment bullet trace */
+USTRUCT( BlueprintType )
+struct FShotTraceBudget
+{
+	GENERATED_BODY( )
+
+	/* bullets may pass through thin UShooterPhysicalMaterial surfaces */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Ballistics )
+	bool bCanPenetrate = false;
+
+	/* bullets may bounce off UShooterPhysicalMaterial surfaces hit at a grazing angle */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Ballistics )
+	bool bCanRicochet = false;
+
+	/* most trace segments a single shot may produce */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Ballistics, meta = ( ClampMin = "1", ClampMax = "16" ) )
+	int32 MaxSegments = 4;
+
+	/* total distance the shot may travel over all segments */
+	UPROPERTY( EditAnywhere, BlueprintReadWrite, Category = Ballistics, meta = ( ClampMin = "0.0" ) )
+	float MaxTraceDistance = 50'000.f;
+};
+
+/* how a shot segment ended */
+enum class EShotSegmentEnd : uint8
+{
+	ESE_None,		// ran out of distance without hitting anything
+	ESE_Impact,		// stopped by a blocking hit
+	ESE_Penetrate,	// passed through the surface, next segment starts at the exit point
+	ESE_Ricochet	// bounced, next segment starts at the impact point
+};
+
+/* one straight piece of a shot */
+struct FShotSegment
+{
+	FVector Start;
+	FVector End;
+	FVector ImpactNormal;
+	EShotSegmentEnd EndType;
+
+	/* the component hit at End. Only valid for the frame the shot was traced in */
+	UPrimitiveComponent* HitComponent;
+};
+
+/* segments and hits live on the per-frame FMemStack; callers must hold an FMemMark */
+using FShotSegmentArray = TArray<FShotSegment, TMemStackAllocator<>>;
+using FShotHitArray = TArray<FHitResult, TMemStackAllocator<>>;
+
+namespace ShotTrace
+{
+	/**
+	* Trace a shot from Start along Direction, penetrating and ricocheting as the budget allows.
+	* @param OutSegments  Receives every segment of the shot, in order
+	* @param OutHits      Receives every hit used to build the segments, including penetration exits
+	* @return true if any segment ended on a blocking hit
+	*/
+	SHOOTER_API bool TraceShot(
+		const UWorld* World,
+		const FVector& Start,
+		const FVector& Direction,
+		const FShotTraceBudget& Budget,
+		const AActor* IgnoredActor,
+		FShotSegmentArray& OutSegments,
+		FShotHitArray& OutHits );
+}
@@ -2,4 +2,24 @@
 
 
 #include "Weapon.h"
+#include "Engine/GameInstance.h"
+#include "WeaponStats.h"
 
+AWeapon::AWeapon( ) :
+	WeaponType( NAME_None ),
+	WeaponId( 0 )
+{
+}
+
+void AWeapon::BeginPlay( )
+{
+	Super::BeginPlay( );
+
+	// look up our stats once; everything else reads them by id
+	const UGameInstance* GameInstance = GetGameInstance( );
+	const UWeaponStatsSubsystem* WeaponStats = GameInstance ? GameInstance->GetSubsystem<UWeaponStatsSubsystem>( ) : nullptr;
+	if ( WeaponStats )
+	{
+		WeaponId = WeaponStats->FindWeaponId( WeaponType );
+	}
+}
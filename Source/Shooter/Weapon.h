@@ -13,5 +13,21 @@ UCLASS()
 class SHOOTER_API AWeapon : public AItem
 {
 	GENERATED_BODY()
-	
+
+public:
+	AWeapon( );
+
+protected:
+	virtual void BeginPlay( ) override;
+
+private:
+	/* row of the weapon definition table holding this weapon's stats */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = Combat, meta = ( AllowPrivateAccess = "true" ) )
+	FName WeaponType;
+
+	/* index of this weapon's baked stats, resolved from WeaponType in BeginPlay */
+	uint8 WeaponId;
+
+public:
+	FORCEINLINE uint8 GetWeaponId( ) const { return WeaponId; }
 };
@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WeaponStats.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "Shooter.h"
+
+namespace
+{
+	FWeaponStats MakeWeaponStats( const FWeaponDefinitionRow& Row )
+	{
+		FWeaponStats WeaponStats;
+		WeaponStats.AutomaticFireRate = Row.AutomaticFireRate;
+		WeaponStats.ShootTimeDuration = Row.ShootTimeDuration;
+		WeaponStats.Damage = Row.Damage;
+		WeaponStats.RecoilKick = Row.RecoilKick;
+		WeaponStats.RecoilPitch = Row.RecoilPitch;
+		WeaponStats.RecoilYawJitter = Row.RecoilYawJitter;
+		WeaponStats.TraceBudget = Row.TraceBudget;
+		WeaponStats.FireSound = Row.FireSound;
+		WeaponStats.MuzzleFlash = Row.MuzzleFlash;
+		WeaponStats.ImpactParticles = Row.ImpactParticles;
+		WeaponStats.BeamParticles = Row.BeamParticles;
+		WeaponStats.HipFireMontage = Row.HipFireMontage;
+		return WeaponStats;
+	}
+}
+
+void UWeaponStatsSubsystem::Initialize( FSubsystemCollectionBase& Collection )
+{
+	Super::Initialize( Collection );
+
+	LoadedWeaponTable = WeaponTable.LoadSynchronous( );
+	BakeWeaponTable( );
+}
+
+void UWeaponStatsSubsystem::Deinitialize( )
+{
+	Stats.Empty( );
+	WeaponIds.Empty( );
+	LoadedWeaponTable = nullptr;
+
+	Super::Deinitialize( );
+}
+
+void UWeaponStatsSubsystem::BakeWeaponTable( )
+{
+	Stats.Reset( );
+	WeaponIds.Reset( );
+
+	// id 0 is the default weapon
+	Stats.Add( GetDefaultStats( ) );
+
+	if ( LoadedWeaponTable == nullptr )
+	{
+		UE_LOG( LogShooter, Warning, TEXT( "No weapon table loaded from '%s', all weapons use default stats" ),
+			*WeaponTable.ToString( ) );
+		return;
+	}
+	if ( LoadedWeaponTable->GetRowStruct( ) != FWeaponDefinitionRow::StaticStruct( ) )
+	{
+		UE_LOG( LogShooter, Error, TEXT( "Weapon table '%s' must use FWeaponDefinitionRow" ),
+			*LoadedWeaponTable->GetPathName( ) );
+		return;
+	}
+
+	for ( const TPair<FName, uint8*>& Row : LoadedWeaponTable->GetRowMap( ) )
+	{
+		if ( Stats.Num( ) > MAX_uint8 )
+		{
+			UE_LOG( LogShooter, Error, TEXT( "Weapon table '%s' has more than %d rows, ignoring the rest" ),
+				*LoadedWeaponTable->GetPathName( ), MAX_uint8 );
+			break;
+		}
+		const FWeaponDefinitionRow* Definition = reinterpret_cast<const FWeaponDefinitionRow*>( Row.Value );
+		WeaponIds.Add( Row.Key, static_cast<uint8>( Stats.Num( ) ) );
+		Stats.Add( MakeWeaponStats( *Definition ) );
+	}
+}
+
+uint8 UWeaponStatsSubsystem::FindWeaponId( FName RowName ) const
+{
+	const uint8* WeaponId = WeaponIds.Find( RowName );
+	return WeaponId ? *WeaponId : 0;
+}
+
+const FWeaponStats& UWeaponStatsSubsystem::GetStats( const UObject* WorldContextObject, uint8 WeaponId )
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld( ) : nullptr;
+	const UGameInstance* GameInstance = World ? World->GetGameInstance( ) : nullptr;
+	const UWeaponStatsSubsystem* Subsystem = GameInstance ? GameInstance->GetSubsystem<UWeaponStatsSubsystem>( ) : nullptr;
+	return Subsystem ? Subsystem->GetStats( WeaponId ) : GetDefaultStats( );
+}
+
+const FWeaponStats& UWeaponStatsSubsystem::GetDefaultStats( )
+{
+	static const FWeaponStats DefaultStats = MakeWeaponStats( FWeaponDefinitionRow( ) );
+	return DefaultStats;
+}
@@ -0,0 +1,130 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataTable.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "ShotTrace.h"
+#include "WeaponStats.generated.h"
+
+/* one row of the weapon definition data table, edited by designers */
+USTRUCT( BlueprintType )
+struct FWeaponDefinitionRow : public FTableRowBase
+{
+	GENERATED_BODY( )
+
+	/* seconds between automatic gunshots */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = Combat )
+	float AutomaticFireRate = 0.1f;
+
+	/* seconds the crosshairs stay spread after a gunshot */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = Combat )
+	float ShootTimeDuration = 0.05f;
+
+	/* health (or armor) each bullet takes from whoever it hits */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = Combat, meta = ( ClampMin = "0.0" ) )
+	float Damage = 20.f;
+
+	/** Randomized gunshot sound cue */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = Combat )
+	class USoundCue* FireSound = nullptr;
+
+	/** Flash spawned at BarrelSocket */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = Combat )
+	class UParticleSystem* MuzzleFlash = nullptr;
+
+	/** Particles spawned upon bullet impact */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = Combat )
+	UParticleSystem* ImpactParticles = nullptr;
+
+	/** Smoke trail for bullets */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = Combat )
+	UParticleSystem* BeamParticles = nullptr;
+
+	/** Montage for firing the weapon. Skipped by anim instances that use procedural recoil */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = Combat )
+	class UAnimMontage* HipFireMontage = nullptr;
+
+	/* backwards velocity (cm/s) each shot adds to the fire reaction spring */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = Recoil )
+	float RecoilKick = 120.f;
+
+	/* upwards angular velocity (deg/s) each shot adds to the fire reaction spring */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = Recoil )
+	float RecoilPitch = 60.f;
+
+	/* each shot adds a random sideways angular velocity (deg/s) up to this much either way */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = Recoil )
+	float RecoilYawJitter = 15.f;
+
+	/* penetration, ricochet and per-shot trace limits */
+	UPROPERTY( EditAnywhere, BlueprintReadOnly, Category = Ballistics )
+	FShotTraceBudget TraceBudget;
+};
+
+/**
+ * Runtime weapon stats, baked from FWeaponDefinitionRow.
+ * Plain data only; the asset pointers are kept alive by the subsystem's reference to the table.
+ */
+struct FWeaponStats
+{
+	float AutomaticFireRate;
+	float ShootTimeDuration;
+	float Damage;
+	float RecoilKick;
+	float RecoilPitch;
+	float RecoilYawJitter;
+	FShotTraceBudget TraceBudget;
+
+	USoundCue* FireSound;
+	UParticleSystem* MuzzleFlash;
+	UParticleSystem* ImpactParticles;
+	UParticleSystem* BeamParticles;
+	UAnimMontage* HipFireMontage;
+};
+
+/**
+ * Loads the weapon definition table once and bakes it into a contiguous array indexed by weapon id.
+ * Id 0 is always the built-in default weapon, used when a row is missing.
+ */
+UCLASS( Config = Game )
+class SHOOTER_API UWeaponStatsSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY( )
+
+public:
+	virtual void Initialize( FSubsystemCollectionBase& Collection ) override;
+	virtual void Deinitialize( ) override;
+
+	/* id of the weapon defined by RowName, or 0 if there is no such row */
+	uint8 FindWeaponId( FName RowName ) const;
+
+	FORCEINLINE const FWeaponStats& GetStats( uint8 WeaponId ) const
+	{
+		return Stats.IsValidIndex( WeaponId ) ? Stats[WeaponId] : Stats[0];
+	}
+
+	/* stats for WeaponId in the world of WorldContextObject; defaults if the subsystem isn't available */
+	static const FWeaponStats& GetStats( const UObject* WorldContextObject, uint8 WeaponId );
+
+	static const FWeaponStats& GetDefaultStats( );
+
+private:
+	/* bakes WeaponTable rows into Stats */
+	void BakeWeaponTable( );
+
+	/* data table of FWeaponDefinitionRow, set in DefaultGame.ini */
+	UPROPERTY( Config )
+	TSoftObjectPtr<UDataTable> WeaponTable;
+
+	/* keeps the table, and every asset its rows point at, loaded */
+	UPROPERTY( Transient )
+	UDataTable* LoadedWeaponTable;
+
+	/* baked stats, indexed by weapon id */
+	TArray<FWeaponStats> Stats;
+
+	/* row name to weapon id */
+	TMap<FName, uint8> WeaponIds;
+};